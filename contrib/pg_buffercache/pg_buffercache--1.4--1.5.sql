@@ -0,0 +1,35 @@
+/* contrib/pg_buffercache/pg_buffercache--1.4--1.5.sql */
+
+-- complain if script is sourced in psql, rather than via ALTER EXTENSION
+\echo Use "ALTER EXTENSION pg_buffercache UPDATE TO '1.5'" to load this file. \quit
+
+CREATE FUNCTION pg_buffercache_policy(
+    OUT bufferid int4,
+    OUT value int4,
+    OUT queue text,
+    OUT queue_position int8,
+    OUT age int8)
+RETURNS SETOF record
+AS 'MODULE_PATHNAME', 'pg_buffercache_policy'
+LANGUAGE C PARALLEL SAFE;
+
+CREATE FUNCTION pg_buffercache_policy_summary(
+    OUT policy text,
+    OUT relfilenode oid,
+    OUT reltablespace oid,
+    OUT reldatabase oid,
+    OUT relforknumber int2,
+    OUT queue text,
+    OUT value_bucket int4,
+    OUT buffers int4,
+    OUT dirty int4,
+    OUT pinned int4)
+RETURNS SETOF record
+AS 'MODULE_PATHNAME', 'pg_buffercache_policy_summary'
+LANGUAGE C PARALLEL SAFE;
+
+-- Don't want these to be available to public.
+REVOKE ALL ON FUNCTION pg_buffercache_policy() FROM PUBLIC;
+GRANT EXECUTE ON FUNCTION pg_buffercache_policy() TO pg_monitor;
+REVOKE ALL ON FUNCTION pg_buffercache_policy_summary() FROM PUBLIC;
+GRANT EXECUTE ON FUNCTION pg_buffercache_policy_summary() TO pg_monitor;
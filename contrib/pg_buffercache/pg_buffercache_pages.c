@@ -11,14 +11,19 @@
 #include "access/htup_details.h"
 #include "catalog/pg_type.h"
 #include "funcapi.h"
+#include "port/pg_bitutils.h"
 #include "storage/buf_internals.h"
 #include "storage/bufmgr.h"
+#include "utils/builtins.h"
+#include "utils/hsearch.h"
 
 
 #define NUM_BUFFERCACHE_PAGES_MIN_ELEM	8
 #define NUM_BUFFERCACHE_PAGES_ELEM	9
 #define NUM_BUFFERCACHE_SUMMARY_ELEM 5
 #define NUM_BUFFERCACHE_USAGE_COUNTS_ELEM 4
+#define NUM_BUFFERCACHE_POLICY_ELEM	5
+#define NUM_BUFFERCACHE_POLICY_SUMMARY_ELEM 10
 
 PG_MODULE_MAGIC;
 
@@ -55,6 +60,28 @@ typedef struct
 	BufferCachePagesRec *record;
 } BufferCachePagesContext;
 
+/*
+ * Hash key and entry for pg_buffercache_policy_summary(): the buffers of one
+ * relation fork in one queue with values in one bucket.
+ */
+typedef struct
+{
+	RelFileNumber relfilenumber;
+	Oid			reltablespace;
+	Oid			reldatabase;
+	ForkNumber	forknum;
+	int32		value_bucket;	/* -1 if the policy has no value */
+	char		queue[NAMEDATALEN];
+} BufferCachePolicySummaryKey;
+
+typedef struct
+{
+	BufferCachePolicySummaryKey key;	/* must be first */
+	int32		buffers;
+	int32		dirty;
+	int32		pinned;
+} BufferCachePolicySummaryEntry;
+
 
 /*
  * Function returning data from the shared buffer cache - buffer number,
@@ -63,6 +90,8 @@ typedef struct
 PG_FUNCTION_INFO_V1(pg_buffercache_pages);
 PG_FUNCTION_INFO_V1(pg_buffercache_summary);
 PG_FUNCTION_INFO_V1(pg_buffercache_usage_counts);
+PG_FUNCTION_INFO_V1(pg_buffercache_policy);
+PG_FUNCTION_INFO_V1(pg_buffercache_policy_summary);
 
 Datum
 pg_buffercache_pages(PG_FUNCTION_ARGS)
@@ -347,3 +376,169 @@ pg_buffercache_usage_counts(PG_FUNCTION_ARGS)
 
 	return (Datum) 0;
 }
+
+/*
+ * Ask the replacement policy what it knows about every buffer.  Like
+ * pg_buffercache_summary(), this takes no locks.
+ */
+static const char *
+get_buffer_policy_info(BufferPolicyBufferInfo **info)
+{
+	*info = palloc_extended(mul_size(NBuffers, sizeof(BufferPolicyBufferInfo)),
+							MCXT_ALLOC_HUGE);
+
+	return StrategyDescribeBuffers(*info);
+}
+
+/*
+ * Values are summarized in buckets of powers of two: 0, 1, 2-3, 4-7 and so
+ * on, each labeled with its lower bound.
+ */
+static int32
+policy_value_bucket(int32 value)
+{
+	if (value <= 0)
+		return value;
+	return (int32) 1 << pg_leftmost_one_pos32((uint32) value);
+}
+
+Datum
+pg_buffercache_policy(PG_FUNCTION_ARGS)
+{
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	BufferPolicyBufferInfo *info;
+	Datum		values[NUM_BUFFERCACHE_POLICY_ELEM];
+	bool		nulls[NUM_BUFFERCACHE_POLICY_ELEM];
+
+	InitMaterializedSRF(fcinfo, 0);
+
+	get_buffer_policy_info(&info);
+
+	for (int i = 0; i < NBuffers; i++)
+	{
+		memset(nulls, 0, sizeof(nulls));
+
+		values[0] = Int32GetDatum(i + 1);
+
+		if (info[i].value >= 0)
+			values[1] = Int32GetDatum(info[i].value);
+		else
+			nulls[1] = true;
+
+		if (info[i].queue != NULL)
+			values[2] = CStringGetTextDatum(info[i].queue);
+		else
+			nulls[2] = true;
+
+		if (info[i].position >= 0)
+			values[3] = Int64GetDatum(info[i].position);
+		else
+			nulls[3] = true;
+
+		if (info[i].age >= 0)
+			values[4] = Int64GetDatum(info[i].age);
+		else
+			nulls[4] = true;
+
+		tuplestore_putvalues(rsinfo->setResult, rsinfo->setDesc, values, nulls);
+	}
+
+	pfree(info);
+
+	return (Datum) 0;
+}
+
+Datum
+pg_buffercache_policy_summary(PG_FUNCTION_ARGS)
+{
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	BufferPolicyBufferInfo *info;
+	const char *policy;
+	HASHCTL		hash_ctl;
+	HTAB	   *summary;
+	HASH_SEQ_STATUS status;
+	BufferCachePolicySummaryEntry *entry;
+	Datum		values[NUM_BUFFERCACHE_POLICY_SUMMARY_ELEM];
+	bool		nulls[NUM_BUFFERCACHE_POLICY_SUMMARY_ELEM];
+
+	InitMaterializedSRF(fcinfo, 0);
+
+	policy = get_buffer_policy_info(&info);
+
+	hash_ctl.keysize = sizeof(BufferCachePolicySummaryKey);
+	hash_ctl.entrysize = sizeof(BufferCachePolicySummaryEntry);
+	hash_ctl.hcxt = CurrentMemoryContext;
+	summary = hash_create("pg_buffercache policy summary", 1024, &hash_ctl,
+						  HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+
+	for (int i = 0; i < NBuffers; i++)
+	{
+		BufferDesc *bufHdr = GetBufferDescriptor(i);
+		uint32		buf_state = pg_atomic_read_u32(&bufHdr->state);
+		BufferCachePolicySummaryKey key;
+		bool		found;
+
+		if (!(buf_state & BM_VALID))
+			continue;
+
+		/*
+		 * As in pg_buffercache_summary(), the header isn't locked, so the
+		 * tag may change while we copy it.  The worst that can happen is
+		 * that a buffer is counted for the wrong relation.
+		 */
+		memset(&key, 0, sizeof(key));
+		key.relfilenumber = BufTagGetRelNumber(&bufHdr->tag);
+		key.reltablespace = bufHdr->tag.spcOid;
+		key.reldatabase = bufHdr->tag.dbOid;
+		key.forknum = BufTagGetForkNum(&bufHdr->tag);
+		key.value_bucket = policy_value_bucket(info[i].value);
+		if (info[i].queue != NULL)
+			strlcpy(key.queue, info[i].queue, NAMEDATALEN);
+
+		entry = hash_search(summary, &key, HASH_ENTER, &found);
+		if (!found)
+		{
+			entry->buffers = 0;
+			entry->dirty = 0;
+			entry->pinned = 0;
+		}
+		entry->buffers++;
+		if (buf_state & BM_DIRTY)
+			entry->dirty++;
+		if (BUF_STATE_GET_REFCOUNT(buf_state) > 0)
+			entry->pinned++;
+	}
+
+	hash_seq_init(&status, summary);
+	while ((entry = hash_seq_search(&status)) != NULL)
+	{
+		memset(nulls, 0, sizeof(nulls));
+
+		values[0] = CStringGetTextDatum(policy);
+		values[1] = ObjectIdGetDatum(entry->key.relfilenumber);
+		values[2] = ObjectIdGetDatum(entry->key.reltablespace);
+		values[3] = ObjectIdGetDatum(entry->key.reldatabase);
+		values[4] = Int16GetDatum(entry->key.forknum);
+
+		if (entry->key.queue[0] != '\0')
+			values[5] = CStringGetTextDatum(entry->key.queue);
+		else
+			nulls[5] = true;
+
+		if (entry->key.value_bucket >= 0)
+			values[6] = Int32GetDatum(entry->key.value_bucket);
+		else
+			nulls[6] = true;
+
+		values[7] = Int32GetDatum(entry->buffers);
+		values[8] = Int32GetDatum(entry->dirty);
+		values[9] = Int32GetDatum(entry->pinned);
+
+		tuplestore_putvalues(rsinfo->setResult, rsinfo->setDesc, values, nulls);
+	}
+
+	hash_destroy(summary);
+	pfree(info);
+
+	return (Datum) 0;
+}
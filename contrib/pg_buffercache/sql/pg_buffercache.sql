@@ -12,6 +12,19 @@ from pg_buffercache_summary();
 
 SELECT count(*) > 0 FROM pg_buffercache_usage_counts() WHERE buffers >= 0;
 
+select count(*) = (select setting::bigint
+                   from pg_settings
+                   where name = 'shared_buffers'),
+       count(*) filter (where queue_position < 0 or age < 0) = 0
+from pg_buffercache_policy();
+
+select sum(buffers) <= (select setting::bigint
+                        from pg_settings
+                        where name = 'shared_buffers'),
+       count(*) filter (where dirty > buffers or pinned > buffers) = 0,
+       count(distinct policy) <= 1
+from pg_buffercache_policy_summary();
+
 -- Check that the functions / views can't be accessed by default. To avoid
 -- having to create a dedicated user, use the pg_database_owner pseudo-role.
 SET ROLE pg_database_owner;
@@ -19,6 +32,8 @@ SELECT * FROM pg_buffercache;
 SELECT * FROM pg_buffercache_pages() AS p (wrong int);
 SELECT * FROM pg_buffercache_summary();
 SELECT * FROM pg_buffercache_usage_counts();
+SELECT * FROM pg_buffercache_policy();
+SELECT * FROM pg_buffercache_policy_summary();
 RESET role;
 
 -- Check that pg_monitor is allowed to query view / function
@@ -26,3 +41,5 @@ SET ROLE pg_monitor;
 SELECT count(*) > 0 FROM pg_buffercache;
 SELECT buffers_used + buffers_unused > 0 FROM pg_buffercache_summary();
 SELECT count(*) > 0 FROM pg_buffercache_usage_counts();
+SELECT count(*) > 0 FROM pg_buffercache_policy();
+SELECT count(*) > 0 FROM pg_buffercache_policy_summary();
@@ -16,6 +16,14 @@
  *		relevant database in turn.  The former keeps running after the
  *		initial prewarm is complete to update the dump file periodically.
  *
+ *		Along with each block, the dump records what the buffer replacement
+ *		policy knew about it: the buffer's usage count and the policy's
+ *		counter, list, list position and age for it.  Blocks are reloaded
+ *		hottest first, going by usage count, so that the hot set makes it
+ *		back in if the pool has shrunk; once they're in, the leader hands
+ *		that state back to the policy, so that it doesn't have to learn
+ *		again which pages are hot.
+ *
  *	Copyright (c) 2016-2023, PostgreSQL Global Development Group
  *
  *	IDENTIFICATION
@@ -57,6 +65,9 @@
 
 #define AUTOPREWARM_FILE "autoprewarm.blocks"
 
+/* longest policy list name kept, including the terminator */
+#define APW_QUEUE_NAME_LEN	16
+
 /* Metadata for each block we dump. */
 typedef struct BlockInfoRecord
 {
@@ -65,6 +76,13 @@ typedef struct BlockInfoRecord
 	RelFileNumber filenumber;
 	ForkNumber	forknum;
 	BlockNumber blocknum;
+
+	/* replacement state; see BufferPolicyBufferInfo */
+	int			usagecount;
+	int32		value;
+	int64		position;
+	int64		age;
+	char		queue[APW_QUEUE_NAME_LEN];	/* "" if none */
 } BlockInfoRecord;
 
 /* Shared state information for autoprewarm bgworker. */
@@ -95,6 +113,9 @@ static void apw_start_database_worker(void);
 static bool apw_init_shmem(void);
 static void apw_detach_shmem(int code, Datum arg);
 static int	apw_compare_blockinfo(const void *p, const void *q);
+static int	apw_compare_recency(const void *p, const void *q);
+static void apw_restore_policy_state(BlockInfoRecord *blkinfo,
+									 int num_elements, const char *policy);
 static void autoprewarm_shmem_request(void);
 static shmem_request_hook_type prev_shmem_request_hook = NULL;
 
@@ -281,7 +302,7 @@ autoprewarm_main(Datum main_arg)
 
 /*
  * Read the dump file and launch per-database workers one at a time to
- * prewarm the buffers found there.
+ * prewarm the buffers found there, hottest first.
  */
 static void
 apw_load_buffers(void)
@@ -291,6 +312,9 @@ apw_load_buffers(void)
 				i;
 	BlockInfoRecord *blkinfo;
 	dsm_segment *seg;
+	char		line[256];
+	char		policy[NAMEDATALEN] = "";
+	Oid			last_db = InvalidOid;
 
 	/*
 	 * Skip the prewarm if the dump file is in use; otherwise, prevent any
@@ -329,8 +353,13 @@ apw_load_buffers(void)
 						AUTOPREWARM_FILE)));
 	}
 
-	/* First line of the file is a record count. */
-	if (fscanf(file, "<<%d>>\n", &num_elements) != 1)
+	/*
+	 * First line of the file is a record count, followed by the name of the
+	 * replacement policy in use when the file was written, except in files
+	 * written before the policy state was dumped.
+	 */
+	if (fgets(line, sizeof(line), file) == NULL ||
+		sscanf(line, "<<%d>> %63s", &num_elements, policy) < 1)
 		ereport(ERROR,
 				(errcode_for_file_access(),
 				 errmsg("could not read from file \"%s\": %m",
@@ -344,14 +373,32 @@ apw_load_buffers(void)
 	for (i = 0; i < num_elements; i++)
 	{
 		unsigned	forknum;
-
-		if (fscanf(file, "%u,%u,%u,%u,%u\n", &blkinfo[i].database,
-				   &blkinfo[i].tablespace, &blkinfo[i].filenumber,
-				   &forknum, &blkinfo[i].blocknum) != 5)
+		long long	position;
+		long long	age;
+		int			nfields;
+
+		blkinfo[i].usagecount = 0;
+		blkinfo[i].value = -1;
+		strcpy(blkinfo[i].queue, "-");
+		position = age = -1;
+
+		nfields = -1;
+		if (fgets(line, sizeof(line), file) != NULL)
+			nfields = sscanf(line, "%u,%u,%u,%u,%u,%d,%d,%15[^,],%lld,%lld",
+							 &blkinfo[i].database, &blkinfo[i].tablespace,
+							 &blkinfo[i].filenumber, &forknum,
+							 &blkinfo[i].blocknum, &blkinfo[i].usagecount,
+							 &blkinfo[i].value, blkinfo[i].queue,
+							 &position, &age);
+		if (nfields != (policy[0] != '\0' ? 10 : 5))
 			ereport(ERROR,
 					(errmsg("autoprewarm block dump file is corrupted at line %d",
 							i + 1)));
 		blkinfo[i].forknum = forknum;
+		blkinfo[i].position = position;
+		blkinfo[i].age = age;
+		if (strcmp(blkinfo[i].queue, "-") == 0)
+			blkinfo[i].queue[0] = '\0';
 	}
 
 	FreeFile(file);
@@ -394,11 +441,16 @@ apw_load_buffers(void)
 
 		/*
 		 * If we reach this point with current_db == InvalidOid, then only
-		 * BlockInfoRecords belonging to global objects exist.  We can't
-		 * prewarm without a database connection, so just bail out.
+		 * BlockInfoRecords belonging to global objects are left.  We can't
+		 * prewarm without a database connection, so load them through the
+		 * last database we connected to, or just bail out if there was none.
 		 */
 		if (current_db == InvalidOid)
-			break;
+		{
+			if (last_db == InvalidOid)
+				break;
+			current_db = last_db;
+		}
 
 		/* Configure stop point and database for next per-database worker. */
 		apw_state->prewarm_stop_idx = j;
@@ -421,11 +473,16 @@ apw_load_buffers(void)
 		 * function will return once the per-database worker exits.
 		 */
 		apw_start_database_worker();
+		last_db = current_db;
 
 		/* Prepare for next database. */
 		apw_state->prewarm_start_idx = apw_state->prewarm_stop_idx;
 	}
 
+	/* Give the blocks that made it in their replacement state back. */
+	if (policy[0] != '\0' && !ShutdownRequestPending)
+		apw_restore_policy_state(blkinfo, num_elements, policy);
+
 	/* Clean up. */
 	dsm_detach(seg);
 	LWLockAcquire(&apw_state->lock, LW_EXCLUSIVE);
@@ -440,6 +497,57 @@ apw_load_buffers(void)
 						apw_state->prewarmed_blocks, num_elements)));
 }
 
+/*
+ * Hand the replacement state recorded in the dump file back to the policy,
+ * for those of the blocks that are in shared buffers now.
+ *
+ * The blocks are visited in decreasing order of the list positions they had,
+ * least recently used first, so that a list-based policy rebuilds its order
+ * by moving each to the head of its list.  We need no database connection
+ * for this, only a resource owner to keep track of the buffer pins.
+ */
+static void
+apw_restore_policy_state(BlockInfoRecord *blkinfo, int num_elements,
+						 const char *policy)
+{
+	int			restored = 0;
+
+	pg_qsort(blkinfo, num_elements, sizeof(BlockInfoRecord),
+			 apw_compare_recency);
+
+	CurrentResourceOwner = ResourceOwnerCreate(NULL, "autoprewarm");
+
+	for (int i = 0; i < num_elements && !ShutdownRequestPending; i++)
+	{
+		BlockInfoRecord *blk = &blkinfo[i];
+		BufferPolicyBufferInfo info;
+		BufferTag	tag;
+		RelFileLocator rlocator;
+
+		rlocator.spcOid = blk->tablespace;
+		rlocator.dbOid = blk->database;
+		rlocator.relNumber = blk->filenumber;
+		if (blk->forknum <= InvalidForkNumber || blk->forknum > MAX_FORKNUM)
+			continue;
+		InitBufferTag(&tag, &rlocator, blk->forknum, blk->blocknum);
+
+		info.value = blk->value;
+		info.queue = blk->queue[0] != '\0' ? blk->queue : NULL;
+		info.position = blk->position;
+		info.age = blk->age;
+
+		if (RestoreBufferPolicyState(&tag, blk->usagecount, policy, &info))
+			restored++;
+	}
+
+	ResourceOwnerDelete(CurrentResourceOwner);
+	CurrentResourceOwner = NULL;
+
+	ereport(DEBUG1,
+			(errmsg_internal("restored replacement state of %d blocks",
+							 restored)));
+}
+
 /*
  * Prewarm all blocks for one database (and possibly also global objects, if
  * those got grouped with this database).
@@ -584,6 +692,8 @@ apw_dump_now(bool is_bgworker, bool dump_unlogged)
 	int			i;
 	int			ret;
 	BlockInfoRecord *block_info_array;
+	BufferPolicyBufferInfo *policy_info;
+	const char *policy;
 	BufferDesc *bufHdr;
 	FILE	   *file;
 	char		transient_dump_file_path[MAXPGPATH];
@@ -608,8 +718,15 @@ apw_dump_now(bool is_bgworker, bool dump_unlogged)
 		return 0;
 	}
 
-	block_info_array =
-		(BlockInfoRecord *) palloc(sizeof(BlockInfoRecord) * NBuffers);
+	block_info_array = (BlockInfoRecord *)
+		palloc_extended(mul_size(sizeof(BlockInfoRecord), NBuffers),
+						MCXT_ALLOC_HUGE);
+
+	/* This takes no locks, so it's a little blurred, but that's fine here */
+	policy_info = (BufferPolicyBufferInfo *)
+		palloc_extended(mul_size(sizeof(BufferPolicyBufferInfo), NBuffers),
+						MCXT_ALLOC_HUGE);
+	policy = StrategyDescribeBuffers(policy_info);
 
 	for (num_blocks = 0, i = 0; i < NBuffers; i++)
 	{
@@ -637,6 +754,14 @@ apw_dump_now(bool is_bgworker, bool dump_unlogged)
 			block_info_array[num_blocks].forknum =
 				BufTagGetForkNum(&bufHdr->tag);
 			block_info_array[num_blocks].blocknum = bufHdr->tag.blockNum;
+			block_info_array[num_blocks].usagecount =
+				BUF_STATE_GET_USAGECOUNT(buf_state);
+			block_info_array[num_blocks].value = policy_info[i].value;
+			block_info_array[num_blocks].position = policy_info[i].position;
+			block_info_array[num_blocks].age = policy_info[i].age;
+			strlcpy(block_info_array[num_blocks].queue,
+					policy_info[i].queue ? policy_info[i].queue : "",
+					APW_QUEUE_NAME_LEN);
 			++num_blocks;
 		}
 
@@ -651,7 +776,7 @@ apw_dump_now(bool is_bgworker, bool dump_unlogged)
 				 errmsg("could not open file \"%s\": %m",
 						transient_dump_file_path)));
 
-	ret = fprintf(file, "<<%d>>\n", num_blocks);
+	ret = fprintf(file, "<<%d>> %s\n", num_blocks, policy);
 	if (ret < 0)
 	{
 		int			save_errno = errno;
@@ -669,12 +794,18 @@ apw_dump_now(bool is_bgworker, bool dump_unlogged)
 	{
 		CHECK_FOR_INTERRUPTS();
 
-		ret = fprintf(file, "%u,%u,%u,%u,%u\n",
+		ret = fprintf(file, "%u,%u,%u,%u,%u,%d,%d,%s,%lld,%lld\n",
 					  block_info_array[i].database,
 					  block_info_array[i].tablespace,
 					  block_info_array[i].filenumber,
 					  (uint32) block_info_array[i].forknum,
-					  block_info_array[i].blocknum);
+					  block_info_array[i].blocknum,
+					  block_info_array[i].usagecount,
+					  block_info_array[i].value,
+					  block_info_array[i].queue[0] != '\0' ?
+					  block_info_array[i].queue : "-",
+					  (long long) block_info_array[i].position,
+					  (long long) block_info_array[i].age);
 		if (ret < 0)
 		{
 			int			save_errno = errno;
@@ -690,6 +821,7 @@ apw_dump_now(bool is_bgworker, bool dump_unlogged)
 	}
 
 	pfree(block_info_array);
+	pfree(policy_info);
 
 	/*
 	 * Rename transient_dump_file_path to AUTOPREWARM_FILE to make things
@@ -898,11 +1030,14 @@ do { \
 /*
  * apw_compare_blockinfo
  *
- * We depend on all records for a particular database being consecutive
- * in the dump file; each per-database worker will preload blocks until
- * it sees a block for some other database.  Sorting by tablespace,
- * filenumber, forknum, and blocknum isn't critical for correctness, but
- * helps us get a sequential I/O pattern.
+ * Blocks with higher usage counts come first, whatever their database, so
+ * that they are the ones loaded if we run out of free buffers.  Within a
+ * usage count, we depend on all records for a particular database being
+ * consecutive; each per-database worker will preload blocks until it sees
+ * a block for some other database, so a database gets one worker per usage
+ * count.  Its blocks with higher policy values come first, and sorting by
+ * tablespace, filenumber, forknum, and blocknum within each value isn't
+ * critical for correctness, but helps us get a sequential I/O pattern.
  */
 static int
 apw_compare_blockinfo(const void *p, const void *q)
@@ -910,7 +1045,11 @@ apw_compare_blockinfo(const void *p, const void *q)
 	const BlockInfoRecord *a = (const BlockInfoRecord *) p;
 	const BlockInfoRecord *b = (const BlockInfoRecord *) q;
 
+	if (a->usagecount != b->usagecount)
+		return a->usagecount > b->usagecount ? -1 : 1;
 	cmp_member_elem(database);
+	if (a->value != b->value)
+		return a->value > b->value ? -1 : 1;
 	cmp_member_elem(tablespace);
 	cmp_member_elem(filenumber);
 	cmp_member_elem(forknum);
@@ -918,3 +1057,26 @@ apw_compare_blockinfo(const void *p, const void *q)
 
 	return 0;
 }
+
+/*
+ * apw_compare_recency
+ *
+ * Order for apw_restore_policy_state(): decreasing list position, blocks
+ * whose position is unknown first, then increasing usage count.
+ */
+static int
+apw_compare_recency(const void *p, const void *q)
+{
+	const BlockInfoRecord *a = (const BlockInfoRecord *) p;
+	const BlockInfoRecord *b = (const BlockInfoRecord *) q;
+
+	if (a->position != b->position)
+	{
+		if (a->position < 0 || b->position < 0)
+			return a->position < 0 ? -1 : 1;
+		return a->position > b->position ? -1 : 1;
+	}
+	cmp_member_elem(usagecount);
+
+	return 0;
+}
@@ -46,6 +46,14 @@ ok( (        $stdout =~ qr/^[1-9][0-9]*$/
 $result = $node->safe_psql("postgres", "SELECT autoprewarm_dump_now();");
 like($result, qr/^[1-9][0-9]*$/, 'autoprewarm_dump_now succeeded');
 
+# the dump records the replacement policy's state along with each block
+my $dump = slurp_file($node->data_dir . '/autoprewarm.blocks');
+like($dump, qr/^<<[1-9][0-9]*>> clocksweep\n/, 'dump names the policy');
+like(
+	$dump,
+	qr/^\d+,\d+,\d+,\d+,\d+,\d+,-?\d+,[^,]+,-?\d+,-?\d+$/m,
+	'dump records the policy state');
+
 # restart, to verify that auto prewarm actually works
 $node->restart;
 
@@ -52,6 +52,7 @@
 #include "access/xact.h"
 #include "access/xlog.h"
 #include "access/xloginsert.h"
+#include "access/xlogrecord.h"
 #include "catalog/index.h"
 #include "commands/progress.h"
 #include "executor/instrument.h"
@@ -256,6 +257,10 @@ typedef struct BTWriteState
 	BlockNumber btws_pages_alloced; /* # pages allocated */
 	BlockNumber btws_pages_written; /* # pages written out */
 	Page		btws_zeropage;	/* workspace for filling zeroes */
+	/* completed pages not yet WAL-logged and written out */
+	int			btws_npending;
+	BlockNumber btws_pending_blknos[XLR_MAX_BLOCK_ID];
+	Page		btws_pending_pages[XLR_MAX_BLOCK_ID];
 } BTWriteState;
 
 
@@ -268,6 +273,9 @@ static void _bt_leafbuild(BTSpool *btspool, BTSpool *btspool2);
 static void _bt_build_callback(Relation index, ItemPointer tid, Datum *values,
 							   bool *isnull, bool tupleIsAlive, void *state);
 static Page _bt_blnewpage(uint32 level);
+static void _bt_blflush(BTWriteState *wstate);
+static void _bt_blwritepage_now(BTWriteState *wstate, Page page,
+								BlockNumber blkno);
 static BTPageState *_bt_pagestate(BTWriteState *wstate, uint32 level);
 static void _bt_slideleft(Page rightmostpage);
 static void _bt_sortaddtup(Page page, Size itemsize,
@@ -575,6 +583,7 @@ _bt_leafbuild(BTSpool *btspool, BTSpool *btspool2)
 	wstate.btws_pages_alloced = BTREE_METAPAGE + 1;
 	wstate.btws_pages_written = 0;
 	wstate.btws_zeropage = NULL;	/* until needed */
+	wstate.btws_npending = 0;
 
 	pgstat_progress_update_param(PROGRESS_CREATEIDX_SUBPHASE,
 								 PROGRESS_BTREE_PHASE_LEAF_LOAD);
@@ -639,17 +648,55 @@ _bt_blnewpage(uint32 level)
 
 /*
  * emit a completed btree page, and release the working storage.
+ *
+ * When WAL-logging, pages are collected and logged XLR_MAX_BLOCK_ID at a time
+ * by _bt_blflush, which writes them out afterwards.  That makes for far fewer
+ * WAL records than logging each page separately.
  */
 static void
 _bt_blwritepage(BTWriteState *wstate, Page page, BlockNumber blkno)
 {
-	/* XLOG stuff */
 	if (wstate->btws_use_wal)
 	{
-		/* We use the XLOG_FPI record type for this */
-		log_newpage(&wstate->index->rd_locator, MAIN_FORKNUM, blkno, page, true);
+		wstate->btws_pending_blknos[wstate->btws_npending] = blkno;
+		wstate->btws_pending_pages[wstate->btws_npending] = page;
+		if (++wstate->btws_npending == XLR_MAX_BLOCK_ID)
+			_bt_blflush(wstate);
+		return;
 	}
 
+	_bt_blwritepage_now(wstate, page, blkno);
+}
+
+/*
+ * WAL-log the pages collected by _bt_blwritepage, and write them out.
+ */
+static void
+_bt_blflush(BTWriteState *wstate)
+{
+	int			i;
+
+	if (wstate->btws_npending == 0)
+		return;
+
+	/* We use the XLOG_FPI record type for this */
+	log_newpages(&wstate->index->rd_locator, MAIN_FORKNUM,
+				 wstate->btws_npending, wstate->btws_pending_blknos,
+				 wstate->btws_pending_pages, true);
+
+	for (i = 0; i < wstate->btws_npending; i++)
+		_bt_blwritepage_now(wstate, wstate->btws_pending_pages[i],
+							wstate->btws_pending_blknos[i]);
+	wstate->btws_npending = 0;
+}
+
+/*
+ * write out a completed btree page, which has been WAL-logged already if
+ * needed, and release the working storage.
+ */
+static void
+_bt_blwritepage_now(BTWriteState *wstate, Page page, BlockNumber blkno)
+{
 	/*
 	 * If we have to write pages nonsequentially, fill in the space with
 	 * zeroes until we come back and overwrite.  This is not logically
@@ -1423,6 +1470,9 @@ _bt_load(BTWriteState *wstate, BTSpool *btspool, BTSpool *btspool2)
 	/* Close down final pages and write the metapage */
 	_bt_uppershutdown(wstate, state);
 
+	/* Log and write any pages still pending */
+	_bt_blflush(wstate);
+
 	/*
 	 * When we WAL-logged index pages, we must nonetheless fsync index files.
 	 * Since we're building outside shared buffers, a CHECKPOINT occurring
@@ -59,6 +59,7 @@
 #include "access/xlog_internal.h"
 #include "access/xlogarchive.h"
 #include "access/xloginsert.h"
+#include "access/xloguring.h"
 #include "access/xlogprefetcher.h"
 #include "access/xlogreader.h"
 #include "access/xlogrecovery.h"
@@ -131,12 +132,15 @@ bool		wal_init_zero = true;
 bool		wal_recycle = true;
 bool		log_checkpoints = true;
 int			sync_method = DEFAULT_SYNC_METHOD;
+int			wal_io_method = WAL_IO_METHOD_SYNC;
 int			wal_level = WAL_LEVEL_REPLICA;
 int			CommitDelay = 0;	/* precommit delay in microseconds */
 int			CommitSiblings = 5; /* # concurrent xacts needed to sleep */
+bool		wal_group_commit = false;
 int			wal_retrieve_retry_interval = 5000;
 int			max_slot_wal_keep_size_mb = -1;
 int			wal_decode_buffer_size = 512 * 1024;
+int			wal_insert_locks = 8;
 bool		track_wal_io_timing = false;
 
 #ifdef WAL_DEBUG
@@ -146,11 +150,18 @@ bool		XLOG_DEBUG = false;
 int			wal_segment_size = DEFAULT_XLOG_SEG_SIZE;
 
 /*
- * Number of WAL insertion locks to use. A higher value allows more insertions
- * to happen concurrently, but adds some CPU overhead to flushing the WAL,
- * which needs to iterate all the locks.
+ * Number of WAL insertion locks to use, set by the wal_insert_locks GUC. A
+ * higher value allows more insertions to happen concurrently, but adds some
+ * CPU overhead to flushing the WAL, which needs to iterate all the locks
+ * (see WaitXLogInsertionsToFinish for how that is mitigated).
  */
-#define NUM_XLOGINSERT_LOCKS  8
+#define NUM_XLOGINSERT_LOCKS  wal_insert_locks
+
+/*
+ * Upper limit, in microseconds, of the adaptive wait a WAL group flush leader
+ * does for more members to join.  See XLogGroupFlush().
+ */
+#define WAL_GROUP_FLUSH_MAX_DELAY	1000
 
 /*
  * Max distance from last checkpoint, before triggering a new xlog-based
@@ -187,6 +198,15 @@ const struct config_enum_entry sync_method_options[] = {
 };
 
 
+const struct config_enum_entry wal_io_method_options[] = {
+	{"sync", WAL_IO_METHOD_SYNC, false},
+#ifdef USE_WAL_IO_URING
+	{"io_uring", WAL_IO_METHOD_IO_URING, false},
+#endif
+	{NULL, 0, false}
+};
+
+
 /*
  * Although only "on", "off", and "always" are documented,
  * we accept all the likely variants of "on" and "off".
@@ -477,6 +497,13 @@ typedef struct XLogCtlData
 	pg_time_t	lastSegSwitchTime;
 	XLogRecPtr	lastSegSwitchLSN;
 
+	/*
+	 * Group flush statistics, used to size the batching window.  See
+	 * XLogGroupFlush().  Protected by WALWriteLock.
+	 */
+	double		groupFlushAvgUsecs; /* moving average of flush duration */
+	int			groupFlushLastSize; /* # of requests served by last flush */
+
 	/*
 	 * Protected by info_lck and WALWriteLock (you must hold either lock to
 	 * read it, but both to update)
@@ -495,6 +522,15 @@ typedef struct XLogCtlData
 	 */
 	XLogRecPtr	InitializedUpTo;
 
+	/*
+	 * All insertions that started before this point are known to have
+	 * finished copying their data into the WAL buffers.  This is a cached
+	 * lower bound of what WaitXLogInsertionsToFinish() would return; it's
+	 * only ever advanced, and lets callers that don't need to wait for
+	 * anything newer skip scanning the insertion locks.
+	 */
+	pg_atomic_uint64 insertFinishedUpTo;
+
 	/*
 	 * These values do not change after startup, although the pointed-to pages
 	 * and xlblocks values certainly do.  xlblocks values are protected by
@@ -619,6 +655,25 @@ static int	openLogFile = -1;
 static XLogSegNo openLogSegNo = 0;
 static TimeLineID openLogTLI = 0;
 
+/*
+ * When XLogWrite() queues its I/O through io_uring, segments it finishes
+ * with can't be closed, nor marked ready for archiving, until the requests
+ * queued for them have completed.  They are remembered here until then; see
+ * XLogWriteDeferSegment().
+ */
+typedef struct XLogDeferredSegment
+{
+	XLogSegNo	segno;
+	TimeLineID	tli;
+	int			fd;				/* file to close, or -1 */
+	bool		notify;			/* mark ready for archiving? */
+} XLogDeferredSegment;
+
+#define XLOG_MAX_DEFERRED_SEGMENTS	8
+
+static XLogDeferredSegment deferredSegments[XLOG_MAX_DEFERRED_SEGMENTS];
+static int	numDeferredSegments = 0;
+
 /*
  * Local copies of equivalent fields in the control file.  When running
  * crash recovery, LocalMinRecoveryPoint is set to InvalidXLogRecPtr as we
@@ -634,6 +689,13 @@ static bool updateMinRecoveryPoint = true;
 static int	MyLockNo = 0;
 static bool holdingAllLocks = false;
 
+/*
+ * Start of the record being copied by CopyXLogRecordToWAL(), while its CRC
+ * has not been filled in yet.  GetXLogBuffer() doesn't advertise any progress
+ * past this point, so that the page holding the header stays in the buffers.
+ */
+static XLogRecPtr pendingCrcRecPtr = InvalidXLogRecPtr;
+
 #ifdef WAL_DEBUG
 static MemoryContext walDebugCxt = NULL;
 #endif
@@ -652,13 +714,18 @@ static void CheckPointGuts(XLogRecPtr checkPointRedo, int flags);
 static void KeepLogSeg(XLogRecPtr recptr, XLogSegNo *logSegNo);
 static XLogRecPtr XLogGetReplicationSlotMinimumLSN(void);
 
-static void AdvanceXLInsertBuffer(XLogRecPtr upto, TimeLineID tli,
+static int	AdvanceXLInsertBuffer(XLogRecPtr upto, TimeLineID tli,
 								  bool opportunistic);
 static void XLogWrite(XLogwrtRqst WriteRqst, TimeLineID tli, bool flexible);
+static void XLogGroupFlush(XLogRecPtr upto, TimeLineID tli);
 static bool InstallXLogFileSegment(XLogSegNo *segno, char *tmppath,
 								   bool find_free, XLogSegNo max_segno,
 								   TimeLineID tli);
 static void XLogFileClose(void);
+static void XLogFileCloseFd(int fd, XLogSegNo segno, TimeLineID tli);
+static void XLogWriteDeferSegment(XLogSegNo segno, TimeLineID tli, int fd,
+								  bool notify);
+static void XLogWriteFinishIO(void);
 static void PreallocXlogFiles(XLogRecPtr endptr, TimeLineID tli);
 static void RemoveTempXlogFiles(void);
 static void RemoveOldXlogFiles(XLogSegNo segno, XLogRecPtr lastredoptr,
@@ -682,12 +749,13 @@ static int	get_sync_bit(int method);
 static void CopyXLogRecordToWAL(int write_len, bool isLogSwitch,
 								XLogRecData *rdata,
 								XLogRecPtr StartPos, XLogRecPtr EndPos,
-								TimeLineID tli);
+								TimeLineID tli, bool computeCrc);
 static void ReserveXLogInsertLocation(int size, XLogRecPtr *StartPos,
 									  XLogRecPtr *EndPos, XLogRecPtr *PrevPtr);
 static bool ReserveXLogSwitch(XLogRecPtr *StartPos, XLogRecPtr *EndPos,
 							  XLogRecPtr *PrevPtr);
 static XLogRecPtr WaitXLogInsertionsToFinish(XLogRecPtr upto);
+static XLogRecPtr AdvanceInsertFinishedUpTo(XLogRecPtr finished);
 static char *GetXLogBuffer(XLogRecPtr ptr, TimeLineID tli);
 static XLogRecPtr XLogBytePosToRecPtr(uint64 bytepos);
 static XLogRecPtr XLogBytePosToEndRecPtr(uint64 bytepos);
@@ -744,6 +812,7 @@ XLogInsertRecord(XLogRecData *rdata,
 	XLogRecPtr	StartPos;
 	XLogRecPtr	EndPos;
 	bool		prevDoPageWrites = doPageWrites;
+	bool		crcWhileCopying;
 	TimeLineID	insertTLI;
 
 	/* we assume that all of the record header is in the first chunk */
@@ -759,6 +828,32 @@ XLogInsertRecord(XLogRecData *rdata,
 	 */
 	insertTLI = XLogCtl->InsertTimeLineID;
 
+	/*
+	 * The CRC covers the record data first and the header last, because the
+	 * prev-link isn't known yet.  Normally, the data part is computed while
+	 * copying the record into the WAL buffers, each piece right after it was
+	 * copied, so that the data only needs to be brought into cache once.
+	 * That requires keeping the page with the record header in the buffers
+	 * until the whole record has been copied (see CopyXLogRecordToWAL), which
+	 * we can only do if the record spans comfortably fewer pages than there
+	 * are WAL buffers.  For bigger records, and xlog-switch records, compute
+	 * the CRC of the data up front, before taking an insertion lock.
+	 */
+	crcWhileCopying = !isLogSwitch &&
+		rechdr->xl_tot_len / (XLOG_BLCKSZ - SizeOfXLogLongPHD) + 1 <
+		XLogCtl->XLogCacheBlck;
+	if (!crcWhileCopying)
+	{
+		XLogRecData *rdt;
+
+		INIT_CRC32C(rdata_crc);
+		COMP_CRC32C(rdata_crc, rdata->data + SizeOfXLogRecord,
+					rdata->len - SizeOfXLogRecord);
+		for (rdt = rdata->next; rdt != NULL; rdt = rdt->next)
+			COMP_CRC32C(rdata_crc, rdt->data, rdt->len);
+		rechdr->xl_crc = rdata_crc;
+	}
+
 	/*----------
 	 *
 	 * We have now done all the preparatory work we can without holding a
@@ -776,8 +871,8 @@ XLogInsertRecord(XLogRecData *rdata,
 	 * To keep track of which insertions are still in-progress, each concurrent
 	 * inserter acquires an insertion lock. In addition to just indicating that
 	 * an insertion is in progress, the lock tells others how far the inserter
-	 * has progressed. There is a small fixed number of insertion locks,
-	 * determined by NUM_XLOGINSERT_LOCKS. When an inserter crosses a page
+	 * has progressed. There is a small number of insertion locks, set at
+	 * server start by wal_insert_locks. When an inserter crosses a page
 	 * boundary, it updates the value stored in the lock to the how far it has
 	 * inserted, to allow the previous buffer to be flushed.
 	 *
@@ -850,19 +945,22 @@ XLogInsertRecord(XLogRecData *rdata,
 	{
 		/*
 		 * Now that xl_prev has been filled in, calculate CRC of the record
-		 * header.
+		 * header, unless it's left to CopyXLogRecordToWAL.
 		 */
-		rdata_crc = rechdr->xl_crc;
-		COMP_CRC32C(rdata_crc, rechdr, offsetof(XLogRecord, xl_crc));
-		FIN_CRC32C(rdata_crc);
-		rechdr->xl_crc = rdata_crc;
+		if (!crcWhileCopying)
+		{
+			rdata_crc = rechdr->xl_crc;
+			COMP_CRC32C(rdata_crc, rechdr, offsetof(XLogRecord, xl_crc));
+			FIN_CRC32C(rdata_crc);
+			rechdr->xl_crc = rdata_crc;
+		}
 
 		/*
 		 * All the record data, including the header, is now ready to be
 		 * inserted. Copy the record in the space reserved.
 		 */
 		CopyXLogRecordToWAL(rechdr->xl_tot_len, isLogSwitch, rdata,
-							StartPos, EndPos, insertTLI);
+							StartPos, EndPos, insertTLI, crcWhileCopying);
 
 		/*
 		 * Unless record is flagged as not important, update LSN of last
@@ -1153,19 +1251,62 @@ ReserveXLogSwitch(XLogRecPtr *StartPos, XLogRecPtr *EndPos, XLogRecPtr *PrevPtr)
 	return true;
 }
 
+/*
+ * Subroutine of CopyXLogRecordToWAL: add 'len' bytes of the record, starting
+ * at offset 'offset' within the record, that were just copied to 'dst' into
+ * the CRC.  The record header is left out, as it goes in last; instead, we
+ * remember where its xl_crc field went, for filling it in afterwards.
+ */
+static inline void
+XLogRecordCopyCRC(pg_crc32c *crc, char **crcptr, uint32 offset,
+				  char *dst, int len)
+{
+	if (offset < SizeOfXLogRecord)
+	{
+		int			hdrlen = Min(len, SizeOfXLogRecord - offset);
+
+		if (offset <= offsetof(XLogRecord, xl_crc) &&
+			offsetof(XLogRecord, xl_crc) < offset + hdrlen)
+		{
+			/* records are MAXALIGNed, so xl_crc is never split across pages */
+			Assert(offset + hdrlen >= offsetof(XLogRecord, xl_crc) + sizeof(pg_crc32c));
+			*crcptr = dst + (offsetof(XLogRecord, xl_crc) - offset);
+		}
+		dst += hdrlen;
+		len -= hdrlen;
+	}
+	COMP_CRC32C(*crc, dst, len);
+}
+
 /*
  * Subroutine of XLogInsertRecord.  Copies a WAL record to an already-reserved
  * area in the WAL.
+ *
+ * If 'computeCrc' is true, the record's CRC has not been computed yet.  We
+ * compute it as we go, and fill it into both the header in the WAL buffers
+ * and the caller's copy at the end.  Until then, we must not let anyone flush
+ * past the start of the record.
  */
 static void
 CopyXLogRecordToWAL(int write_len, bool isLogSwitch, XLogRecData *rdata,
-					XLogRecPtr StartPos, XLogRecPtr EndPos, TimeLineID tli)
+					XLogRecPtr StartPos, XLogRecPtr EndPos, TimeLineID tli,
+					bool computeCrc)
 {
 	char	   *currpos;
 	int			freespace;
 	int			written;
 	XLogRecPtr	CurrPos;
 	XLogPageHeader pagehdr;
+	XLogRecord *rechdr = (XLogRecord *) rdata->data;
+	pg_crc32c	rdata_crc;
+	char	   *crcptr = NULL;
+
+	if (computeCrc)
+	{
+		Assert(!isLogSwitch);
+		INIT_CRC32C(rdata_crc);
+		pendingCrcRecPtr = StartPos;
+	}
 
 	/*
 	 * Get a pointer to the right place in the right WAL buffer to start
@@ -1195,6 +1336,9 @@ CopyXLogRecordToWAL(int write_len, bool isLogSwitch, XLogRecData *rdata,
 			 */
 			Assert(CurrPos % XLOG_BLCKSZ >= SizeOfXLogShortPHD || freespace == 0);
 			memcpy(currpos, rdata_data, freespace);
+			if (computeCrc)
+				XLogRecordCopyCRC(&rdata_crc, &crcptr, written,
+								  currpos, freespace);
 			rdata_data += freespace;
 			rdata_len -= freespace;
 			written += freespace;
@@ -1230,6 +1374,9 @@ CopyXLogRecordToWAL(int write_len, bool isLogSwitch, XLogRecData *rdata,
 
 		Assert(CurrPos % XLOG_BLCKSZ >= SizeOfXLogShortPHD || rdata_len == 0);
 		memcpy(currpos, rdata_data, rdata_len);
+		if (computeCrc)
+			XLogRecordCopyCRC(&rdata_crc, &crcptr, written,
+							  currpos, rdata_len);
 		currpos += rdata_len;
 		CurrPos += rdata_len;
 		freespace -= rdata_len;
@@ -1239,6 +1386,18 @@ CopyXLogRecordToWAL(int write_len, bool isLogSwitch, XLogRecData *rdata,
 	}
 	Assert(written == write_len);
 
+	if (computeCrc)
+	{
+		/* Finish the CRC with the header, and put it in place */
+		COMP_CRC32C(rdata_crc, rechdr, offsetof(XLogRecord, xl_crc));
+		FIN_CRC32C(rdata_crc);
+		rechdr->xl_crc = rdata_crc;
+
+		Assert(crcptr != NULL);
+		memcpy(crcptr, &rdata_crc, sizeof(pg_crc32c));
+		pendingCrcRecPtr = InvalidXLogRecPtr;
+	}
+
 	/*
 	 * If this was an xlog-switch, it's not enough to write the switch record,
 	 * we also have to consume all the remaining space in the WAL segment.  We
@@ -1446,6 +1605,16 @@ WaitXLogInsertionsToFinish(XLogRecPtr upto)
 	if (MyProc == NULL)
 		elog(PANIC, "cannot wait without a PGPROC structure");
 
+	/*
+	 * If somebody else has already established that all insertions up to
+	 * 'upto' have finished, there's nothing to wait for.  The barrier makes
+	 * sure we see the WAL data those insertions copied into the buffers.
+	 */
+	finishedUpto = pg_atomic_read_u64(&XLogCtl->insertFinishedUpTo);
+	pg_read_barrier();
+	if (upto <= finishedUpto)
+		return finishedUpto;
+
 	/* Read the current insert position */
 	SpinLockAcquire(&Insert->insertpos_lck);
 	bytepos = Insert->CurrBytePos;
@@ -1514,7 +1683,30 @@ WaitXLogInsertionsToFinish(XLogRecPtr upto)
 		if (insertingat != InvalidXLogRecPtr && insertingat < finishedUpto)
 			finishedUpto = insertingat;
 	}
-	return finishedUpto;
+
+	/*
+	 * Publish what we found for the benefit of others, unless somebody
+	 * already got further than us.
+	 */
+	return AdvanceInsertFinishedUpTo(finishedUpto);
+}
+
+/*
+ * Advance XLogCtl->insertFinishedUpTo to 'finished', if it's not already
+ * further along.  Returns the resulting value.
+ */
+static XLogRecPtr
+AdvanceInsertFinishedUpTo(XLogRecPtr finished)
+{
+	uint64		cur = pg_atomic_read_u64(&XLogCtl->insertFinishedUpTo);
+
+	while (cur < finished)
+	{
+		if (pg_atomic_compare_exchange_u64(&XLogCtl->insertFinishedUpTo,
+										   &cur, finished))
+			return finished;
+	}
+	return cur;
 }
 
 /*
@@ -1608,6 +1800,16 @@ GetXLogBuffer(XLogRecPtr ptr, TimeLineID tli)
 		else
 			initializedUpto = ptr;
 
+		/*
+		 * If the record we're copying still lacks its CRC, its beginning
+		 * must not be flushed yet.  XLogInsertRecord() only lets that happen
+		 * for records small enough that the buffers we might have to evict
+		 * here are all before the record.
+		 */
+		if (pendingCrcRecPtr != InvalidXLogRecPtr &&
+			initializedUpto > pendingCrcRecPtr)
+			initializedUpto = pendingCrcRecPtr;
+
 		WALInsertLockUpdateInsertingAt(initializedUpto);
 
 		AdvanceXLInsertBuffer(ptr, tli, false);
@@ -1770,8 +1972,17 @@ XLogRecPtrToBytePos(XLogRecPtr ptr)
  * true, initialize as many pages as we can without having to write out
  * unwritten data. Any new pages are initialized to zeros, with pages headers
  * initialized properly.
+ *
+ * The opportunistic mode is used by the WAL writer to prepare pages ahead of
+ * the inserters.  It holds WALBufMappingLock for the whole pass, which is
+ * bounded by the number of WAL buffers already written out; an inserter that
+ * needs a page meanwhile waits for the pass, and then usually finds its page
+ * initialized.  Conversely, an inserter that has to initialize pages itself
+ * wakes up the WAL writer, since that means it's falling behind.
+ *
+ * Returns the number of pages initialized.
  */
-static void
+static int
 AdvanceXLInsertBuffer(XLogRecPtr upto, TimeLineID tli, bool opportunistic)
 {
 	XLogCtlInsert *Insert = &XLogCtl->Insert;
@@ -1781,7 +1992,7 @@ AdvanceXLInsertBuffer(XLogRecPtr upto, TimeLineID tli, bool opportunistic)
 	XLogRecPtr	NewPageEndPtr = InvalidXLogRecPtr;
 	XLogRecPtr	NewPageBeginPtr;
 	XLogPageHeader NewPage;
-	int			npages pg_attribute_unused() = 0;
+	int			npages = 0;
 
 	LWLockAcquire(WALBufMappingLock, LW_EXCLUSIVE);
 
@@ -1928,6 +2139,9 @@ AdvanceXLInsertBuffer(XLogRecPtr upto, TimeLineID tli, bool opportunistic)
 	}
 	LWLockRelease(WALBufMappingLock);
 
+	if (!opportunistic && npages > 0 && ProcGlobal->walwriterLatch)
+		SetLatch(ProcGlobal->walwriterLatch);
+
 #ifdef WAL_DEBUG
 	if (XLOG_DEBUG && npages > 0)
 	{
@@ -1935,6 +2149,8 @@ AdvanceXLInsertBuffer(XLogRecPtr upto, TimeLineID tli, bool opportunistic)
 			 npages, LSN_FORMAT_ARGS(NewPageEndPtr));
 	}
 #endif
+
+	return npages;
 }
 
 /*
@@ -2072,6 +2288,7 @@ XLogWrite(XLogwrtRqst WriteRqst, TimeLineID tli, bool flexible)
 	int			npages;
 	int			startidx;
 	uint32		startoffset;
+	bool		use_uring;
 
 	/* We should always be inside a critical section here */
 	Assert(CritSectionCount > 0);
@@ -2081,6 +2298,14 @@ XLogWrite(XLogwrtRqst WriteRqst, TimeLineID tli, bool flexible)
 	 */
 	LogwrtResult = XLogCtl->LogwrtResult;
 
+	/*
+	 * With wal_io_method = io_uring, the writes and syncs below are merely
+	 * queued, and submitted together by XLogWriteFinishIO() before we
+	 * advertise the new write and flush positions.  Until then, segments we
+	 * are done with must be kept open.
+	 */
+	use_uring = (wal_io_method == WAL_IO_METHOD_IO_URING && XLogUringStart());
+
 	/*
 	 * Since successive pages in the xlog cache are consecutively allocated,
 	 * we can usually gather multiple pages together and issue just one
@@ -2128,7 +2353,16 @@ XLogWrite(XLogwrtRqst WriteRqst, TimeLineID tli, bool flexible)
 			 */
 			Assert(npages == 0);
 			if (openLogFile >= 0)
-				XLogFileClose();
+			{
+				if (use_uring)
+				{
+					XLogWriteDeferSegment(openLogSegNo, openLogTLI,
+										  openLogFile, false);
+					openLogFile = -1;
+				}
+				else
+					XLogFileClose();
+			}
 			XLByteToPrevSeg(LogwrtResult.Write, openLogSegNo,
 							wal_segment_size);
 			openLogTLI = tli;
@@ -2183,56 +2417,62 @@ XLogWrite(XLogwrtRqst WriteRqst, TimeLineID tli, bool flexible)
 			from = XLogCtl->pages + startidx * (Size) XLOG_BLCKSZ;
 			nbytes = npages * (Size) XLOG_BLCKSZ;
 			nleft = nbytes;
-			do
+			if (use_uring)
+				XLogUringQueueWrite(openLogFile, from, nbytes, startoffset,
+									openLogSegNo, tli);
+			else
 			{
-				errno = 0;
-
-				/* Measure I/O timing to write WAL data */
-				if (track_wal_io_timing)
-					INSTR_TIME_SET_CURRENT(start);
-				else
-					INSTR_TIME_SET_ZERO(start);
-
-				pgstat_report_wait_start(WAIT_EVENT_WAL_WRITE);
-				written = pg_pwrite(openLogFile, from, nleft, startoffset);
-				pgstat_report_wait_end();
-
-				/*
-				 * Increment the I/O timing and the number of times WAL data
-				 * were written out to disk.
-				 */
-				if (track_wal_io_timing)
-				{
-					instr_time	duration;
-
-					INSTR_TIME_SET_CURRENT(duration);
-					INSTR_TIME_ACCUM_DIFF(PendingWalStats.wal_write_time, duration, start);
-				}
-
-				PendingWalStats.wal_write++;
-
-				if (written <= 0)
+				do
 				{
-					char		xlogfname[MAXFNAMELEN];
-					int			save_errno;
-
-					if (errno == EINTR)
-						continue;
-
-					save_errno = errno;
-					XLogFileName(xlogfname, tli, openLogSegNo,
-								 wal_segment_size);
-					errno = save_errno;
-					ereport(PANIC,
-							(errcode_for_file_access(),
-							 errmsg("could not write to log file %s "
-									"at offset %u, length %zu: %m",
-									xlogfname, startoffset, nleft)));
-				}
-				nleft -= written;
-				from += written;
-				startoffset += written;
-			} while (nleft > 0);
+					errno = 0;
+
+					/* Measure I/O timing to write WAL data */
+					if (track_wal_io_timing)
+						INSTR_TIME_SET_CURRENT(start);
+					else
+						INSTR_TIME_SET_ZERO(start);
+
+					pgstat_report_wait_start(WAIT_EVENT_WAL_WRITE);
+					written = pg_pwrite(openLogFile, from, nleft, startoffset);
+					pgstat_report_wait_end();
+
+					/*
+					 * Increment the I/O timing and the number of times WAL data
+					 * were written out to disk.
+					 */
+					if (track_wal_io_timing)
+					{
+						instr_time	duration;
+
+						INSTR_TIME_SET_CURRENT(duration);
+						INSTR_TIME_ACCUM_DIFF(PendingWalStats.wal_write_time, duration, start);
+					}
+
+					PendingWalStats.wal_write++;
+
+					if (written <= 0)
+					{
+						char		xlogfname[MAXFNAMELEN];
+						int			save_errno;
+
+						if (errno == EINTR)
+							continue;
+
+						save_errno = errno;
+						XLogFileName(xlogfname, tli, openLogSegNo,
+									 wal_segment_size);
+						errno = save_errno;
+						ereport(PANIC,
+								(errcode_for_file_access(),
+								 errmsg("could not write to log file %s "
+										"at offset %u, length %zu: %m",
+										xlogfname, startoffset, nleft)));
+					}
+					nleft -= written;
+					from += written;
+					startoffset += written;
+				} while (nleft > 0);
+			}
 
 			npages = 0;
 
@@ -2251,7 +2491,10 @@ XLogWrite(XLogwrtRqst WriteRqst, TimeLineID tli, bool flexible)
 			 */
 			if (finishing_seg)
 			{
-				issue_xlog_fsync(openLogFile, openLogSegNo, tli);
+				if (use_uring)
+					XLogUringQueueSync(openLogFile, openLogSegNo, tli);
+				else
+					issue_xlog_fsync(openLogFile, openLogSegNo, tli);
 
 				/* signal that we need to wakeup walsenders later */
 				WalSndWakeupRequest();
@@ -2259,7 +2502,12 @@ XLogWrite(XLogwrtRqst WriteRqst, TimeLineID tli, bool flexible)
 				LogwrtResult.Flush = LogwrtResult.Write;	/* end of page */
 
 				if (XLogArchivingActive())
-					XLogArchiveNotifySeg(openLogSegNo, tli);
+				{
+					if (use_uring)
+						XLogWriteDeferSegment(openLogSegNo, tli, -1, true);
+					else
+						XLogArchiveNotifySeg(openLogSegNo, tli);
+				}
 
 				XLogCtl->lastSegSwitchTime = (pg_time_t) time(NULL);
 				XLogCtl->lastSegSwitchLSN = LogwrtResult.Flush;
@@ -2312,7 +2560,16 @@ XLogWrite(XLogwrtRqst WriteRqst, TimeLineID tli, bool flexible)
 			if (openLogFile >= 0 &&
 				!XLByteInPrevSeg(LogwrtResult.Write, openLogSegNo,
 								 wal_segment_size))
-				XLogFileClose();
+			{
+				if (use_uring)
+				{
+					XLogWriteDeferSegment(openLogSegNo, openLogTLI,
+										  openLogFile, false);
+					openLogFile = -1;
+				}
+				else
+					XLogFileClose();
+			}
 			if (openLogFile < 0)
 			{
 				XLByteToPrevSeg(LogwrtResult.Write, openLogSegNo,
@@ -2322,7 +2579,10 @@ XLogWrite(XLogwrtRqst WriteRqst, TimeLineID tli, bool flexible)
 				ReserveExternalFD();
 			}
 
-			issue_xlog_fsync(openLogFile, openLogSegNo, tli);
+			if (use_uring)
+				XLogUringQueueSync(openLogFile, openLogSegNo, tli);
+			else
+				issue_xlog_fsync(openLogFile, openLogSegNo, tli);
 		}
 
 		/* signal that we need to wakeup walsenders later */
@@ -2331,6 +2591,10 @@ XLogWrite(XLogwrtRqst WriteRqst, TimeLineID tli, bool flexible)
 		LogwrtResult.Flush = LogwrtResult.Write;
 	}
 
+	/* Wait for any I/O we queued above */
+	if (use_uring)
+		XLogWriteFinishIO();
+
 	/*
 	 * Update shared-memory status
 	 *
@@ -2349,6 +2613,71 @@ XLogWrite(XLogwrtRqst WriteRqst, TimeLineID tli, bool flexible)
 	}
 }
 
+/*
+ * Remember a segment that XLogWrite() is done with, to be closed (if 'fd' is
+ * not -1) and/or marked ready for archiving (if 'notify') once the io_uring
+ * requests queued for it have completed.
+ */
+static void
+XLogWriteDeferSegment(XLogSegNo segno, TimeLineID tli, int fd, bool notify)
+{
+	XLogDeferredSegment *seg;
+
+	/* Nothing to wait for?  Then there's no need to defer anything. */
+	if (!XLogUringPending())
+	{
+		if (fd >= 0)
+			XLogFileCloseFd(fd, segno, tli);
+		if (notify)
+			XLogArchiveNotifySeg(segno, tli);
+		return;
+	}
+
+	/* A segment is usually finished first, and closed later */
+	if (numDeferredSegments > 0 &&
+		deferredSegments[numDeferredSegments - 1].segno == segno &&
+		deferredSegments[numDeferredSegments - 1].tli == tli)
+	{
+		seg = &deferredSegments[numDeferredSegments - 1];
+		if (fd >= 0)
+			seg->fd = fd;
+		seg->notify |= notify;
+		return;
+	}
+
+	if (numDeferredSegments >= XLOG_MAX_DEFERRED_SEGMENTS)
+		XLogWriteFinishIO();
+
+	seg = &deferredSegments[numDeferredSegments++];
+	seg->segno = segno;
+	seg->tli = tli;
+	seg->fd = fd;
+	seg->notify = notify;
+}
+
+/*
+ * Wait for the I/O queued by XLogWrite() to complete, then deal with the
+ * segments whose closing and archiving was deferred until now.
+ */
+static void
+XLogWriteFinishIO(void)
+{
+	int			i;
+
+	XLogUringWait();
+
+	for (i = 0; i < numDeferredSegments; i++)
+	{
+		XLogDeferredSegment *seg = &deferredSegments[i];
+
+		if (seg->fd >= 0)
+			XLogFileCloseFd(seg->fd, seg->segno, seg->tli);
+		if (seg->notify)
+			XLogArchiveNotifySeg(seg->segno, seg->tli);
+	}
+	numDeferredSegments = 0;
+}
+
 /*
  * Record the LSN for an asynchronous transaction commit/abort
  * and nudge the WALWriter if there is work for it to do.
@@ -2579,6 +2908,21 @@ XLogFlush(XLogRecPtr record)
 		 */
 		insertpos = WaitXLogInsertionsToFinish(WriteRqstPtr);
 
+		/*
+		 * With wal_group_commit, queue up behind a group leader instead of
+		 * competing for WALWriteLock ourselves.  When this returns, the WAL
+		 * has been flushed at least up to insertpos.
+		 */
+		if (wal_group_commit && MyProc != NULL)
+		{
+			XLogGroupFlush(insertpos, insertTLI);
+
+			SpinLockAcquire(&XLogCtl->info_lck);
+			LogwrtResult = XLogCtl->LogwrtResult;
+			SpinLockRelease(&XLogCtl->info_lck);
+			break;
+		}
+
 		/*
 		 * Try to get the write lock. If we can't get it immediately, wait
 		 * until it's released, and recheck if we still need to do the flush
@@ -2675,6 +3019,195 @@ XLogFlush(XLogRecPtr record)
 			 LSN_FORMAT_ARGS(LogwrtResult.Flush));
 }
 
+/*
+ * Flush WAL up to 'upto' as part of a group.
+ *
+ * Each caller adds itself to a list of processes waiting for a flush.  The
+ * first process on the list becomes the group leader: it acquires
+ * WALWriteLock, optionally waits a little for more requests to arrive, and
+ * then does a single XLogWrite() covering the furthest position requested by
+ * any member.  The other members just sleep until the leader wakes them up.
+ * While one group's flush is in progress the next group forms, so under load
+ * each fsync serves all the commits that arrived during the previous one.
+ *
+ * The leader's wait for more members is adaptive: it is only done if the
+ * previous flush served more than one request, and then lasts half the
+ * recent average flush duration (capped at WAL_GROUP_FLUSH_MAX_DELAY).  An
+ * explicit commit_delay overrides the computed window.  A lone committer
+ * therefore never sleeps.
+ *
+ * The caller must already have waited for insertions up to 'upto' to finish.
+ * This is modeled on TransactionGroupUpdateXidStatus().
+ */
+static void
+XLogGroupFlush(XLogRecPtr upto, TimeLineID tli)
+{
+	volatile PROC_HDR *procglobal = ProcGlobal;
+	PGPROC	   *proc = MyProc;
+	uint32		nextidx;
+	uint32		wakeidx;
+	XLogRecPtr	target;
+	int			nmembers;
+
+	/* Add ourselves to the list of processes needing a WAL flush. */
+	proc->walFlushGroupMember = true;
+	proc->walFlushGroupMemberLsn = upto;
+
+	nextidx = pg_atomic_read_u32(&procglobal->walFlushGroupFirst);
+	while (true)
+	{
+		pg_atomic_write_u32(&proc->walFlushGroupNext, nextidx);
+
+		if (pg_atomic_compare_exchange_u32(&procglobal->walFlushGroupFirst,
+										   &nextidx,
+										   (uint32) proc->pgprocno))
+			break;
+	}
+
+	/*
+	 * If the list was not empty, the leader will flush the WAL for us. It is
+	 * impossible to have followers without a leader because the first
+	 * process that has added itself to the list will always have nextidx as
+	 * INVALID_PGPROCNO.
+	 */
+	if (nextidx != INVALID_PGPROCNO)
+	{
+		int			extraWaits = 0;
+
+		/* Sleep until the leader has flushed the WAL. */
+		pgstat_report_wait_start(WAIT_EVENT_WAL_GROUP_FLUSH);
+		for (;;)
+		{
+			/* acts as a read barrier */
+			PGSemaphoreLock(proc->sem);
+			if (!proc->walFlushGroupMember)
+				break;
+			extraWaits++;
+		}
+		pgstat_report_wait_end();
+
+		Assert(pg_atomic_read_u32(&proc->walFlushGroupNext) == INVALID_PGPROCNO);
+
+		/* Fix semaphore count for any absorbed wakeups */
+		while (extraWaits-- > 0)
+			PGSemaphoreUnlock(proc->sem);
+		return;
+	}
+
+	/*
+	 * We are the leader.  Until everyone is woken up below, members are
+	 * sleeping on us, and so is every process that joins the list meanwhile:
+	 * they see a non-empty list and wait for a leader.  An error here must
+	 * therefore take the whole system down rather than leave them waiting.
+	 * XLogFlush() is in a critical section already, but don't rely on that.
+	 */
+	START_CRIT_SECTION();
+
+	/* Acquire the lock on behalf of everyone. */
+	LWLockAcquire(WALWriteLock, LW_EXCLUSIVE);
+
+	/*
+	 * Give further backends the opportunity to join the group, if recent
+	 * flushes suggest there are any.  We do not sleep if enableFsync is not
+	 * turned on, nor if there are fewer than CommitSiblings other backends
+	 * with active transactions.
+	 */
+	if (enableFsync && XLogCtl->groupFlushLastSize > 1 &&
+		MinimumActiveBackends(CommitSiblings))
+	{
+		long		delay = CommitDelay;
+
+		if (delay <= 0)
+			delay = Min((long) (XLogCtl->groupFlushAvgUsecs / 2),
+						WAL_GROUP_FLUSH_MAX_DELAY);
+		if (delay > 0)
+			pg_usleep(delay);
+	}
+
+	/*
+	 * Now that we've got the lock, clear the list of processes waiting for a
+	 * flush, saving a pointer to the head of the list.  Trying to pop
+	 * elements one at a time could lead to an ABA problem.
+	 */
+	nextidx = pg_atomic_exchange_u32(&procglobal->walFlushGroupFirst,
+									 INVALID_PGPROCNO);
+
+	/* Remember head of list so we can perform wakeups after dropping lock. */
+	wakeidx = nextidx;
+
+	/* Walk the list to find out how far we need to flush. */
+	target = InvalidXLogRecPtr;
+	nmembers = 0;
+	while (nextidx != INVALID_PGPROCNO)
+	{
+		PGPROC	   *nextproc = &ProcGlobal->allProcs[nextidx];
+
+		if (nextproc->walFlushGroupMemberLsn > target)
+			target = nextproc->walFlushGroupMemberLsn;
+		nmembers++;
+
+		/* Move to next proc in list. */
+		nextidx = pg_atomic_read_u32(&nextproc->walFlushGroupNext);
+	}
+
+	LogwrtResult = XLogCtl->LogwrtResult;
+	if (target > LogwrtResult.Flush)
+	{
+		XLogwrtRqst WriteRqst;
+		instr_time	start;
+		instr_time	duration;
+		double		usecs;
+
+		/*
+		 * Every member waited for insertions up to its own request before
+		 * joining, so this doesn't actually wait for anyone; it only lets the
+		 * flush extend over anything inserted in the meantime.  See the
+		 * comments in XLogFlush().
+		 */
+		target = WaitXLogInsertionsToFinish(target);
+
+		WriteRqst.Write = target;
+		WriteRqst.Flush = target;
+
+		INSTR_TIME_SET_CURRENT(start);
+		XLogWrite(WriteRqst, tli, false);
+		INSTR_TIME_SET_CURRENT(duration);
+		INSTR_TIME_SUBTRACT(duration, start);
+
+		/* Fold this flush into the moving average of flush durations. */
+		usecs = (double) INSTR_TIME_GET_MICROSEC(duration);
+		XLogCtl->groupFlushAvgUsecs +=
+			(usecs - XLogCtl->groupFlushAvgUsecs) / 8;
+		XLogCtl->groupFlushLastSize = nmembers;
+	}
+
+	/* We're done with the lock now. */
+	LWLockRelease(WALWriteLock);
+
+	/*
+	 * Now that we've released the lock, go back and wake everybody up.  We
+	 * don't do this under the lock so as to keep lock hold times to a
+	 * minimum.
+	 */
+	while (wakeidx != INVALID_PGPROCNO)
+	{
+		PGPROC	   *wakeproc = &ProcGlobal->allProcs[wakeidx];
+
+		wakeidx = pg_atomic_read_u32(&wakeproc->walFlushGroupNext);
+		pg_atomic_write_u32(&wakeproc->walFlushGroupNext, INVALID_PGPROCNO);
+
+		/* ensure all previous writes are visible before follower continues. */
+		pg_write_barrier();
+
+		wakeproc->walFlushGroupMember = false;
+
+		if (wakeproc != MyProc)
+			PGSemaphoreUnlock(wakeproc->sem);
+	}
+
+	END_CRIT_SECTION();
+}
+
 /*
  * Write & flush xlog, but without specifying exactly where to.
  *
@@ -2752,7 +3285,14 @@ XLogBackgroundFlush(void)
 				XLogFileClose();
 			}
 		}
-		return false;
+
+		/*
+		 * Backends may have written and flushed the WAL themselves, leaving
+		 * buffers that can be initialized for future use.  Doing that here
+		 * keeps it out of the inserters' critical path; if there was any,
+		 * consider ourselves active.
+		 */
+		return AdvanceXLInsertBuffer(InvalidXLogRecPtr, insertTLI, true) > 0;
 	}
 
 	/*
@@ -3351,6 +3891,17 @@ XLogFileClose(void)
 {
 	Assert(openLogFile >= 0);
 
+	XLogFileCloseFd(openLogFile, openLogSegNo, openLogTLI);
+	openLogFile = -1;
+}
+
+/*
+ * Close a WAL segment file, given its FD.  segno and tli are for error
+ * reporting purposes.
+ */
+static void
+XLogFileCloseFd(int fd, XLogSegNo segno, TimeLineID tli)
+{
 	/*
 	 * WAL segment files will not be re-read in normal operation, so we advise
 	 * the OS to release any cached pages.  But do not do so if WAL archiving
@@ -3359,22 +3910,21 @@ XLogFileClose(void)
 	 */
 #if defined(USE_POSIX_FADVISE) && defined(POSIX_FADV_DONTNEED)
 	if (!XLogIsNeeded() && (io_direct_flags & IO_DIRECT_WAL) == 0)
-		(void) posix_fadvise(openLogFile, 0, 0, POSIX_FADV_DONTNEED);
+		(void) posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
 #endif
 
-	if (close(openLogFile) != 0)
+	if (close(fd) != 0)
 	{
 		char		xlogfname[MAXFNAMELEN];
 		int			save_errno = errno;
 
-		XLogFileName(xlogfname, openLogTLI, openLogSegNo, wal_segment_size);
+		XLogFileName(xlogfname, tli, segno, wal_segment_size);
 		errno = save_errno;
 		ereport(PANIC,
 				(errcode_for_file_access(),
 				 errmsg("could not close file \"%s\": %m", xlogfname)));
 	}
 
-	openLogFile = -1;
 	ReleaseExternalFD();
 }
 
@@ -4614,6 +5164,7 @@ XLOGShmemInit(void)
 		WALInsertLocks[i].l.insertingAt = InvalidXLogRecPtr;
 		WALInsertLocks[i].l.lastImportantAt = InvalidXLogRecPtr;
 	}
+	pg_atomic_init_u64(&XLogCtl->insertFinishedUpTo, InvalidXLogRecPtr);
 
 	/*
 	 * Align the start of the page buffers to a full xlog block size boundary.
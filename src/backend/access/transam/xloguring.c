@@ -0,0 +1,546 @@
+/*-------------------------------------------------------------------------
+ *
+ * xloguring.c
+ *		Functions for writing and flushing WAL through io_uring.
+ *
+ * When wal_io_method = io_uring, XLogWrite() doesn't write each run of
+ * pages with a separate pwrite() call and then fsync, but queues the writes
+ * and the fsync of each segment here, and submits them all to the kernel
+ * with a single system call.  The requests for one segment are linked, so
+ * that the kernel starts the fsync only after all of the segment's writes
+ * have completed, but the requests for different segments are independent:
+ * when one XLogWrite() call covers several segments, the writes to a new
+ * segment proceed while the previous one is being flushed.
+ *
+ * XLogWrite() still waits for all of its requests before it returns, since
+ * it mustn't advertise a flush position that isn't durable yet.  So nothing
+ * overlaps with the caller's own work or with the next flush request; what
+ * this saves is mostly system calls, one io_uring_enter() per flush instead
+ * of a pwrite() per run of pages plus an fsync per segment.
+ *
+ * Each process sets up its own ring the first time it writes WAL.  If that
+ * fails, for example because the kernel is too old or io_uring has been
+ * disabled by the administrator, we complain once and the process falls back
+ * to plain synchronous writes.
+ *
+ * We drive the ring with the raw system calls rather than liburing, since we
+ * use only a tiny part of the interface.
+ *
+ *
+ * Portions Copyright (c) 1996-2023, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/backend/access/transam/xloguring.c
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "access/xloguring.h"
+
+#ifdef USE_WAL_IO_URING
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "access/xlog.h"
+#include "access/xlog_internal.h"
+#include "miscadmin.h"
+#include "pgstat.h"
+#include "port/atomics.h"
+#include "portability/instr_time.h"
+#include "storage/fd.h"
+#include "utils/wait_event.h"
+
+/*
+ * Size of the submission queue.  This is also the maximum number of requests
+ * we queue before submitting them and waiting for them to complete.
+ */
+#define XLOG_URING_ENTRIES	64
+
+typedef enum XLogUringOp
+{
+	XLOG_URING_WRITE,
+	XLOG_URING_SYNC
+} XLogUringOp;
+
+/* A queued request, remembered so that we can check its outcome */
+typedef struct XLogUringRequest
+{
+	XLogUringOp op;
+	int			fd;
+	char	   *buf;			/* XLOG_URING_WRITE only */
+	Size		nbytes;			/* XLOG_URING_WRITE only */
+	off_t		offset;			/* XLOG_URING_WRITE only */
+	XLogSegNo	segno;			/* for error reporting */
+	TimeLineID	tli;			/* for error reporting */
+	int			result;			/* result reported by the kernel */
+} XLogUringRequest;
+
+/* State of this process's ring */
+typedef enum XLogUringState
+{
+	XLOG_URING_UNINITIALIZED,
+	XLOG_URING_READY,
+	XLOG_URING_FAILED
+} XLogUringState;
+
+static XLogUringState ring_state = XLOG_URING_UNINITIALIZED;
+static int	ring_fd = -1;
+static unsigned ring_entries;
+
+/* Pointers into the memory shared with the kernel */
+static unsigned *sq_tail;
+static unsigned *sq_mask;
+static unsigned *sq_array;
+static struct io_uring_sqe *sqes;
+static unsigned *cq_head;
+static unsigned *cq_tail;
+static unsigned *cq_mask;
+static struct io_uring_cqe *cqes;
+
+/* Requests queued but not yet waited for */
+static XLogUringRequest requests[XLOG_URING_ENTRIES];
+static int	nrequests = 0;
+static int	nsyncs = 0;
+
+static bool XLogUringSetup(void);
+static struct io_uring_sqe *XLogUringGetSqe(int fd);
+static void XLogUringFinishWrite(XLogUringRequest *req, Size done);
+
+/*
+ * Prepare to use io_uring for WAL writes, setting up this process's ring if
+ * it hasn't been done yet.
+ *
+ * Returns false if io_uring can't be used, in which case the caller should
+ * do its I/O synchronously.
+ */
+bool
+XLogUringStart(void)
+{
+	if (ring_state == XLOG_URING_UNINITIALIZED)
+	{
+		if (XLogUringSetup())
+			ring_state = XLOG_URING_READY;
+		else
+			ring_state = XLOG_URING_FAILED;
+	}
+
+	return ring_state == XLOG_URING_READY;
+}
+
+/*
+ * Set up the ring.  Returns false, after logging the reason, on failure.
+ */
+static bool
+XLogUringSetup(void)
+{
+	struct io_uring_params p;
+	size_t		sq_len;
+	size_t		cq_len;
+	char	   *sq_ptr = MAP_FAILED;
+	char	   *cq_ptr = MAP_FAILED;
+	void	   *sqes_ptr = MAP_FAILED;
+	int			fd;
+
+	memset(&p, 0, sizeof(p));
+	fd = syscall(__NR_io_uring_setup, XLOG_URING_ENTRIES, &p);
+	if (fd < 0)
+	{
+		ereport(LOG,
+				(errcode_for_file_access(),
+				 errmsg("could not set up io_uring for WAL writes: %m"),
+				 errdetail("WAL will be written synchronously by this process.")));
+		return false;
+	}
+
+	/* IORING_OP_WRITE appeared in the same release as this feature flag */
+	if ((p.features & IORING_FEAT_RW_CUR_POS) == 0)
+	{
+		close(fd);
+		ereport(LOG,
+				(errmsg("kernel does not support the io_uring operations needed for WAL writes"),
+				 errdetail("WAL will be written synchronously by this process.")));
+		return false;
+	}
+
+	sq_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+	cq_len = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+	if (p.features & IORING_FEAT_SINGLE_MMAP)
+		sq_len = cq_len = Max(sq_len, cq_len);
+
+	sq_ptr = mmap(NULL, sq_len, PROT_READ | PROT_WRITE,
+				  MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+	if (sq_ptr == MAP_FAILED)
+		goto fail;
+
+	if (p.features & IORING_FEAT_SINGLE_MMAP)
+		cq_ptr = sq_ptr;
+	else
+	{
+		cq_ptr = mmap(NULL, cq_len, PROT_READ | PROT_WRITE,
+					  MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+		if (cq_ptr == MAP_FAILED)
+			goto fail;
+	}
+
+	sqes_ptr = mmap(NULL, p.sq_entries * sizeof(struct io_uring_sqe),
+					PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+					fd, IORING_OFF_SQES);
+	if (sqes_ptr == MAP_FAILED)
+		goto fail;
+
+	sq_tail = (unsigned *) (sq_ptr + p.sq_off.tail);
+	sq_mask = (unsigned *) (sq_ptr + p.sq_off.ring_mask);
+	sq_array = (unsigned *) (sq_ptr + p.sq_off.array);
+	sqes = (struct io_uring_sqe *) sqes_ptr;
+	cq_head = (unsigned *) (cq_ptr + p.cq_off.head);
+	cq_tail = (unsigned *) (cq_ptr + p.cq_off.tail);
+	cq_mask = (unsigned *) (cq_ptr + p.cq_off.ring_mask);
+	cqes = (struct io_uring_cqe *) (cq_ptr + p.cq_off.cqes);
+
+	ring_fd = fd;
+	ring_entries = Min(p.sq_entries, XLOG_URING_ENTRIES);
+	ReserveExternalFD();
+
+	return true;
+
+fail:
+	ereport(LOG,
+			(errcode_for_file_access(),
+			 errmsg("could not map io_uring queues for WAL writes: %m"),
+			 errdetail("WAL will be written synchronously by this process.")));
+	if (cq_ptr != MAP_FAILED && cq_ptr != sq_ptr)
+		munmap(cq_ptr, cq_len);
+	if (sq_ptr != MAP_FAILED)
+		munmap(sq_ptr, sq_len);
+	close(fd);
+	return false;
+}
+
+/*
+ * Are there requests that haven't been waited for yet?
+ */
+bool
+XLogUringPending(void)
+{
+	return nrequests > 0;
+}
+
+/*
+ * Get the next submission queue entry, to be used for an operation on 'fd'.
+ *
+ * If the previous request in the batch is on the same file, it's linked to
+ * the new one, so that the kernel doesn't start the new request until the
+ * previous one has completed.
+ */
+static struct io_uring_sqe *
+XLogUringGetSqe(int fd)
+{
+	struct io_uring_sqe *sqe;
+	unsigned	tail;
+	unsigned	idx;
+
+	/* Make room if the queue is full */
+	if (nrequests >= ring_entries)
+		XLogUringWait();
+
+	if (nrequests > 0 && requests[nrequests - 1].fd == fd)
+	{
+		idx = (*sq_tail + nrequests - 1) & *sq_mask;
+		sqes[idx].flags |= IOSQE_IO_LINK;
+	}
+
+	tail = *sq_tail + nrequests;
+	idx = tail & *sq_mask;
+	sqe = &sqes[idx];
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->fd = fd;
+	sqe->user_data = nrequests;
+	sq_array[idx] = idx;
+
+	return sqe;
+}
+
+/*
+ * Queue a write of 'nbytes' bytes at 'buf' to offset 'offset' of WAL segment
+ * file 'fd'.  The buffer must stay valid until XLogUringWait() is called.
+ */
+void
+XLogUringQueueWrite(int fd, char *buf, Size nbytes, off_t offset,
+					XLogSegNo segno, TimeLineID tli)
+{
+	struct io_uring_sqe *sqe;
+	XLogUringRequest *req;
+
+	Assert(ring_state == XLOG_URING_READY);
+
+	sqe = XLogUringGetSqe(fd);
+	sqe->opcode = IORING_OP_WRITE;
+	sqe->addr = (uint64) (uintptr_t) buf;
+	sqe->len = nbytes;
+	sqe->off = offset;
+
+	req = &requests[nrequests++];
+	req->op = XLOG_URING_WRITE;
+	req->fd = fd;
+	req->buf = buf;
+	req->nbytes = nbytes;
+	req->offset = offset;
+	req->segno = segno;
+	req->tli = tli;
+	req->result = 0;
+}
+
+/*
+ * Queue a sync of WAL segment file 'fd', to be performed once the writes
+ * queued for it have completed.  This is the io_uring counterpart of
+ * issue_xlog_fsync(), and likewise does nothing if fsync is disabled or the
+ * file was opened with O_SYNC or O_DSYNC.
+ */
+void
+XLogUringQueueSync(int fd, XLogSegNo segno, TimeLineID tli)
+{
+	struct io_uring_sqe *sqe;
+	XLogUringRequest *req;
+
+	Assert(ring_state == XLOG_URING_READY);
+
+	if (!enableFsync ||
+		sync_method == SYNC_METHOD_OPEN ||
+		sync_method == SYNC_METHOD_OPEN_DSYNC)
+		return;
+
+	/* io_uring can only do fsync and fdatasync; do anything else directly */
+	if (sync_method != SYNC_METHOD_FSYNC &&
+		sync_method != SYNC_METHOD_FDATASYNC)
+	{
+		XLogUringWait();
+		issue_xlog_fsync(fd, segno, tli);
+		return;
+	}
+
+	sqe = XLogUringGetSqe(fd);
+	sqe->opcode = IORING_OP_FSYNC;
+	if (sync_method == SYNC_METHOD_FDATASYNC)
+		sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+
+	req = &requests[nrequests++];
+	req->op = XLOG_URING_SYNC;
+	req->fd = fd;
+	req->buf = NULL;
+	req->nbytes = 0;
+	req->offset = 0;
+	req->segno = segno;
+	req->tli = tli;
+	req->result = 0;
+	nsyncs++;
+}
+
+/*
+ * Submit all queued requests, and wait for them to complete.
+ *
+ * Writes that the kernel completed only partially, failed, or cancelled
+ * because an earlier request in the same chain failed, are finished with
+ * plain synchronous writes, which PANIC on error like XLogWrite() does.  A
+ * sync that was cancelled is likewise performed synchronously, but a sync
+ * that failed is a PANIC: it must not be retried, since the failure may have
+ * discarded the dirty data.
+ */
+void
+XLogUringWait(void)
+{
+	int			submitted = 0;
+	int			completed = 0;
+	instr_time	start;
+	int			i;
+
+	if (nrequests == 0)
+		return;
+
+	/* Measure I/O timing, charged to syncs if there were any */
+	if (track_wal_io_timing)
+		INSTR_TIME_SET_CURRENT(start);
+	else
+		INSTR_TIME_SET_ZERO(start);
+
+	/* Make the new entries visible to the kernel */
+	pg_write_barrier();
+	*(volatile unsigned *) sq_tail = *sq_tail + nrequests;
+
+	pgstat_report_wait_start(nsyncs > 0 ? WAIT_EVENT_WAL_SYNC : WAIT_EVENT_WAL_WRITE);
+	while (completed < nrequests)
+	{
+		unsigned	head;
+		unsigned	tail;
+		int			ret;
+
+		ret = syscall(__NR_io_uring_enter, ring_fd, nrequests - submitted,
+					  nrequests - completed, IORING_ENTER_GETEVENTS, NULL, 0);
+		if (ret < 0)
+		{
+			if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+				ereport(PANIC,
+						(errcode_for_file_access(),
+						 errmsg("could not submit WAL I/O requests: %m")));
+		}
+		else
+			submitted += ret;
+
+		/* Collect whatever has completed */
+		head = *cq_head;
+		tail = *(volatile unsigned *) cq_tail;
+		pg_read_barrier();
+		while (head != tail)
+		{
+			struct io_uring_cqe *cqe = &cqes[head & *cq_mask];
+
+			Assert(cqe->user_data < nrequests);
+			requests[cqe->user_data].result = cqe->res;
+			head++;
+			completed++;
+		}
+		pg_memory_barrier();
+		*(volatile unsigned *) cq_head = head;
+	}
+	pgstat_report_wait_end();
+
+	if (track_wal_io_timing)
+	{
+		instr_time	duration;
+
+		INSTR_TIME_SET_CURRENT(duration);
+		if (nsyncs > 0)
+			INSTR_TIME_ACCUM_DIFF(PendingWalStats.wal_sync_time, duration, start);
+		else
+			INSTR_TIME_ACCUM_DIFF(PendingWalStats.wal_write_time, duration, start);
+	}
+
+	/*
+	 * Check the outcome of each request, in the order they were queued, so
+	 * that any writes we have to redo are done before the sync that depends
+	 * on them.
+	 */
+	for (i = 0; i < nrequests; i++)
+	{
+		XLogUringRequest *req = &requests[i];
+
+		if (req->op == XLOG_URING_WRITE)
+		{
+			PendingWalStats.wal_write++;
+			if (req->result < 0)
+				XLogUringFinishWrite(req, 0);
+			else if ((Size) req->result < req->nbytes)
+				XLogUringFinishWrite(req, req->result);
+		}
+		else if (req->result == -ECANCELED)
+			issue_xlog_fsync(req->fd, req->segno, req->tli);
+		else if (req->result < 0)
+		{
+			char		xlogfname[MAXFNAMELEN];
+
+			XLogFileName(xlogfname, req->tli, req->segno, wal_segment_size);
+			errno = -req->result;
+			if (sync_method == SYNC_METHOD_FDATASYNC)
+				ereport(PANIC,
+						(errcode_for_file_access(),
+						 errmsg("could not fdatasync file \"%s\": %m",
+								xlogfname)));
+			else
+				ereport(PANIC,
+						(errcode_for_file_access(),
+						 errmsg("could not fsync file \"%s\": %m",
+								xlogfname)));
+		}
+		else
+			PendingWalStats.wal_sync++;
+	}
+
+	nrequests = 0;
+	nsyncs = 0;
+}
+
+/*
+ * Write the part of a request that the kernel didn't, synchronously.
+ */
+static void
+XLogUringFinishWrite(XLogUringRequest *req, Size done)
+{
+	char	   *from = req->buf + done;
+	Size		nleft = req->nbytes - done;
+	off_t		offset = req->offset + done;
+
+	while (nleft > 0)
+	{
+		int			written;
+
+		errno = 0;
+		pgstat_report_wait_start(WAIT_EVENT_WAL_WRITE);
+		written = pg_pwrite(req->fd, from, nleft, offset);
+		pgstat_report_wait_end();
+
+		PendingWalStats.wal_write++;
+
+		if (written <= 0)
+		{
+			char		xlogfname[MAXFNAMELEN];
+			int			save_errno;
+
+			if (errno == EINTR)
+				continue;
+
+			save_errno = errno;
+			XLogFileName(xlogfname, req->tli, req->segno, wal_segment_size);
+			errno = save_errno;
+			ereport(PANIC,
+					(errcode_for_file_access(),
+					 errmsg("could not write to log file %s "
+							"at offset %u, length %zu: %m",
+							xlogfname, (uint32) offset, nleft)));
+		}
+		nleft -= written;
+		from += written;
+		offset += written;
+	}
+}
+
+#else							/* !USE_WAL_IO_URING */
+
+/*
+ * Without io_uring support, wal_io_method can't be set to io_uring, so the
+ * rest of these are never reached.
+ */
+bool
+XLogUringStart(void)
+{
+	return false;
+}
+
+bool
+XLogUringPending(void)
+{
+	return false;
+}
+
+void
+XLogUringQueueWrite(int fd, char *buf, Size nbytes, off_t offset,
+					XLogSegNo segno, TimeLineID tli)
+{
+	elog(PANIC, "io_uring is not supported by this build");
+}
+
+void
+XLogUringQueueSync(int fd, XLogSegNo segno, TimeLineID tli)
+{
+	elog(PANIC, "io_uring is not supported by this build");
+}
+
+void
+XLogUringWait(void)
+{
+}
+
+#endif							/* USE_WAL_IO_URING */
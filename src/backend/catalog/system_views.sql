@@ -911,6 +911,26 @@ CREATE VIEW pg_stat_slru AS
             s.stats_reset
     FROM pg_stat_get_slru() s;
 
+CREATE VIEW pg_stat_buffer_policy AS
+    SELECT
+            s.policy,
+            s.freelist_allocs,
+            s.evictions,
+            s.queue_allocs,
+            s.searches,
+            s.buffers_scanned,
+            s.avg_sweep_distance,
+            s.pinned_skips,
+            s.clock_passes,
+            s.eaclock_periods,
+            s.eaclock_agings,
+            s.eaclock_weight,
+            s.eaclock_hit_ratio,
+            s.eaclock_weight_history,
+            s.eaclock_hit_ratio_history,
+            s.stats_reset
+    FROM pg_stat_get_buffer_policy() s;
+
 CREATE VIEW pg_stat_wal_receiver AS
     SELECT
             s.pid,
@@ -0,0 +1,118 @@
+/*-------------------------------------------------------------------------
+ *
+ * pg_numa.c
+ *	  Basic NUMA portability routines
+ *
+ * Portions Copyright (c) 1996-2023, PostgreSQL Global Development Group
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/port/pg_numa.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#ifdef USE_LIBNUMA
+#include <numa.h>
+#include <numaif.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+#include "port/pg_numa.h"
+#include "storage/pg_shmem.h"
+
+#ifdef USE_LIBNUMA
+
+/*
+ * Returns the number of NUMA nodes, counting from node 0 up to the highest
+ * numbered one, or -1 if the kernel doesn't support NUMA.
+ */
+int
+pg_numa_init(void)
+{
+	if (numa_available() < 0)
+		return -1;
+
+	return numa_max_node() + 1;
+}
+
+/*
+ * Returns the node of the CPU we're running on, or -1 if unknown.  The
+ * process may of course be moved to another CPU at any time.
+ */
+int
+pg_numa_current_node(void)
+{
+	int			cpu = sched_getcpu();
+
+	if (cpu < 0)
+		return -1;
+
+	return numa_node_of_cpu(cpu);
+}
+
+/*
+ * Ask for the memory in [ptr, ptr + size) to be placed on the given node,
+ * as it's first touched.  The range is widened to whole memory pages, huge
+ * ones if they may be in use, so that a page straddling the boundary of two
+ * ranges goes to whichever range was bound last.  The node is preferred
+ * rather than required, so that memory can still be had elsewhere when the
+ * node runs out.
+ *
+ * Returns 0 on success, or -1 with errno set.
+ */
+int
+pg_numa_bind_memory(void *ptr, Size size, int node)
+{
+	Size		pagesize = sysconf(_SC_PAGESIZE);
+	unsigned long nodemask;
+	char	   *start;
+	char	   *end;
+
+	if (huge_pages != HUGE_PAGES_OFF)
+	{
+		Size		hugepagesize;
+
+		GetHugePageSize(&hugepagesize, NULL);
+		pagesize = Max(pagesize, hugepagesize);
+	}
+
+	if (node < 0 || node >= sizeof(nodemask) * BITS_PER_BYTE)
+	{
+		errno = EINVAL;
+		return -1;
+	}
+	nodemask = 1UL << node;
+
+	start = (char *) TYPEALIGN_DOWN(pagesize, ptr);
+	end = (char *) TYPEALIGN(pagesize, (char *) ptr + size);
+
+	/* the kernel takes maxnode as one more than the number of bits */
+	return (int) mbind(start, end - start, MPOL_PREFERRED, &nodemask,
+					   sizeof(nodemask) * BITS_PER_BYTE + 1, 0);
+}
+
+#else
+
+int
+pg_numa_init(void)
+{
+	return -1;
+}
+
+int
+pg_numa_current_node(void)
+{
+	return -1;
+}
+
+int
+pg_numa_bind_memory(void *ptr, Size size, int node)
+{
+	errno = ENOSYS;
+	return -1;
+}
+
+#endif							/* USE_LIBNUMA */
@@ -234,6 +234,9 @@ BackgroundWriterMain(void)
 
 		HandleMainLoopInterrupts();
 
+		/* Switch buffer replacement policy, if the setting was changed */
+		StrategyUpdateBufferPolicy();
+
 		/*
 		 * Do one cycle of dirty-buffer writing.
 		 */
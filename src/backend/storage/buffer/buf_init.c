@@ -14,6 +14,8 @@
  */
 #include "postgres.h"
 
+#include "miscadmin.h"
+#include "port/pg_numa.h"
 #include "storage/buf_internals.h"
 #include "storage/bufmgr.h"
 #include "storage/proc.h"
@@ -24,12 +26,17 @@ ConditionVariableMinimallyPadded *BufferIOCVArray;
 WritebackContext BackendWritebackContext;
 CkptSortItem *CkptBufferIds;
 
-// change 
-ChangeAlgorithm *Algorithm= NULL;
-// change,EAclock
-extern void UpdateWeight();
+/* GUC variable */
+int			buffer_pool_numa_nodes = 0;
 
+int			NumBufferPoolPartitions = 1;
+int			BufferPoolPartitionSize = 0;
 
+/* NUMA nodes the partitions are spread over, or -1 if NUMA isn't available */
+static int	BufferPoolNumaNodes = -1;
+
+static void SetupBufferPoolPartitions(void);
+static void BindBufferPoolPartitions(void);
 
 /*
  * Data Structures:
@@ -76,66 +83,9 @@ InitBufferPool(void)
 	bool		foundBufs,
 				foundDescs,
 				foundIOCV,
-				foundAlgorithm,
-				foundlru,
-				foundEAclock,
 				foundBufCkpt;
 
-// change,Algorithm 修改
-	Algorithm = ShmemInitStruct("Algorithm Control",
-								sizeof(ChangeAlgorithm),
-								&foundAlgorithm);
-	if (!foundAlgorithm)
-	{
-		Algorithm->algorithm_first = 's';
-		Algorithm->algorithm_second = 's';
-
-		Algorithm->GetFromFreelist = 0;
-		Algorithm->GetFromCLOCK = 0;
-		Algorithm->GetFromCLOCKSWEEP = 0;
-		Algorithm->GetFromLRU = 0;
-		Algorithm->GetFromRandom = 0;
-		Algorithm->GetFromHyperbolic = 0;
-		Algorithm->GetFromEAclock = 0;
-		Algorithm->StrategyAccessBuffer = 0;
-		Algorithm->EAclockFdwAgeTimes = 0;
-	}
-// change,lru,申请节点内存
-	/* Align descriptors to a cacheline boundary. */
-	lruStack = (BufferNode *)
-		ShmemInitStruct("lruBufferNode",
-						(NBuffers+3) * sizeof(BufferNode),
-						&foundlru);
-	if (!foundlru)
-	{
-// change,lru,初始化头尾标兵节点
-		BufferNode *lru_head = &lruStack[NBuffers]; 
-		BufferNode *lru_end = &lruStack[NBuffers+1]; 
-		lru_head->next = lru_end;
-		lru_end->prev = lru_head;
-		lru_end->next = NULL;
-		lru_head->prev = NULL;
-		lru_head->node_id = NBuffers;
-		lru_end->node_id = NBuffers+1;
-	}
-
-// change,EAclock,申请全局控制器
-	EAclockControl = (EAclockStrategyControl *)
-		ShmemInitStruct("EAclockStrategyControl",
-						sizeof(EAclockStrategyControl),
-						&foundEAclock);
-	if (!foundEAclock)
-	{
-		pg_atomic_init_u32(&EAclockControl->evictNum, 0);
-
-		EAclockControl->HitInBuf = 0;
-		EAclockControl->lastAction = 1;
-		EAclockControl->lastHR = 0;
-		EAclockControl->lastWeight = 2;
-		EAclockControl->starCount = false;
-		EAclockControl->isChange = false;
-	}
-
+	SetupBufferPoolPartitions();
 
 	/* Align descriptors to a cacheline boundary. */
 	BufferDescriptors = (BufferDescPadded *)
@@ -177,7 +127,11 @@ InitBufferPool(void)
 	{
 		int			i;
 
-
+		/*
+		 * Place each partition on its node, before the buffer headers are
+		 * first touched below.
+		 */
+		BindBufferPoolPartitions();
 
 		/*
 		 * Initialize all the buffer headers.
@@ -191,19 +145,6 @@ InitBufferPool(void)
 			pg_atomic_init_u32(&buf->state, 0);
 			buf->wait_backend_pgprocno = INVALID_PGPROCNO;
 
-// change,clock,修改
-			buf->flag=false;
-
-// change,lru,初始化中间节点
-			BufferNode *curr = &lruStack[i]; // focus on the node with node_id = buf_id
-			curr->prev = NULL;
-			curr->next = NULL;
-			curr->node_id = i;
-			curr->startTime = time(NULL);
-
-// change,EAclock,初始化页面值
-			pg_atomic_init_u32(&curr->Value, 0);
-
 			buf->buf_id = i;
 
 			/*
@@ -241,6 +182,9 @@ BufferShmemSize(void)
 {
 	Size		size = 0;
 
+	/* the victim queues in freelist.c are per partition */
+	SetupBufferPoolPartitions();
+
 	/* size of buffer descriptors */
 	size = add_size(size, mul_size(NBuffers, sizeof(BufferDescPadded)));
 	/* to allow aligning buffer descriptors */
@@ -264,3 +208,111 @@ BufferShmemSize(void)
 
 	return size;
 }
+
+/*
+ * SetupBufferPoolPartitions
+ *
+ * Divide the buffer pool into partitions, one per NUMA node unless
+ * buffer_pool_numa_nodes says otherwise.  Asking for more partitions than
+ * there are nodes makes several partitions share a node, which is useful to
+ * exercise the partitioned code on a single-node machine.
+ *
+ * Partitions are kept at least BUFFER_POOL_PARTITION_ALIGN buffers in size,
+ * 2MB of pages with the default block size, so that with huge pages each
+ * partition's pages take up huge pages of their own.
+ *
+ * This depends only on settings that can't change while the server runs,
+ * so it's simply recomputed whenever needed.
+ */
+static void
+SetupBufferPoolPartitions(void)
+{
+	int			nparts = buffer_pool_numa_nodes;
+
+	BufferPoolNumaNodes = pg_numa_init();
+
+	if (nparts == 0)
+		nparts = Max(BufferPoolNumaNodes, 1);
+	nparts = Min(nparts, Max(NBuffers / BUFFER_POOL_PARTITION_ALIGN, 1));
+
+	NumBufferPoolPartitions = nparts;
+	if (nparts == 1)
+		BufferPoolPartitionSize = NBuffers;
+	else
+		BufferPoolPartitionSize = (NBuffers / nparts) -
+			(NBuffers / nparts) % BUFFER_POOL_PARTITION_ALIGN;
+}
+
+/*
+ * BindBufferPoolPartitions
+ *
+ * Ask the kernel to place the buffer headers, pages and I/O condition
+ * variables of partition p on NUMA node p modulo the number of nodes.
+ * Failure only costs performance, so it's reported and otherwise ignored.
+ */
+static void
+BindBufferPoolPartitions(void)
+{
+	if (BufferPoolNumaNodes <= 1)
+		return;
+
+	for (int p = 0; p < NumBufferPoolPartitions; p++)
+	{
+		int			start = BufferPoolPartitionStart(p);
+		int			nbufs = BufferPoolPartitionEnd(p) - start;
+		int			node = p % BufferPoolNumaNodes;
+
+		if (pg_numa_bind_memory(&BufferDescriptors[start],
+								nbufs * sizeof(BufferDescPadded), node) != 0 ||
+			pg_numa_bind_memory(BufferBlocks + (Size) start * BLCKSZ,
+								(Size) nbufs * BLCKSZ, node) != 0 ||
+			pg_numa_bind_memory(&BufferIOCVArray[start],
+								nbufs * sizeof(ConditionVariableMinimallyPadded),
+								node) != 0)
+		{
+			ereport(WARNING,
+					(errmsg("could not place shared buffers on NUMA node %d: %m",
+							node)));
+			return;
+		}
+	}
+
+	elog(DEBUG1, "shared buffers divided into %d partitions on %d NUMA nodes",
+		 NumBufferPoolPartitions, BufferPoolNumaNodes);
+}
+
+/*
+ * BufferPoolHomePartition
+ *
+ * Return the partition this process should preferably take buffers from:
+ * one on the NUMA node it's running on, chosen by process ID if that node
+ * has several.  Without NUMA support, all partitions count as being on one
+ * node.  This is decided the first time it's asked for; processes are
+ * mostly kept on their node by the kernel.
+ */
+int
+BufferPoolHomePartition(void)
+{
+	static int	home = -1;
+
+	if (home < 0)
+	{
+		int			nnodes = Max(BufferPoolNumaNodes, 1);
+		int			node = 0;
+
+		if (nnodes > 1)
+			node = Max(pg_numa_current_node(), 0) % nnodes;
+
+		if (node >= NumBufferPoolPartitions)
+			home = node % NumBufferPoolPartitions;
+		else
+		{
+			/* partitions node, node + nnodes, node + 2 * nnodes, ... */
+			int			nhomes = (NumBufferPoolPartitions - 1 - node) / nnodes + 1;
+
+			home = node + nnodes * (MyProcPid % nhomes);
+		}
+	}
+
+	return home;
+}
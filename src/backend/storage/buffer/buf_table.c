@@ -9,6 +9,11 @@
  * in most cases the caller needs to adjust the buffer header contents
  * before the lock is released (see notes in README).
  *
+ * There are two implementations of the table.  By default it's a partitioned
+ * dynahash.  With lock_free_buffer_mapping, it's an open-addressing table of
+ * our own, which can also be searched without any lock, see
+ * BufTableLookup().
+ *
  *
  * Portions Copyright (c) 1996-2023, PostgreSQL Global Development Group
  * Portions Copyright (c) 1994, Regents of the University of California
@@ -21,9 +26,15 @@
  */
 #include "postgres.h"
 
+#include "common/hashfn.h"
+#include "port/atomics.h"
+#include "port/pg_bitutils.h"
 #include "storage/buf_internals.h"
 #include "storage/bufmgr.h"
 
+/* GUC variable */
+bool		lock_free_buffer_mapping = false;
+
 /* entry for buffer lookup hashtable */
 typedef struct
 {
@@ -33,6 +44,95 @@ typedef struct
 
 static HTAB *SharedBufHash;
 
+/*
+ * The open-addressing table is divided into one segment per buffer mapping
+ * partition, so that every slot is only ever changed under the exclusive
+ * BufMappingLock of the partition it belongs to.  Within a segment, entries
+ * are placed by linear probing from a position given by the hash code, and
+ * deletion shifts later entries back (as in simplehash.h) so that no
+ * tombstones are left behind.
+ *
+ * A slot holds the hash code in its upper half and the buffer ID plus one in
+ * its lower half, zero meaning empty, so that it can be read and written
+ * atomically.  The tag each buffer ID is entered under is kept in
+ * BufMappingTags[], which is what dynahash would store as the key.  A buffer
+ * is in the table under at most one tag at a time.
+ *
+ * A lookup without the lock can see the table in the middle of a change:
+ * it may miss an entry that is being shifted back, and it may find an entry
+ * that is being deleted, or read a tag that is being overwritten.  Callers
+ * of such lookups must be prepared for both, see BufTableLookup().
+ */
+static pg_atomic_uint64 *BufMappingSlots;
+static BufferTag *BufMappingTags;
+static uint32 BufMappingSegmentSize;
+
+#define BUF_MAPPING_SLOT(hashcode, id) \
+	(((uint64) (hashcode) << 32) | (uint32) ((id) + 1))
+#define BUF_MAPPING_SLOT_HASH(slot)	((uint32) ((slot) >> 32))
+#define BUF_MAPPING_SLOT_ID(slot)	((int) ((slot) & PG_UINT32_MAX) - 1)
+
+/*
+ * Number of slots in each segment of the open-addressing table, a power of
+ * two with room for twice the average number of entries per partition.
+ */
+static uint32
+BufMappingSegmentSlots(int size)
+{
+	return pg_nextpower2_32(Max(size / NUM_BUFFER_PARTITIONS * 2, 16));
+}
+
+/* First slot of the segment for hashcode */
+static inline pg_atomic_uint64 *
+BufMappingSegment(uint32 hashcode)
+{
+	return BufMappingSlots +
+		(Size) BufTableHashPartition(hashcode) * BufMappingSegmentSize;
+}
+
+/* Preferred position of hashcode within its segment */
+static inline uint32
+BufMappingHome(uint32 hashcode)
+{
+	return (hashcode / NUM_BUFFER_PARTITIONS) & (BufMappingSegmentSize - 1);
+}
+
+/*
+ * Find the entry for a tag in its segment.  Returns the position, or -1 if
+ * not found; *slot is set to the entry.
+ */
+static inline int
+BufMappingFind(pg_atomic_uint64 *segment, BufferTag *tagPtr, uint32 hashcode,
+			   uint64 *slot)
+{
+	uint32		mask = BufMappingSegmentSize - 1;
+	uint32		pos = BufMappingHome(hashcode);
+
+	for (uint32 i = 0; i < BufMappingSegmentSize; i++)
+	{
+		uint64		entry = pg_atomic_read_u64(&segment[pos]);
+
+		if (entry == 0)
+			break;
+
+		if (BUF_MAPPING_SLOT_HASH(entry) == hashcode)
+		{
+			/* pairs with the write barrier in BufTableInsert() */
+			pg_read_barrier();
+			if (BufferTagsEqual(tagPtr,
+								&BufMappingTags[BUF_MAPPING_SLOT_ID(entry)]))
+			{
+				*slot = entry;
+				return pos;
+			}
+		}
+
+		pos = (pos + 1) & mask;
+	}
+
+	return -1;
+}
+
 
 /*
  * Estimate space needed for mapping hashtable
@@ -41,7 +141,16 @@ static HTAB *SharedBufHash;
 Size
 BufTableShmemSize(int size)
 {
-	return hash_estimate_size(size, sizeof(BufferLookupEnt));
+	Size		sz;
+
+	if (!lock_free_buffer_mapping)
+		return hash_estimate_size(size, sizeof(BufferLookupEnt));
+
+	sz = mul_size(NUM_BUFFER_PARTITIONS,
+				  mul_size(BufMappingSegmentSlots(size), sizeof(pg_atomic_uint64)));
+	sz = add_size(sz, mul_size(NBuffers, sizeof(BufferTag)));
+
+	return sz;
 }
 
 /*
@@ -55,6 +164,31 @@ InitBufTable(int size)
 
 	/* assume no locking is needed yet */
 
+	if (lock_free_buffer_mapping)
+	{
+		Size		nslots;
+		bool		found;
+
+		BufMappingSegmentSize = BufMappingSegmentSlots(size);
+		nslots = (Size) NUM_BUFFER_PARTITIONS * BufMappingSegmentSize;
+
+		BufMappingSlots = (pg_atomic_uint64 *)
+			ShmemInitStruct("Shared Buffer Lookup Table",
+							mul_size(nslots, sizeof(pg_atomic_uint64)),
+							&found);
+		BufMappingTags = (BufferTag *)
+			ShmemInitStruct("Shared Buffer Lookup Table Tags",
+							mul_size(NBuffers, sizeof(BufferTag)),
+							&found);
+
+		if (!found)
+		{
+			for (Size i = 0; i < nslots; i++)
+				pg_atomic_init_u64(&BufMappingSlots[i], 0);
+		}
+		return;
+	}
+
 	/* BufferTag maps to Buffer */
 	info.keysize = sizeof(BufferTag);
 	info.entrysize = sizeof(BufferLookupEnt);
@@ -78,6 +212,10 @@ InitBufTable(int size)
 uint32
 BufTableHashCode(BufferTag *tagPtr)
 {
+	/* same as what dynahash uses for HASH_BLOBS keys */
+	if (lock_free_buffer_mapping)
+		return tag_hash(tagPtr, sizeof(BufferTag));
+
 	return get_hash_value(SharedBufHash, (void *) tagPtr);
 }
 
@@ -86,12 +224,28 @@ BufTableHashCode(BufferTag *tagPtr)
  *		Lookup the given BufferTag; return buffer ID, or -1 if not found
  *
  * Caller must hold at least share lock on BufMappingLock for tag's partition
+ *
+ * With lock_free_buffer_mapping, the caller may also search without the lock.
+ * The result is then only a hint: the buffer may be mapped to another page
+ * by the time the caller looks at it, so it must check the buffer's tag
+ * under the buffer header lock, and a page that is in the table may be
+ * missed.
  */
 int
 BufTableLookup(BufferTag *tagPtr, uint32 hashcode)
 {
 	BufferLookupEnt *result;
 
+	if (lock_free_buffer_mapping)
+	{
+		uint64		slot;
+
+		if (BufMappingFind(BufMappingSegment(hashcode), tagPtr, hashcode,
+						   &slot) < 0)
+			return -1;
+		return BUF_MAPPING_SLOT_ID(slot);
+	}
+
 	result = (BufferLookupEnt *)
 		hash_search_with_hash_value(SharedBufHash,
 									tagPtr,
@@ -124,6 +278,39 @@ BufTableInsert(BufferTag *tagPtr, uint32 hashcode, int buf_id)
 	Assert(buf_id >= 0);		/* -1 is reserved for not-in-table */
 	Assert(tagPtr->blockNum != P_NEW);	/* invalid tag */
 
+	if (lock_free_buffer_mapping)
+	{
+		pg_atomic_uint64 *segment = BufMappingSegment(hashcode);
+		uint32		mask = BufMappingSegmentSize - 1;
+		uint32		pos = BufMappingHome(hashcode);
+
+		for (uint32 i = 0; i < BufMappingSegmentSize; i++)
+		{
+			uint64		entry = pg_atomic_read_u64(&segment[pos]);
+
+			if (entry == 0)
+			{
+				Assert(buf_id < NBuffers);
+
+				/* publish the tag before the entry pointing to it */
+				BufMappingTags[buf_id] = *tagPtr;
+				pg_write_barrier();
+				pg_atomic_write_u64(&segment[pos],
+									BUF_MAPPING_SLOT(hashcode, buf_id));
+				return -1;
+			}
+
+			if (BUF_MAPPING_SLOT_HASH(entry) == hashcode &&
+				BufferTagsEqual(tagPtr,
+								&BufMappingTags[BUF_MAPPING_SLOT_ID(entry)]))
+				return BUF_MAPPING_SLOT_ID(entry);
+
+			pos = (pos + 1) & mask;
+		}
+
+		elog(ERROR, "shared buffer lookup table is full");
+	}
+
 	result = (BufferLookupEnt *)
 		hash_search_with_hash_value(SharedBufHash,
 									tagPtr,
@@ -150,6 +337,45 @@ BufTableDelete(BufferTag *tagPtr, uint32 hashcode)
 {
 	BufferLookupEnt *result;
 
+	if (lock_free_buffer_mapping)
+	{
+		pg_atomic_uint64 *segment = BufMappingSegment(hashcode);
+		uint32		mask = BufMappingSegmentSize - 1;
+		uint64		slot;
+		int			hole;
+		uint32		pos;
+
+		hole = BufMappingFind(segment, tagPtr, hashcode, &slot);
+		if (hole < 0)			/* shouldn't happen */
+			elog(ERROR, "shared buffer hash table corrupted");
+
+		/*
+		 * Shift back the entries following the hole that would be reachable
+		 * from their home position through it.  An entry is copied before its
+		 * old slot is reused, so that a concurrent unlocked lookup may miss
+		 * it but never sees a wrong one.
+		 */
+		pos = (hole + 1) & mask;
+		for (;;)
+		{
+			uint64		entry = pg_atomic_read_u64(&segment[pos]);
+			uint32		home;
+
+			if (entry == 0)
+				break;
+
+			home = BufMappingHome(BUF_MAPPING_SLOT_HASH(entry));
+			if (((pos - home) & mask) >= ((pos - hole) & mask))
+			{
+				pg_atomic_write_u64(&segment[hole], entry);
+				hole = pos;
+			}
+			pos = (pos + 1) & mask;
+		}
+		pg_atomic_write_u64(&segment[hole], 0);
+		return;
+	}
+
 	result = (BufferLookupEnt *)
 		hash_search_with_hash_value(SharedBufHash,
 									tagPtr,
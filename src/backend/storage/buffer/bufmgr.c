@@ -47,6 +47,7 @@
 #include "postmaster/bgwriter.h"
 #include "storage/buf_internals.h"
 #include "storage/bufmgr.h"
+#include "storage/buftrace.h"
 #include "storage/ipc.h"
 #include "storage/lmgr.h"
 #include "storage/proc.h"
@@ -205,11 +206,6 @@ static PrivateRefCountEntry *GetPrivateRefCountEntry(Buffer buffer, bool do_move
 static inline int32 GetPrivateRefCount(Buffer buffer);
 static void ForgetPrivateRefCountEntry(PrivateRefCountEntry *ref);
 
-// change,lru
-extern void StrategyAccessBuffer(int buf_id, bool delete);
-// change,EAclock
-extern void UpdateWeight();
-
 /*
  * Ensure that the PrivateRefCountArray has sufficient space to store one more
  * entry. This has to be called before using NewPrivateRefCountEntry() to fill
@@ -474,6 +470,8 @@ static BlockNumber ExtendBufferedRelShared(BufferManagerRelation bmr,
 										   uint32 *extended_by);
 static bool PinBuffer(BufferDesc *buf, BufferAccessStrategy strategy);
 static void PinBuffer_Locked(BufferDesc *buf);
+static bool PinBufferForTag(BufferDesc *buf, const BufferTag *tag,
+							BufferAccessStrategy strategy, bool *valid);
 static void UnpinBuffer(BufferDesc *buf);
 static void BufferSync(int flags);
 static uint32 WaitBufHdrUnlocked(BufferDesc *buf);
@@ -490,8 +488,10 @@ static BufferDesc *BufferAlloc(SMgrRelation smgr,
 							   ForkNumber forkNum,
 							   BlockNumber blockNum,
 							   BufferAccessStrategy strategy,
-							   bool *foundPtr, IOContext io_context);
-static Buffer GetVictimBuffer(BufferAccessStrategy strategy, IOContext io_context);
+							   bool *foundPtr, bool *from_ring,
+							   IOContext io_context);
+static Buffer GetVictimBuffer(BufferAccessStrategy strategy, IOContext io_context,
+							  bool *from_ring);
 static void FlushBuffer(BufferDesc *buf, SMgrRelation reln,
 						IOObject io_object, IOContext io_context);
 static void FindAndDropRelationBuffers(RelFileLocator rlocator,
@@ -533,10 +533,18 @@ PrefetchSharedBuffer(SMgrRelation smgr_reln,
 	newHash = BufTableHashCode(&newTag);
 	newPartitionLock = BufMappingPartitionLock(newHash);
 
-	/* see if the block is in the buffer pool already */
-	LWLockAcquire(newPartitionLock, LW_SHARED);
-	buf_id = BufTableLookup(&newTag, newHash);
-	LWLockRelease(newPartitionLock);
+	/*
+	 * See if the block is in the buffer pool already.  The result is only a
+	 * hint in any case, so the lock-free table needs no lock.
+	 */
+	if (lock_free_buffer_mapping)
+		buf_id = BufTableLookup(&newTag, newHash);
+	else
+	{
+		LWLockAcquire(newPartitionLock, LW_SHARED);
+		buf_id = BufTableLookup(&newTag, newHash);
+		LWLockRelease(newPartitionLock);
+	}
 
 	/* If not in buffers, initiate prefetch */
 	if (buf_id < 0)
@@ -694,21 +702,10 @@ ReadRecentBuffer(RelFileLocator rlocator, ForkNumber forkNum, BlockNumber blockN
 
 			pgBufferUsage.shared_blks_hit++;
 
-// change,EAclock
-			if(Algorithm->algorithm_first == 'e')
-			{
-				UpdateValue(bufHdr->buf_id);
-			}
-// change,lru
-			else if(Algorithm->algorithm_first == 'l')
-			{
-				StrategyAccessBuffer(bufHdr->buf_id, false);
-			}
-// change,clock
-			else if(Algorithm->algorithm_first == 'c')
-			{
-				bufHdr->flag=true;
-			}
+			StrategyBufferHit(bufHdr);
+
+			if (unlikely(BufferTraceEnabled))
+				BufferTraceAccess(&bufHdr->tag, BUFTRACE_HIT);
 
 			return true;
 		}
@@ -721,6 +718,69 @@ ReadRecentBuffer(RelFileLocator rlocator, ForkNumber forkNum, BlockNumber blockN
 	return false;
 }
 
+/*
+ * RestoreBufferPolicyState -- give a cached page its former replacement state
+ *
+ * If the page identified by tag is in shared buffers, set its usage count
+ * and hand usage and info, which describe the page as StrategyDescribeBuffers()
+ * once did under policy "policy", to the replacement policy, and return true.
+ * Used by autoprewarm to carry a pool's hot set over a restart.  The buffer
+ * is pinned meanwhile, so that it can't be evicted under the policy's nose.
+ */
+bool
+RestoreBufferPolicyState(BufferTag *tag, int usage, const char *policy,
+						 const BufferPolicyBufferInfo *info)
+{
+	uint32		hash = BufTableHashCode(tag);
+	LWLock	   *partitionLock = BufMappingPartitionLock(hash);
+	BufferDesc *bufHdr;
+	Buffer		buffer;
+	uint32		buf_state;
+	int			buf_id;
+
+	ResourceOwnerEnlargeBuffers(CurrentResourceOwner);
+	ReservePrivateRefCountEntry();
+
+	LWLockAcquire(partitionLock, LW_SHARED);
+	buf_id = BufTableLookup(tag, hash);
+	LWLockRelease(partitionLock);
+	if (buf_id < 0)
+		return false;
+
+	bufHdr = GetBufferDescriptor(buf_id);
+	buffer = BufferDescriptorGetBuffer(bufHdr);
+
+	/* As in ReadRecentBuffer(), check the tag before pinning */
+	if (GetPrivateRefCount(buffer) > 0)
+	{
+		if (!BufferTagsEqual(tag, &bufHdr->tag))
+			return false;
+		PinBuffer(bufHdr, NULL);
+	}
+	else
+	{
+		buf_state = LockBufHdr(bufHdr);
+		if (!(buf_state & BM_VALID) || !BufferTagsEqual(tag, &bufHdr->tag))
+		{
+			UnlockBufHdr(bufHdr, buf_state);
+			return false;
+		}
+		PinBuffer_Locked(bufHdr);
+	}
+
+	usage = Min(Max(usage, 0), BM_MAX_USAGE_COUNT);
+	buf_state = LockBufHdr(bufHdr);
+	buf_state &= ~BUF_USAGECOUNT_MASK;
+	buf_state += usage * BUF_USAGECOUNT_ONE;
+	UnlockBufHdr(bufHdr, buf_state);
+
+	StrategyRestoreBuffer(bufHdr, usage, policy, info);
+
+	ReleaseBuffer(buffer);
+
+	return true;
+}
+
 /*
  * ReadBuffer -- a shorthand for ReadBufferExtended, for reading from main
  *		fork with RBM_NORMAL mode and default strategy.
@@ -1017,6 +1077,7 @@ ReadBuffer_common(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 	BufferDesc *bufHdr;
 	Block		bufBlock;
 	bool		found;
+	bool		from_ring;
 	IOContext	io_context;
 	IOObject	io_object;
 	bool		isLocalBuf = SmgrIsTemp(smgr);
@@ -1079,31 +1140,33 @@ ReadBuffer_common(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 		io_context = IOContextForStrategy(strategy);
 		io_object = IOOBJECT_RELATION;
 		bufHdr = BufferAlloc(smgr, relpersistence, forkNum, blockNum,
-							 strategy, &found, io_context);
+							 strategy, &found, &from_ring, io_context);
 
-// change,EAclock
-
-		if(Algorithm->algorithm_first == 'e')
-		{
-			UpdateValue(bufHdr->buf_id);
-		}
-// change,lru，修改
-		else if(Algorithm->algorithm_first == 'l')
+		/*
+		 * Keep the replacement policy out of accesses made through a
+		 * strategy's ring, as PinBuffer() keeps their usage counts low, so
+		 * that a large scan doesn't make its pages look hot.  A buffer newly
+		 * taken into the ring still has to be reported, since the policy
+		 * needs to learn about the page now in it.
+		 */
+		if (found)
 		{
-			StrategyAccessBuffer(bufHdr->buf_id, false); 
+			if (strategy == NULL)
+				StrategyBufferHit(bufHdr);
+			pgBufferUsage.shared_blks_hit++;
 		}
-// change,clock
-		else if(Algorithm->algorithm_first == 'c')
+		else
 		{
-			bufHdr->flag=true;
+			if (!from_ring)
+				StrategyBufferMiss(bufHdr);
+			if (mode == RBM_NORMAL || mode == RBM_NORMAL_NO_LOG ||
+				mode == RBM_ZERO_ON_ERROR)
+				pgBufferUsage.shared_blks_read++;
 		}
-		
 
-		if (found)
-			pgBufferUsage.shared_blks_hit++;
-		else if (mode == RBM_NORMAL || mode == RBM_NORMAL_NO_LOG ||
-				 mode == RBM_ZERO_ON_ERROR)
-			pgBufferUsage.shared_blks_read++;
+		if (unlikely(BufferTraceEnabled))
+			BufferTraceAccess(&bufHdr->tag,
+							  found ? BUFTRACE_HIT : BUFTRACE_MISS);
 	}
 
 	/* At this point we do NOT hold any locks. */
@@ -1250,6 +1313,9 @@ ReadBuffer_common(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
  * *foundPtr is actually redundant with the buffer's BM_VALID flag, but
  * we keep it for simplicity in ReadBuffer.
  *
+ * *from_ring is set true if the buffer was recycled from the strategy's
+ * ring, rather than newly taken from the pool.
+ *
  * io_context is passed as an output parameter to avoid calling
  * IOContextForStrategy() when there is a shared buffers hit and no IO
  * statistics need be captured.
@@ -1260,7 +1326,7 @@ static BufferDesc *
 BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 			BlockNumber blockNum,
 			BufferAccessStrategy strategy,
-			bool *foundPtr, IOContext io_context)
+			bool *foundPtr, bool *from_ring, IOContext io_context)
 {
 	BufferTag	newTag;			/* identity of requested block */
 	uint32		newHash;		/* hash value for newTag */
@@ -1270,6 +1336,8 @@ BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 	BufferDesc *victim_buf_hdr;
 	uint32		victim_buf_state;
 
+	*from_ring = false;
+
 	/* create a tag so we can lookup the buffer */
 	InitBufferTag(&newTag, &smgr->smgr_rlocator.locator, forkNum, blockNum);
 
@@ -1277,9 +1345,40 @@ BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 	newHash = BufTableHashCode(&newTag);
 	newPartitionLock = BufMappingPartitionLock(newHash);
 
-	/* see if the block is in the buffer pool already */
-	LWLockAcquire(newPartitionLock, LW_SHARED);
-	existing_buf_id = BufTableLookup(&newTag, newHash);
+	/*
+	 * See if the block is in the buffer pool already.  The lock-free table
+	 * is searched without the mapping lock; what it finds is only pinned if
+	 * it still holds the block once the buffer header is locked.  If the
+	 * block is missed, we'll run into it when entering it below.
+	 */
+	if (lock_free_buffer_mapping)
+	{
+		existing_buf_id = BufTableLookup(&newTag, newHash);
+		if (existing_buf_id >= 0)
+		{
+			BufferDesc *buf;
+			bool		valid;
+
+			buf = GetBufferDescriptor(existing_buf_id);
+			if (PinBufferForTag(buf, &newTag, strategy, &valid))
+			{
+				*foundPtr = true;
+
+				/* see comments below */
+				if (!valid && StartBufferIO(buf, true))
+					*foundPtr = false;
+
+				return buf;
+			}
+		}
+		existing_buf_id = -1;
+	}
+	else
+	{
+		LWLockAcquire(newPartitionLock, LW_SHARED);
+		existing_buf_id = BufTableLookup(&newTag, newHash);
+	}
+
 	if (existing_buf_id >= 0)
 	{
 		BufferDesc *buf;
@@ -1325,14 +1424,15 @@ BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 	 * Didn't find it in the buffer pool.  We'll have to initialize a new
 	 * buffer.  Remember to unlock the mapping lock while doing the work.
 	 */
-	LWLockRelease(newPartitionLock);
+	if (!lock_free_buffer_mapping)
+		LWLockRelease(newPartitionLock);
 
 	/*
 	 * Acquire a victim buffer. Somebody else might try to do the same, we
 	 * don't hold any conflicting locks. If so we'll have to undo our work
 	 * later.
 	 */
-	victim_buffer = GetVictimBuffer(strategy, io_context);
+	victim_buffer = GetVictimBuffer(strategy, io_context, from_ring);
 
 	victim_buf_hdr = GetBufferDescriptor(victim_buffer - 1);
 
@@ -1377,6 +1477,7 @@ BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 		LWLockRelease(newPartitionLock);
 
 		*foundPtr = true;
+		*from_ring = false;
 
 		if (!valid)
 		{
@@ -1623,12 +1724,12 @@ InvalidateVictimBuffer(BufferDesc *buf_hdr)
 }
 
 static Buffer
-GetVictimBuffer(BufferAccessStrategy strategy, IOContext io_context)
+GetVictimBuffer(BufferAccessStrategy strategy, IOContext io_context,
+				bool *from_ring)
 {
 	BufferDesc *buf_hdr;
 	Buffer		buf;
 	uint32		buf_state;
-	bool		from_ring;
 
 	/*
 	 * Ensure, while the spinlock's not yet held, that there's a free refcount
@@ -1644,7 +1745,7 @@ again:
 	 * Select a victim buffer.  The buffer is returned with its header
 	 * spinlock still held!
 	 */
-	buf_hdr = StrategyGetBuffer(strategy, &buf_state, &from_ring);
+	buf_hdr = StrategyGetBuffer(strategy, &buf_state, from_ring);
 
 	buf = BufferDescriptorGetBuffer(buf_hdr);
 
@@ -1714,7 +1815,7 @@ again:
 			UnlockBufHdr(buf_hdr, buf_state);
 
 			if (XLogNeedsFlush(lsn)
-				&& StrategyRejectBuffer(strategy, buf_hdr, from_ring))
+				&& StrategyRejectBuffer(strategy, buf_hdr, *from_ring))
 			{
 				LWLockRelease(content_lock);
 				UnpinBuffer(buf_hdr);
@@ -1750,7 +1851,7 @@ again:
 		 * pinners or erroring out.
 		 */
 		pgstat_count_io_op(IOOBJECT_RELATION, io_context,
-						   from_ring ? IOOP_REUSE : IOOP_EVICT);
+						   *from_ring ? IOOP_REUSE : IOOP_EVICT);
 	}
 
 	/*
@@ -1877,9 +1978,17 @@ ExtendBufferedRelShared(BufferManagerRelation bmr,
 	BlockNumber first_block;
 	IOContext	io_context = IOContextForStrategy(strategy);
 	instr_time	io_start;
+	bool	   *from_ring = NULL;
 
 	LimitAdditionalPins(&extend_by);
 
+	/*
+	 * Buffers recycled from a strategy ring aren't news to the replacement
+	 * policy, so remember which ones were, as ReadBuffer_common does.
+	 */
+	if (strategy != NULL)
+		from_ring = palloc(extend_by * sizeof(bool));
+
 	/*
 	 * Acquire victim buffers for extension without holding extension lock.
 	 * Writing out victim buffers is the most expensive part of extending the
@@ -1893,8 +2002,11 @@ ExtendBufferedRelShared(BufferManagerRelation bmr,
 	for (uint32 i = 0; i < extend_by; i++)
 	{
 		Block		buf_block;
+		bool		ring_buffer;
 
-		buffers[i] = GetVictimBuffer(strategy, io_context);
+		buffers[i] = GetVictimBuffer(strategy, io_context, &ring_buffer);
+		if (from_ring)
+			from_ring[i] = ring_buffer;
 		buf_block = BufHdrGetBlock(GetBufferDescriptor(buffers[i] - 1));
 
 		/* new buffers are zero-filled */
@@ -1961,6 +2073,8 @@ ExtendBufferedRelShared(BufferManagerRelation bmr,
 		{
 			if (!(flags & EB_SKIP_EXTENSION_LOCK))
 				UnlockRelationForExtension(bmr.rel, ExclusiveLock);
+			if (from_ring)
+				pfree(from_ring);
 			*extended_by = extend_by;
 			return first_block;
 		}
@@ -2131,10 +2245,19 @@ ExtendBufferedRelShared(BufferManagerRelation bmr,
 			LWLockAcquire(BufferDescriptorGetContentLock(buf_hdr), LW_EXCLUSIVE);
 
 		TerminateBufferIO(buf_hdr, false, BM_VALID);
+
+		if (from_ring == NULL || !from_ring[i])
+			StrategyBufferMiss(buf_hdr);
+
+		if (unlikely(BufferTraceEnabled))
+			BufferTraceAccess(&buf_hdr->tag, BUFTRACE_EXTEND);
 	}
 
 	pgBufferUsage.shared_blks_written += extend_by;
 
+	if (from_ring)
+		pfree(from_ring);
+
 	*extended_by = extend_by;
 
 	return first_block;
@@ -2411,6 +2534,69 @@ PinBuffer_Locked(BufferDesc *buf)
 	ResourceOwnerRememberBuffer(CurrentResourceOwner, b);
 }
 
+/*
+ * PinBufferForTag -- pin a buffer found without the buffer mapping lock
+ *
+ * Without the mapping lock, the buffer may have been given to another page
+ * since it was looked up.  Pin it only if it is still tagged with the given
+ * tag, which the buffer header lock guarantees, and return whether it was.
+ * The usage count is adjusted as PinBuffer() does, and *valid is set as
+ * PinBuffer()'s result.
+ *
+ * As with ReadRecentBuffer(), we can't pin first and check afterwards,
+ * because pinning an unrelated buffer could confuse InvalidateBuffer().
+ *
+ * Note that ResourceOwnerEnlargeBuffers must have been done already.
+ */
+static bool
+PinBufferForTag(BufferDesc *buf, const BufferTag *tag,
+				BufferAccessStrategy strategy, bool *valid)
+{
+	Buffer		b = BufferDescriptorGetBuffer(buf);
+	PrivateRefCountEntry *ref;
+	uint32		buf_state;
+
+	/* If we hold a pin already, the tag can't change under us */
+	if (GetPrivateRefCount(b) > 0)
+	{
+		if (!BufferTagsEqual(tag, &buf->tag))
+			return false;
+		*valid = PinBuffer(buf, strategy);
+		return true;
+	}
+
+	ReservePrivateRefCountEntry();
+
+	buf_state = LockBufHdr(buf);
+	if (!(buf_state & BM_TAG_VALID) || !BufferTagsEqual(tag, &buf->tag))
+	{
+		UnlockBufHdr(buf, buf_state);
+		return false;
+	}
+
+	buf_state += BUF_REFCOUNT_ONE;
+	if (strategy == NULL)
+	{
+		if (BUF_STATE_GET_USAGECOUNT(buf_state) < BM_MAX_USAGE_COUNT)
+			buf_state += BUF_USAGECOUNT_ONE;
+	}
+	else
+	{
+		if (BUF_STATE_GET_USAGECOUNT(buf_state) == 0)
+			buf_state += BUF_USAGECOUNT_ONE;
+	}
+	*valid = (buf_state & BM_VALID) != 0;
+	UnlockBufHdr(buf, buf_state);
+
+	VALGRIND_MAKE_MEM_DEFINED(BufHdrGetBlock(buf), BLCKSZ);
+
+	ref = NewPrivateRefCountEntry(b);
+	ref->refcount++;
+	ResourceOwnerRememberBuffer(CurrentResourceOwner, b);
+
+	return true;
+}
+
 /*
  * UnpinBuffer -- make buffer available for replacement.
  *
@@ -3047,6 +3233,13 @@ BgBufferSync(WritebackContext *wb_context)
 
 	PendingBgWriterStats.buf_written_clean += num_written;
 
+	/*
+	 * With the buffers ahead of the sweep cleaned, pre-select victims for the
+	 * next cycle's allocations, so that backends needn't run the replacement
+	 * policy themselves.
+	 */
+	StrategyFillVictimQueue(upcoming_alloc_est);
+
 #ifdef BGW_DEBUG
 	elog(DEBUG1, "bgwriter: recent_alloc=%u smoothed=%.2f delta=%ld ahead=%d density=%.2f reusable_est=%d upcoming_est=%d scanned=%d wrote=%d reusable=%d",
 		 recent_alloc, smoothed_alloc, strategy_delta, bufs_ahead,
@@ -3175,6 +3368,8 @@ AtEOXact_Buffers(bool isCommit)
 {
 	CheckForBufferLeaks();
 
+	StrategyFlushBufferHits();
+
 	AtEOXact_LocalBuffers(isCommit);
 
 	Assert(PrivateRefCountOverflowed == 0);
@@ -3219,6 +3414,8 @@ AtProcExit_Buffers(int code, Datum arg)
 
 	CheckForBufferLeaks();
 
+	StrategyFlushBufferHits();
+
 	/* localbuf.c needs a chance too */
 	AtProcExit_LocalBuffers();
 }
@@ -0,0 +1,229 @@
+/*-------------------------------------------------------------------------
+ *
+ * buftrace.c
+ *	  Recording of shared buffer accesses for offline replay.
+ *
+ * When buffer_trace_directory is set, each process appends a record for
+ * every shared buffer hit, miss and relation extension to a trace file of
+ * its own in that directory, named after its PID.  Records are collected in
+ * a small backend-local buffer and written out when it fills up and at
+ * process exit, so that tracing costs one write() per few hundred accesses.
+ * See buftrace.h for the file format, and pg_bufsim for a tool replaying the
+ * traces against the buffer replacement policies.
+ *
+ * Tracing is a diagnostic aid: if a trace file can't be opened or written,
+ * we emit a WARNING and stop tracing in this process until the setting is
+ * changed, rather than fail the query.
+ *
+ * Portions Copyright (c) 1996-2023, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/storage/buffer/buftrace.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "miscadmin.h"
+#include "storage/buf_internals.h"
+#include "storage/buftrace.h"
+#include "storage/fd.h"
+#include "storage/ipc.h"
+#include "utils/guc_hooks.h"
+#include "utils/timestamp.h"
+
+/* number of records collected before they are written out */
+#define BUFTRACE_BUFFER_RECORDS		256
+
+/* GUC variable */
+char	   *buffer_trace_directory = "";
+
+/* true if buffer_trace_directory is set and tracing hasn't failed */
+bool		BufferTraceEnabled = false;
+
+static int	TraceFile = -1;
+static bool TraceReopen = false;
+static bool TraceExitRegistered = false;
+static BufferTraceRecord TraceBuffer[BUFTRACE_BUFFER_RECORDS];
+static int	NumTraceRecords = 0;
+
+static void BufferTraceClose(void);
+
+/*
+ * Give up on tracing in this process, after a failure has been reported.
+ */
+static void
+BufferTraceDisable(void)
+{
+	if (TraceFile >= 0)
+	{
+		close(TraceFile);
+		ReleaseExternalFD();
+		TraceFile = -1;
+	}
+	NumTraceRecords = 0;
+	BufferTraceEnabled = false;
+}
+
+/*
+ * Write out the collected records.
+ */
+static void
+BufferTraceFlush(void)
+{
+	Size		len = NumTraceRecords * sizeof(BufferTraceRecord);
+
+	if (NumTraceRecords == 0 || TraceFile < 0)
+		return;
+
+	errno = 0;
+	if (write(TraceFile, TraceBuffer, len) != len)
+	{
+		/* if write didn't set errno, assume problem is no disk space */
+		if (errno == 0)
+			errno = ENOSPC;
+		ereport(WARNING,
+				(errcode_for_file_access(),
+				 errmsg("could not write to buffer trace file: %m"),
+				 errdetail("Buffer tracing is disabled for this session.")));
+		BufferTraceDisable();
+		return;
+	}
+
+	NumTraceRecords = 0;
+}
+
+/*
+ * Flush and close the current trace file, if any.
+ */
+static void
+BufferTraceClose(void)
+{
+	BufferTraceFlush();
+
+	if (TraceFile >= 0)
+	{
+		close(TraceFile);
+		ReleaseExternalFD();
+		TraceFile = -1;
+	}
+}
+
+static void
+BufferTraceAtExit(int code, Datum arg)
+{
+	BufferTraceClose();
+}
+
+/*
+ * Open this process's trace file in buffer_trace_directory, writing the file
+ * header if the file is new.
+ */
+static void
+BufferTraceOpen(void)
+{
+	char		path[MAXPGPATH];
+	struct stat st;
+
+	Assert(TraceFile < 0);
+
+	snprintf(path, sizeof(path), "%s/%s%d",
+			 buffer_trace_directory, BUFTRACE_FILE_PREFIX, MyProcPid);
+
+	TraceFile = BasicOpenFile(path, O_WRONLY | O_CREAT | O_APPEND | PG_BINARY);
+	if (TraceFile < 0)
+	{
+		ereport(WARNING,
+				(errcode_for_file_access(),
+				 errmsg("could not open buffer trace file \"%s\": %m", path),
+				 errdetail("Buffer tracing is disabled for this session.")));
+		BufferTraceDisable();
+		return;
+	}
+	ReserveExternalFD();
+
+	if (!TraceExitRegistered)
+	{
+		on_proc_exit(BufferTraceAtExit, 0);
+		TraceExitRegistered = true;
+	}
+
+	if (fstat(TraceFile, &st) == 0 && st.st_size == 0)
+	{
+		BufferTraceFileHeader hdr;
+
+		hdr.magic = BUFTRACE_MAGIC;
+		hdr.version = BUFTRACE_VERSION;
+		hdr.blcksz = BLCKSZ;
+		hdr.pid = MyProcPid;
+
+		errno = 0;
+		if (write(TraceFile, &hdr, sizeof(hdr)) != sizeof(hdr))
+		{
+			if (errno == 0)
+				errno = ENOSPC;
+			ereport(WARNING,
+					(errcode_for_file_access(),
+					 errmsg("could not write to buffer trace file \"%s\": %m",
+							path),
+					 errdetail("Buffer tracing is disabled for this session.")));
+			BufferTraceDisable();
+		}
+	}
+}
+
+/*
+ * BufferTraceAccess -- record an access to the page in a shared buffer
+ *
+ * Callers check BufferTraceEnabled first, so that this costs nothing while
+ * tracing is off.  No buffer header lock may be held.
+ */
+void
+BufferTraceAccess(const BufferTag *tag, uint8 event)
+{
+	BufferTraceRecord *rec;
+
+	if (TraceReopen)
+	{
+		BufferTraceClose();
+		TraceReopen = false;
+	}
+
+	if (TraceFile < 0)
+	{
+		BufferTraceOpen();
+		if (TraceFile < 0)
+			return;
+	}
+
+	rec = &TraceBuffer[NumTraceRecords++];
+	rec->time = GetCurrentTimestamp();
+	rec->spcOid = tag->spcOid;
+	rec->dbOid = tag->dbOid;
+	rec->relNumber = BufTagGetRelNumber(tag);
+	rec->blockNum = tag->blockNum;
+	rec->pid = MyProcPid;
+	rec->forkNum = BufTagGetForkNum(tag);
+	rec->event = event;
+	rec->padding = 0;
+
+	if (NumTraceRecords == BUFTRACE_BUFFER_RECORDS)
+		BufferTraceFlush();
+}
+
+/*
+ * GUC assign hook for buffer_trace_directory.  Switching to the new file is
+ * left to the next traced access, since an assign hook must not fail.
+ */
+void
+assign_buffer_trace_directory(const char *newval, void *extra)
+{
+	BufferTraceEnabled = (newval[0] != '\0');
+	TraceReopen = true;
+}
@@ -15,45 +15,84 @@
  */
 #include "postgres.h"
 
+#include <float.h>
+
+#include "common/pg_prng.h"
+#include "miscadmin.h"
 #include "pgstat.h"
 #include "port/atomics.h"
+#include "port/pg_bitutils.h"
+#include "port/simd.h"
 #include "storage/buf_internals.h"
 #include "storage/bufmgr.h"
 #include "storage/proc.h"
+#include "storage/procsignal.h"
+#include "utils/guc_hooks.h"
 
 
 #define INT_ACCESS_ONCE(var)	((int)(*((volatile int *)&(var))))
 
+/* GUC variable */
+char	   *buffer_replacement_policy = "clocksweep";
+
+/*
+ * The replacement policy this process uses, as of policy generation
+ * BufferPolicyGeneration.  While a switch is in progress, this points to
+ * SwitchingBufferPolicy, which consults both SwitchFromPolicy and
+ * SwitchToPolicy.  See StrategyUpdateBufferPolicy().
+ */
+const BufferPolicyRoutine *BufferPolicy = NULL;
+uint32		BufferPolicyGeneration = 0;
+pg_atomic_uint32 *SharedBufferPolicyGeneration = NULL;
+static const BufferPolicyRoutine *SwitchFromPolicy = NULL;
+static const BufferPolicyRoutine *SwitchToPolicy = NULL;
+
+/* the active policy's entry in the cumulative statistics */
+static int	BufferPolicyStatsIndex = 0;
 
-// change,lru
-void StrategyAccessBuffer(int buf_id, bool delete); 
-// change,EAclock
-extern void UpdateWeight();
+/* Backend-local batch of hits, and the pages hit, see StrategyBufferHit() */
+int			PendingBufferHits[BUFFER_HIT_BATCH_SIZE];
+BufferTag	PendingBufferHitTags[BUFFER_HIT_BATCH_SIZE];
+int			NumPendingBufferHits = 0;
 
 /*
- * The shared freelist control information.
+ * Each partition of the buffer pool has a clock hand of its own, in a cache
+ * line of its own.
  */
 typedef struct
 {
-	/* Spinlock: protects the values below */
-	slock_t		buffer_strategy_lock;
-
 	/*
-	 * Clock sweep hand: index of next buffer to consider grabbing. Note that
-	 * this isn't a concrete buffer - we only ever increase the value. So, to
-	 * get an actual buffer, it needs to be used modulo NBuffers.
+	 * Clock sweep hand: index of next buffer to consider grabbing, relative
+	 * to the partition's first buffer. Note that this isn't a concrete buffer
+	 * - we only ever increase the value. So, to get an actual buffer, it
+	 * needs to be used modulo the partition's size.
 	 */
 	pg_atomic_uint32 nextVictimBuffer;
 
+	/* Complete cycles of the clock sweep, protected by buffer_strategy_lock */
+	uint32		completePasses;
+
+	/* Buffers taken from the partition by victim searches */
+	pg_atomic_uint32 numVictims;
+} BufferPartitionSweep;
+
+typedef union BufferPartitionSweepPadded
+{
+	BufferPartitionSweep sweep;
+	char		pad[PG_CACHE_LINE_SIZE];
+} BufferPartitionSweepPadded;
+
+/*
+ * The shared freelist control information.
+ */
+typedef struct
+{
+	/* Spinlock: protects the values below */
+	slock_t		buffer_strategy_lock;
+
 	int			firstFreeBuffer;	/* Head of list of unused buffers */
 	int			lastFreeBuffer; /* Tail of list of unused buffers */
 
-// change,lru
-	slock_t 	lru_lock;
-	// Pointer to the top and bottom nodes of the BufferNode stack.
-	BufferNode *stackTop;
-	BufferNode *stackBottom;
-
 	/*
 	 * NOTE: lastFreeBuffer is undefined when firstFreeBuffer is -1 (that is,
 	 * when the list is empty)
@@ -63,7 +102,6 @@ typedef struct
 	 * Statistics.  These counters should be wide enough that they can't
 	 * overflow during a single bgwriter cycle.
 	 */
-	uint32		completePasses; /* Complete cycles of the clock sweep */
 	pg_atomic_uint32 numBufferAllocs;	/* Buffers allocated since last reset */
 
 	/*
@@ -71,10 +109,58 @@ typedef struct
 	 * StrategyNotifyBgWriter.
 	 */
 	int			bgwprocno;
+
+	/*
+	 * The replacement policy in use, as an index into the policy registry,
+	 * and the one being switched to or -1.  policyGeneration is advanced
+	 * whenever they change, so that processes can cheaply tell that their
+	 * copy is out of date.
+	 */
+	int			activePolicy;
+	int			nextPolicy;
+	pg_atomic_uint32 policyGeneration;
+
+	/* Clock hands of the buffer pool partitions */
+	BufferPartitionSweepPadded partitions[MAX_BUFFER_POOL_PARTITIONS];
 } BufferStrategyControl;
 
+/*
+ * Victims pre-selected by the bgwriter, see StrategyFillVictimQueue().  There
+ * is one queue per buffer pool partition.
+ *
+ * This is a bounded multi-producer, multi-consumer queue in the style of
+ * Dmitry Vyukov's: each slot carries a sequence number telling whether it is
+ * ready to be filled (sequence == position) or emptied (sequence == position
+ * + 1) by whoever claims that position, so that producers and consumers only
+ * ever contend on their own position counter.
+ */
+typedef struct
+{
+	pg_atomic_uint32 sequence;
+	int			buf_id;
+} VictimQueueSlot;
+
+typedef struct
+{
+	/* next position to fill, and next position to empty */
+	pg_atomic_uint32 enqueuePos;
+	char		pad[PG_CACHE_LINE_SIZE];
+	pg_atomic_uint32 dequeuePos;
+
+	VictimQueueSlot slots[FLEXIBLE_ARRAY_MEMBER];
+} VictimQueue;
+
 /* Pointers to shared state */
 static BufferStrategyControl *StrategyControl = NULL;
+static char *StrategyVictims = NULL;
+
+/*
+ * The partition this process's victim search is currently in, and how many
+ * more buffers it may look at there before moving on to the next partition.
+ * See StrategyStartVictimSearch().
+ */
+static int	VictimSearchPartition = 0;
+static int	VictimSearchBudget = 0;
 
 /*
  * Private (non-shared) state for managing a ring of shared buffers to re-use.
@@ -109,46 +195,91 @@ static BufferDesc *GetBufferFromRing(BufferAccessStrategy strategy,
 									 uint32 *buf_state);
 static void AddBufferToRing(BufferAccessStrategy strategy,
 							BufferDesc *buf);
+static int	NumBufferPolicies(void);
+static const BufferPolicyRoutine *GetBufferPolicy(int policy_idx);
+static int	LookupBufferPolicy(const char *name);
+static void SetBufferPolicyState(int active, int next);
+static int	VictimQueueSize(void);
+static Size VictimQueueStride(void);
+static VictimQueue *GetVictimQueue(int part);
+static bool VictimQueuePush(VictimQueue *queue, int buf_id);
+static int	VictimQueuePop(VictimQueue *queue);
 
 /*
- * ClockSweepTick - Helper routine for StrategyGetBuffer()
+ * VictimSearchAdvance - Helper routine for the victim search
  *
- * Move the clock hand one buffer ahead of its current position and return the
- * id of the buffer now under the hand.
+ * Account for n more buffers looked at in the partition being searched, and
+ * return the partition to take them from.  Once a partition's worth of
+ * buffers has been looked at without finding a victim, the search spills
+ * over into the next partition, so that it can't get stuck in a partition
+ * full of pinned or hot buffers.
+ */
+static inline int
+VictimSearchAdvance(uint32 n)
+{
+	if (NumBufferPoolPartitions == 1)
+		return 0;
+
+	if (VictimSearchBudget < (int) n)
+	{
+		VictimSearchPartition = (VictimSearchPartition + 1) % NumBufferPoolPartitions;
+		VictimSearchBudget = BufferPoolPartitionEnd(VictimSearchPartition) -
+			BufferPoolPartitionStart(VictimSearchPartition);
+	}
+	VictimSearchBudget -= n;
+
+	return VictimSearchPartition;
+}
+
+/*
+ * ClockSweepTickRun - Helper routine for the clock-based policies
+ *
+ * Move the clock hand of the partition being searched n buffers ahead of its
+ * current position and return the id of the first buffer it passed.  The
+ * caller owns the run of n buffers starting there, which may wrap around
+ * past the last buffer of the partition, see ClockSweepRunNext().
  */
 static inline uint32
-ClockSweepTick(void)
+ClockSweepTickRun(uint32 n)
 {
+	int			part = VictimSearchAdvance(n);
+	BufferPartitionSweep *sweep = &StrategyControl->partitions[part].sweep;
+	uint32		start = BufferPoolPartitionStart(part);
+	uint32		size = BufferPoolPartitionEnd(part) - start;
 	uint32		victim;
 
+	Assert(n >= 1 && n <= size);
+
 	/*
-	 * Atomically move hand ahead one buffer - if there's several processes
+	 * Atomically move hand ahead n buffers - if there's several processes
 	 * doing this, this can lead to buffers being returned slightly out of
 	 * apparent order.
 	 */
-	victim =
-		pg_atomic_fetch_add_u32(&StrategyControl->nextVictimBuffer, 1);
+	victim = pg_atomic_fetch_add_u32(&sweep->nextVictimBuffer, n);
 
-	if (victim >= NBuffers)
+	if (victim + n > size)
 	{
 		uint32		originalVictim = victim;
+		uint32		nextWrap;
 
 		/* always wrap what we look up in BufferDescriptors */
-		victim = victim % NBuffers;
+		victim = victim % size;
 
 		/*
-		 * If we're the one that just caused a wraparound, force
-		 * completePasses to be incremented while holding the spinlock. We
-		 * need the spinlock so StrategySyncStart() can return a consistent
-		 * value consisting of nextVictimBuffer and completePasses.
+		 * If our run just caused a wraparound, that is if it contains a
+		 * nonzero multiple of the partition size, force completePasses to be
+		 * incremented while holding the spinlock. We need the spinlock so
+		 * StrategySyncStart() can return a consistent value consisting of
+		 * nextVictimBuffer and completePasses.
 		 */
-		if (victim == 0)
+		nextWrap = originalVictim + (size - victim) % size;
+		if (nextWrap > 0 && nextWrap < originalVictim + n)
 		{
 			uint32		expected;
 			uint32		wrapped;
 			bool		success = false;
 
-			expected = originalVictim + 1;
+			expected = originalVictim + n;
 
 			while (!success)
 			{
@@ -162,17 +293,169 @@ ClockSweepTick(void)
 				 */
 				SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
 
-				wrapped = expected % NBuffers;
+				wrapped = expected % size;
 
-				success = pg_atomic_compare_exchange_u32(&StrategyControl->nextVictimBuffer,
+				success = pg_atomic_compare_exchange_u32(&sweep->nextVictimBuffer,
 														 &expected, wrapped);
 				if (success)
-					StrategyControl->completePasses++;
+					sweep->completePasses++;
 				SpinLockRelease(&StrategyControl->buffer_strategy_lock);
 			}
+
+			pgstat_count_buffer_policy_clock_pass(BufferPolicyStatsIndex);
+		}
+	}
+	return start + victim;
+}
+
+/*
+ * ClockSweepRunNext - Helper routine for the clock-based policies
+ *
+ * Return the buffer following buf_id in a run handed out by
+ * ClockSweepTickRun(), wrapping around within its partition.
+ */
+static inline int
+ClockSweepRunNext(int buf_id)
+{
+	int			part = BufferPoolPartitionOf(buf_id);
+
+	if (++buf_id == BufferPoolPartitionEnd(part))
+		buf_id = BufferPoolPartitionStart(part);
+
+	return buf_id;
+}
+
+/*
+ * ClockSweepRunFits - Helper routine for the clock-based policies
+ *
+ * Does a run of n buffers starting at buf_id end before its partition does?
+ */
+static inline bool
+ClockSweepRunFits(int buf_id, int n)
+{
+	return buf_id + n <= BufferPoolPartitionEnd(BufferPoolPartitionOf(buf_id));
+}
+
+/*
+ * ClockSweepRunLength - Helper routine for the clock-based policies
+ *
+ * Clamp a run length to the size of the smallest partition.
+ */
+static inline int
+ClockSweepRunLength(int n)
+{
+	return Min(n, NumBufferPoolPartitions == 1 ? NBuffers : BufferPoolPartitionSize);
+}
+
+/*
+ * ClockSweepTick - Helper routine for StrategyGetBuffer()
+ *
+ * Move the clock hand one buffer ahead of its current position and return the
+ * id of the buffer now under the hand.
+ */
+static inline uint32
+ClockSweepTick(void)
+{
+	return ClockSweepTickRun(1);
+}
+
+/*
+ * VictimSearchSample - Helper routine for the sampling policies
+ *
+ * Return a buffer chosen uniformly at random from the partition being
+ * searched.
+ */
+static inline int
+VictimSearchSample(void)
+{
+	int			part = VictimSearchAdvance(1);
+
+	return (int) pg_prng_uint64_range(&pg_global_prng_state,
+									  BufferPoolPartitionStart(part),
+									  BufferPoolPartitionEnd(part) - 1);
+}
+
+/*
+ * StrategyStartVictimSearch - Helper routine for victim searches
+ *
+ * Make the policy's next search for a victim start in the given partition of
+ * the buffer pool, with a partition's worth of buffers to look at before it
+ * moves on.  Policies that aren't clock-based ignore this and search the
+ * whole pool.
+ */
+static inline void
+StrategyStartVictimSearch(int part)
+{
+	VictimSearchPartition = part;
+	VictimSearchBudget = BufferPoolPartitionEnd(part) -
+		BufferPoolPartitionStart(part);
+}
+
+/*
+ * StrategyChooseVictimPartition - Helper routine for StrategyGetBuffer()
+ *
+ * Buffers are preferably taken from the partition on our own NUMA node.  But
+ * if that partition has given up a partition's worth of buffers more than
+ * some other one, take from the one that has given up the fewest, so that
+ * backends crowding on one node don't keep evicting that node's pages while
+ * the other nodes' pages stay put.  The counters wrap around, so they're only
+ * ever compared by their difference.
+ */
+static int
+StrategyChooseVictimPartition(void)
+{
+	int			home = BufferPoolHomePartition();
+	uint32		homeVictims;
+	int			best = home;
+	int32		bestLag = BufferPoolPartitionSize;
+
+	if (NumBufferPoolPartitions == 1)
+		return 0;
+
+	homeVictims = pg_atomic_read_u32(&StrategyControl->partitions[home].sweep.numVictims);
+	for (int p = 0; p < NumBufferPoolPartitions; p++)
+	{
+		int32		lag;
+
+		lag = (int32) (homeVictims -
+					   pg_atomic_read_u32(&StrategyControl->partitions[p].sweep.numVictims));
+		if (lag > bestLag)
+		{
+			best = p;
+			bestLag = lag;
 		}
 	}
-	return victim;
+
+	return best;
+}
+
+/*
+ * StrategyCountVictim - Helper routine for StrategyGetBuffer()
+ *
+ * Charge a buffer taken for reuse to its partition.
+ */
+static inline void
+StrategyCountVictim(BufferDesc *buf)
+{
+	if (NumBufferPoolPartitions > 1)
+		pg_atomic_fetch_add_u32(&StrategyControl->partitions[BufferPoolPartitionOf(buf->buf_id)].sweep.numVictims,
+								1);
+}
+
+/*
+ * Report a batch of hits to a policy, one by one if it doesn't take batches.
+ */
+static void
+DeliverBufferHits(const BufferPolicyRoutine *policy,
+				  const int *buf_ids, int nbufs)
+{
+	if (policy->on_hit_batch != NULL)
+		policy->on_hit_batch(buf_ids, nbufs);
+	else if (policy->on_hit != NULL)
+	{
+		for (int i = 0; i < nbufs; i++)
+			policy->on_hit(GetBufferDescriptor(buf_ids[i]));
+	}
 }
 
 
@@ -195,93 +478,45 @@ have_free_buffer(void)
 }
 
 
-// Adjusts the position of buffer (identified by buf_id) in the LRU stack if delete is false;
-// otherwise, delete buffer buf_id from the LRU stack.
-
+/*
+ * StrategyFlushBufferHits -- report the batched hits to the policy
+ */
 void
-StrategyAccessBuffer(int buf_id, bool delete)
+StrategyFlushBufferHits(void)
 {
+	int			npending = NumPendingBufferHits;
+	int			nbufs = 0;
 
-	Algorithm->StrategyAccessBuffer++;
+	if (npending == 0)
+		return;
 
-	SpinLockAcquire(&StrategyControl->lru_lock);
+	/* Reset first, so that an error in the callback can't make us loop */
+	NumPendingBufferHits = 0;
 
-	if (buf_id < 0 || buf_id >= NBuffers)
+	/*
+	 * Drop the hits on buffers that have since been given another page, or
+	 * freed, which clears the tag.  We don't hold the pins anymore, so the
+	 * tag is read without the header lock; a buffer that is being reassigned
+	 * right now may still slip through, which policies have to put up with.
+	 */
+	for (int i = 0; i < npending; i++)
 	{
-		SpinLockRelease(&StrategyControl->lru_lock);
-		elog(ERROR, "Invalid buffer index");
-	}
-	
-	StrategyControl->stackTop = &lruStack[NBuffers];
-	StrategyControl->stackBottom = &lruStack[NBuffers+1];
-
-	BufferNode *curr = &lruStack[buf_id]; // focus on the node with node_id = buf_id
-	
-	// not in lru, insert to top
-	if (curr->prev == NULL && curr->next == NULL)
-	{	
-		curr->prev = StrategyControl->stackTop;
-		curr->next = StrategyControl->stackTop->next;
-		StrategyControl->stackTop->next = curr;
-		curr->next->prev = curr;
-	}
-	// in lru, not top
-	else if (StrategyControl->stackTop->next->node_id != buf_id)
-	{	
-
-		curr->next->prev = curr->prev;
-		curr->prev->next = curr->next;
+		BufferDesc *buf = GetBufferDescriptor(PendingBufferHits[i]);
 
-		curr->prev = StrategyControl->stackTop;
-		curr->next = StrategyControl->stackTop->next;
-		StrategyControl->stackTop->next = curr;
-		curr->next->prev = curr;
+		if (BufferTagsEqual(&buf->tag, &PendingBufferHitTags[i]))
+			PendingBufferHits[nbufs++] = PendingBufferHits[i];
 	}
-	
-	SpinLockRelease(&StrategyControl->lru_lock);
-
-}
-
-// hyperbolic sample 
-int hyperbolic_sample()
-{
-	BufferDesc *buf;
-	uint32		local_buf_state;
+	if (nbufs == 0)
+		return;
 
-	time_t cur_time = time(NULL);
-	int min = 0;
-	int max = NBuffers;
-	double min_hyperbolic = 10000;
-	int random_number;
-	int tmp;
-	double count;
-	int buf_id;
-	BufferNode *curr;
-	double timeDifference;
-	int min_hyperbolic_buf_id = 0;
-
-	for(int i=0;i<20;i++)
-	{
-		random_number = drand48() * (max - min + 1) + min;
-		buf_id= random_number%NBuffers;
-		curr = &lruStack[buf_id]; 
-		timeDifference = difftime(cur_time, curr->startTime);
-		buf = GetBufferDescriptor(buf_id);
-
-		count = BUF_STATE_GET_USAGECOUNT(pg_atomic_read_u32(&buf->state));
-
-		double frequency = count / timeDifference;
-		if(frequency<min_hyperbolic)
-		{
-			min_hyperbolic_buf_id = buf_id;
-			min_hyperbolic = frequency;
-		}
-	}
-	return min_hyperbolic_buf_id;
+	/*
+	 * The hits may have been collected while another policy was in use.
+	 * They are just buffer ids, so hand them to whichever one is in use now.
+	 */
+	StrategyCheckBufferPolicy();
+	DeliverBufferHits(BufferPolicy, PendingBufferHits, nbufs);
 }
 
-
-
 /*
  * StrategyGetBuffer
  *
@@ -299,12 +534,30 @@ StrategyGetBuffer(BufferAccessStrategy strategy, uint32 *buf_state, bool *from_r
 {
 	BufferDesc *buf;
 	int			bgwprocno;
-	int			trycounter;
+	int			part;
 	uint32		local_buf_state;	/* to avoid repeated (de-)referencing */
 
 	*from_ring = false;
 
-	strategy = NULL;
+	/*
+	 * If given a strategy object, see whether it can select a buffer. We
+	 * assume strategy objects don't need buffer_strategy_lock.  This works
+	 * the same under every policy; the policy is not told about the reuse.
+	 */
+	if (strategy != NULL)
+	{
+		buf = GetBufferFromRing(strategy, buf_state);
+		if (buf != NULL)
+		{
+			*from_ring = true;
+			return buf;
+		}
+	}
+
+	StrategyCheckBufferPolicy();
+
+	/* Let the policy see our own recent hits before it picks a victim */
+	StrategyFlushBufferHits();
 
 	bgwprocno = INT_ACCESS_ONCE(StrategyControl->bgwprocno);
 	if (bgwprocno != -1)
@@ -382,271 +635,144 @@ StrategyGetBuffer(BufferAccessStrategy strategy, uint32 *buf_state, bool *from_r
 			{
 				if (strategy != NULL)
 					AddBufferToRing(strategy, buf);
+				StrategyCountVictim(buf);
 				*buf_state = local_buf_state;
-// change,hyperbolic
-				if(Algorithm->algorithm_first == 'h')
-				{
-					BufferNode *curr = &lruStack[buf->buf_id];
-					curr->startTime = time(NULL);
-				}
-// change,lru
-				StrategyAccessBuffer(buf->buf_id, false);
-
-				Algorithm->GetFromFreelist++;
+				pgstat_count_buffer_policy_freelist_alloc(BufferPolicyStatsIndex);
 				return buf;
 			}
 			UnlockBufHdr(buf, local_buf_state);
 		}
 	}
 
-// change
+	/*
+	 * Nothing on the freelist, so try a victim pre-selected by the bgwriter
+	 * for the partition we're taking buffers from, if the policy allows that.
+	 * If the buffer has been pinned since it was queued, its usage count is
+	 * no longer zero, and it's discarded.
+	 */
+	part = StrategyChooseVictimPartition();
+	while (BufferPolicy->queue_victims)
+	{
+		int			buf_id = VictimQueuePop(GetVictimQueue(part));
 
+		if (buf_id < 0)
+			break;
 
-// change,EAclock,
-	if(Algorithm->algorithm_first == 'e')
-	{
-		Algorithm->GetFromEAclock++;
-		/* Nothing on the freelist, so run the "EAclock" algorithm */
-		EAclockControl->starCount = true;
-		trycounter = NBuffers;
-		for (;;)
+		buf = GetBufferDescriptor(buf_id);
+		local_buf_state = LockBufHdr(buf);
+		if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0
+			&& BUF_STATE_GET_USAGECOUNT(local_buf_state) == 0)
 		{
-			buf = GetBufferDescriptor(ClockSweepTick());
-
-			BufferNode *buf_lru_node = &lruStack[buf->buf_id];
-			
-			if (BUF_STATE_GET_REFCOUNT((pg_atomic_read_u32(&buf->state))) == 0)
-			{
-				if (pg_atomic_read_u32(&buf_lru_node->Value) >= 1)
-				{
-					if(EAclockControl->isChange == true)
-					{
-						int value = pg_atomic_read_u32(&buf_lru_node->Value);
-						pg_atomic_fetch_sub_u32(&buf_lru_node->Value,value/2);
-					}
-					else
-						pg_atomic_fetch_sub_u32(&buf_lru_node->Value,1);
-					trycounter = NBuffers;
-				}
-				else
-				{
-					local_buf_state = LockBufHdr(buf);
-					*buf_state = local_buf_state;
-					ValueInit(buf->buf_id);
-					if(pg_atomic_fetch_add_u32(&EAclockControl->evictNum,1)>=NBuffers/2)
-					{
-						UpdateWeight();
-						pg_atomic_init_u32(&EAclockControl->evictNum, 0);
-						EAclockControl->HitInBuf = 0;
-					}
-					return buf;
-				}
-			}
-			else if (--trycounter == 0)
-			{
-				elog(ERROR, "no unpinned buffers available");
-			}
+			if (strategy != NULL)
+				AddBufferToRing(strategy, buf);
+			StrategyCountVictim(buf);
+			*buf_state = local_buf_state;
+			pgstat_count_buffer_policy_eviction(BufferPolicyStatsIndex, true);
+			return buf;
 		}
+		UnlockBufHdr(buf, local_buf_state);
 	}
-// change,lru
-	else if(Algorithm->algorithm_first == 'l')
-	{
 
-		Algorithm->GetFromLRU++;
-again:
-		SpinLockAcquire(&StrategyControl->lru_lock);
-		// Get victim buffer from the tail of list, which means the bottom of the stack.
-		BufferNode *victim = StrategyControl->stackBottom->prev;
-		int buf_id = victim->node_id;
-	
-		while( buf_id>=0 && buf_id<NBuffers)
-		{
+	/* Nothing pre-selected either, so let the replacement policy pick one */
+	StrategyStartVictimSearch(part);
+	buf = BufferPolicy->get_victim(strategy, buf_state);
+	if (strategy != NULL)
+		AddBufferToRing(strategy, buf);
+	StrategyCountVictim(buf);
+	pgstat_count_buffer_policy_eviction(BufferPolicyStatsIndex, false);
 
-			buf = GetBufferDescriptor(buf_id);
+	return buf;
+}
 
-			// For lru implementation, usage_count is not important or ignored.
-			
-			local_buf_state = LockBufHdr(buf);
+/*
+ * StrategyFreeBuffer: put a buffer on the freelist
+ */
+void
+StrategyFreeBuffer(BufferDesc *buf)
+{
+	StrategyCheckBufferPolicy();
+	if (BufferPolicy->on_invalidate != NULL)
+		BufferPolicy->on_invalidate(buf);
 
-			if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0)
-			{
-				*buf_state = local_buf_state;
-				SpinLockRelease(&StrategyControl->lru_lock);
-				return buf;
-			}
-			else if (StrategyControl->stackTop->next->node_id == buf->buf_id) 
-			{
-				UnlockBufHdr(buf, local_buf_state);
-				SpinLockRelease(&StrategyControl->lru_lock);
-				goto again;
-			}
-			
-			UnlockBufHdr(buf, local_buf_state);
+	SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
+
+	/*
+	 * It is possible that we are told to put something in the freelist that
+	 * is already in it; don't screw up the list if so.
+	 */
+	if (buf->freeNext == FREENEXT_NOT_IN_LIST)
+	{
+		buf->freeNext = StrategyControl->firstFreeBuffer;
+		if (buf->freeNext < 0)
+			StrategyControl->lastFreeBuffer = buf->buf_id;
+		StrategyControl->firstFreeBuffer = buf->buf_id;
+	}
 
+	SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+}
 
-			victim = victim->prev;
-			buf_id = victim->node_id;
-        }
+/*
+ * StrategyFillVictimQueue -- pre-select victims for StrategyGetBuffer()
+ *
+ * Called by the bgwriter, after it has cleaned the buffers ahead of the clock
+ * sweep.  For each partition of the buffer pool, we run the replacement
+ * policy until the partition's queue holds its share of max_victims buffers,
+ * or is full, and queue the clean, unpinned victims it picks.  Their usage
+ * count is reset, so that a pin before the buffer is taken off the queue
+ * reveals that it's in use again.  A victim goes to the queue of the
+ * partition it belongs to, which is not necessarily the one being filled if
+ * the policy doesn't search partition by partition.
+ *
+ * Dirty victims are skipped rather than written; in all we look at no more
+ * than twice as many victims as we are asked to queue.  Since a victim may
+ * never be taken, this is only done for policies whose victim search leaves
+ * their state alone, which they declare with queue_victims.
+ */
+void
+StrategyFillVictimQueue(int max_victims)
+{
+	StrategyCheckBufferPolicy();
+	if (!BufferPolicy->queue_victims)
+		return;
 
-        SpinLockRelease(&StrategyControl->lru_lock);
+	max_victims = Min((max_victims + NumBufferPoolPartitions - 1) / NumBufferPoolPartitions,
+					  VictimQueueSize());
 
-	}
-// clock sweep
-	else if(Algorithm->algorithm_first == 's')
+	for (int part = 0; part < NumBufferPoolPartitions; part++)
 	{
-		
-		Algorithm->GetFromCLOCKSWEEP++;
-		/* Nothing on the freelist, so run the "clock sweep" algorithm */
-		trycounter = NBuffers;
-		for (;;)
+		VictimQueue *queue = GetVictimQueue(part);
+		int			queued;
+		int			tries;
+
+		queued = pg_atomic_read_u32(&queue->enqueuePos) -
+			pg_atomic_read_u32(&queue->dequeuePos);
+
+		StrategyStartVictimSearch(part);
+		for (tries = 2 * (max_victims - queued);
+			 tries > 0 && queued < max_victims;
+			 tries--)
 		{
-			buf = GetBufferDescriptor(ClockSweepTick());
+			BufferDesc *buf;
+			uint32		buf_state;
 
-			/*
-			* If the buffer is pinned or has a nonzero usage_count, we cannot use
-			* it; decrement the usage_count (unless pinned) and keep scanning.
-			*/
-			local_buf_state = LockBufHdr(buf);
+			buf = BufferPolicy->get_victim(NULL, &buf_state);
 
-			if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0)
-			{
-				if (BUF_STATE_GET_USAGECOUNT(local_buf_state) != 0)
-				{
-					local_buf_state -= BUF_USAGECOUNT_ONE;
-					trycounter = NBuffers;
-				}
-				else
-				{
-					/* Found a usable buffer */
-					if (strategy != NULL)
-						AddBufferToRing(strategy, buf);
-					*buf_state = local_buf_state;
-					return buf;
-				}
-			}
-			else if (--trycounter == 0)
+			if (buf_state & BM_DIRTY)
 			{
-				/*
-				* We've scanned all the buffers without making any state changes,
-				* so all the buffers are pinned (or were when we looked at them).
-				* We could hope that someone will free one eventually, but it's
-				* probably better to fail than to risk getting stuck in an
-				* infinite loop.
-				*/
-				UnlockBufHdr(buf, local_buf_state);
-				elog(ERROR, "no unpinned buffers available");
+				UnlockBufHdr(buf, buf_state);
+				continue;
 			}
-			UnlockBufHdr(buf, local_buf_state);
+
+			buf_state &= ~BUF_USAGECOUNT_MASK;
+			UnlockBufHdr(buf, buf_state);
+
+			if (!VictimQueuePush(GetVictimQueue(BufferPoolPartitionOf(buf->buf_id)),
+								 buf->buf_id))
+				break;
+			queued++;
 		}
 	}
-// change,clock
-	else if(Algorithm->algorithm_first == 'c')
-	{
-		Algorithm->GetFromCLOCK++;
-		trycounter = NBuffers;
-		for (;;)
-		{
-			buf = GetBufferDescriptor(ClockSweepTick());
-
-			local_buf_state = LockBufHdr(buf);
-
-			if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0)
-			{
-				if(buf->flag==false)
-				{
-					/* Found a usable buffer */
-					if (strategy != NULL)
-						AddBufferToRing(strategy, buf);
-					*buf_state = local_buf_state;
-					buf->flag = true;
-					return buf;
-				}
-				else
-				{
-					buf->flag=false;
-				}
-			}
-			else if (--trycounter == 0)
-			{
-				UnlockBufHdr(buf, local_buf_state);
-				elog(ERROR, "no unpinned buffers available");
-			}
-			UnlockBufHdr(buf, local_buf_state);	
-		}
-	}
-// change,random
-	else if(Algorithm->algorithm_first == 'r')
-	{
-		Algorithm->GetFromRandom++;
-
-		int min = 0;
-		int max = NBuffers;
-		for (;;)
-		{
-			int random_number = drand48() * (max - min + 1) + min;
-			random_number= random_number%NBuffers;
-			buf = GetBufferDescriptor(random_number);
-
-			local_buf_state = LockBufHdr(buf);
-
-			if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0)
-			{
-				/* Found a usable buffer */
-				if (strategy != NULL)
-					AddBufferToRing(strategy, buf);
-				*buf_state = local_buf_state;
-				return buf;
-			}
-			UnlockBufHdr(buf, local_buf_state);	
-		}		
-	}
-// change,Hyperbolic
-	else if(Algorithm->algorithm_first == 'h')
-	{
-		Algorithm->GetFromHyperbolic++;
-
-		for (;;)
-		{
-			buf = GetBufferDescriptor(hyperbolic_sample());
-
-			local_buf_state = LockBufHdr(buf);
-
-			if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0)
-			{
-				*buf_state = local_buf_state;
-				BufferNode *curr = &lruStack[buf->buf_id];
-				curr->startTime = time(NULL);
-
-				return buf;
-			}
-			UnlockBufHdr(buf, local_buf_state);
-		}	
-	}
-
-}
-
-/*
- * StrategyFreeBuffer: put a buffer on the freelist
- */
-void
-StrategyFreeBuffer(BufferDesc *buf)
-{
-	SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
-
-	/*
-	 * It is possible that we are told to put something in the freelist that
-	 * is already in it; don't screw up the list if so.
-	 */
-	if (buf->freeNext == FREENEXT_NOT_IN_LIST)
-	{
-		buf->freeNext = StrategyControl->firstFreeBuffer;
-		if (buf->freeNext < 0)
-			StrategyControl->lastFreeBuffer = buf->buf_id;
-		StrategyControl->firstFreeBuffer = buf->buf_id;
-	}
-
-	SpinLockRelease(&StrategyControl->buffer_strategy_lock);
-}
+}
 
 /*
  * StrategySyncStart -- tell BufferSync where to start syncing
@@ -658,27 +784,35 @@ StrategyFreeBuffer(BufferDesc *buf)
  * the higher-order bits of nextVictimBuffer) and the count of recent buffer
  * allocs if non-NULL pointers are passed.  The alloc count is reset after
  * being read.
+ *
+ * When the buffer pool is partitioned, each partition has a clock hand of
+ * its own.  What we report then is a virtual hand that has moved as far as
+ * all of them together, which is what the bgwriter needs to estimate how
+ * fast buffers are being recycled.
  */
 int
 StrategySyncStart(uint32 *complete_passes, uint32 *num_buf_alloc)
 {
-	uint32		nextVictimBuffer;
+	uint64		ticks = 0;
 	int			result;
 
 	SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
-	nextVictimBuffer = pg_atomic_read_u32(&StrategyControl->nextVictimBuffer);
-	result = nextVictimBuffer % NBuffers;
-
-	if (complete_passes)
+	for (int part = 0; part < NumBufferPoolPartitions; part++)
 	{
-		*complete_passes = StrategyControl->completePasses;
+		BufferPartitionSweep *sweep = &StrategyControl->partitions[part].sweep;
+		uint32		size = BufferPoolPartitionEnd(part) - BufferPoolPartitionStart(part);
 
 		/*
-		 * Additionally add the number of wraparounds that happened before
-		 * completePasses could be incremented. C.f. ClockSweepTick().
+		 * nextVictimBuffer may include wraparounds that happened before
+		 * completePasses could be incremented. C.f. ClockSweepTickRun().
 		 */
-		*complete_passes += nextVictimBuffer / NBuffers;
+		ticks += (uint64) sweep->completePasses * size +
+			pg_atomic_read_u32(&sweep->nextVictimBuffer);
 	}
+	result = ticks % NBuffers;
+
+	if (complete_passes)
+		*complete_passes = (uint32) (ticks / NBuffers);
 
 	if (num_buf_alloc)
 	{
@@ -729,6 +863,28 @@ StrategyShmemSize(void)
 	/* size of the shared replacement strategy control block */
 	size = add_size(size, MAXALIGN(sizeof(BufferStrategyControl)));
 
+	/* size of the victim queues, plus alignment padding */
+	size = add_size(size, PG_CACHE_LINE_SIZE);
+	size = add_size(size, mul_size(NumBufferPoolPartitions, VictimQueueStride()));
+
+	/*
+	 * Size of the replacement policies' own shared state.  Any policy can be
+	 * switched to without a restart, so there must be room for all of them.
+	 * Policies may share their state, in which case it's counted once.
+	 */
+	for (int i = 0; i < NumBufferPolicies(); i++)
+	{
+		const BufferPolicyRoutine *policy = GetBufferPolicy(i);
+		bool		shared = false;
+
+		if (policy->shmem_size == NULL)
+			continue;
+		for (int j = 0; j < i && !shared; j++)
+			shared = (GetBufferPolicy(j)->shmem_size == policy->shmem_size);
+		if (!shared)
+			size = add_size(size, policy->shmem_size());
+	}
+
 	return size;
 }
 
@@ -780,20 +936,3337 @@ StrategyInitialize(bool init)
 		StrategyControl->firstFreeBuffer = 0;
 		StrategyControl->lastFreeBuffer = NBuffers - 1;
 
-		/* Initialize the clock sweep pointer */
-		pg_atomic_init_u32(&StrategyControl->nextVictimBuffer, 0);
+		/* Initialize the clock sweep pointers */
+		for (int i = 0; i < MAX_BUFFER_POOL_PARTITIONS; i++)
+		{
+			BufferPartitionSweep *sweep = &StrategyControl->partitions[i].sweep;
+
+			pg_atomic_init_u32(&sweep->nextVictimBuffer, 0);
+			sweep->completePasses = 0;
+			pg_atomic_init_u32(&sweep->numVictims, 0);
+		}
 
 		/* Clear statistics */
-		StrategyControl->completePasses = 0;
 		pg_atomic_init_u32(&StrategyControl->numBufferAllocs, 0);
 
 		/* No pending notification */
 		StrategyControl->bgwprocno = -1;
+
+		/* Start with the configured replacement policy */
+		StrategyControl->activePolicy =
+			LookupBufferPolicy(buffer_replacement_policy);
+		if (StrategyControl->activePolicy < 0)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("buffer replacement policy \"%s\" does not exist",
+							buffer_replacement_policy)));
+		StrategyControl->nextPolicy = -1;
+		pg_atomic_init_u32(&StrategyControl->policyGeneration, 1);
 	}
 	else
 		Assert(!init);
+
+	/* Align the victim queues to a cacheline boundary. */
+	StrategyVictims = (char *)
+		CACHELINEALIGN(ShmemInitStruct("Buffer Victim Queues",
+									   PG_CACHE_LINE_SIZE +
+									   NumBufferPoolPartitions * VictimQueueStride(),
+									   &found));
+
+	if (!found)
+	{
+		for (int p = 0; p < NumBufferPoolPartitions; p++)
+		{
+			VictimQueue *queue = GetVictimQueue(p);
+
+			pg_atomic_init_u32(&queue->enqueuePos, 0);
+			pg_atomic_init_u32(&queue->dequeuePos, 0);
+			for (int i = 0; i < VictimQueueSize(); i++)
+			{
+				pg_atomic_init_u32(&queue->slots[i].sequence, i);
+				queue->slots[i].buf_id = -1;
+			}
+		}
+	}
+
+	/*
+	 * Set up the replacement policies' shared state.  This has to be done in
+	 * every process under EXEC_BACKEND, so do it outside the block above.
+	 */
+	for (int i = 0; i < NumBufferPolicies(); i++)
+	{
+		const BufferPolicyRoutine *policy = GetBufferPolicy(i);
+		bool		shared = false;
+
+		if (policy->shmem_init == NULL)
+			continue;
+		for (int j = 0; j < i && !shared; j++)
+			shared = (GetBufferPolicy(j)->shmem_init == policy->shmem_init);
+		if (!shared)
+			policy->shmem_init(init);
+	}
+
+	SharedBufferPolicyGeneration = &StrategyControl->policyGeneration;
+	RefreshBufferPolicy();
+}
+
+
+/*
+ * Number of slots in each victim queue: a power of 2, so that positions can
+ * wrap around freely, and small enough that queued victims don't take a
+ * noticeable share of the pool out of circulation.
+ */
+static int
+VictimQueueSize(void)
+{
+	return Min(pg_prevpower2_32(Max(NBuffers / 16 / NumBufferPoolPartitions, 1)),
+			   1024);
+}
+
+/* Distance between the victim queues of consecutive partitions */
+static Size
+VictimQueueStride(void)
+{
+	return CACHELINEALIGN(offsetof(VictimQueue, slots) +
+						  VictimQueueSize() * sizeof(VictimQueueSlot));
+}
+
+static VictimQueue *
+GetVictimQueue(int part)
+{
+	return (VictimQueue *) (StrategyVictims + part * VictimQueueStride());
+}
+
+/*
+ * Append a buffer to the victim queue.  Returns false if it's full.
+ */
+static bool
+VictimQueuePush(VictimQueue *queue, int buf_id)
+{
+	uint32		mask = VictimQueueSize() - 1;
+	uint32		pos = pg_atomic_read_u32(&queue->enqueuePos);
+	VictimQueueSlot *slot;
+
+	for (;;)
+	{
+		int32		diff;
+
+		slot = &queue->slots[pos & mask];
+		diff = (int32) (pg_atomic_read_u32(&slot->sequence) - pos);
+
+		if (diff == 0)
+		{
+			/* slot is free; claim the position */
+			if (pg_atomic_compare_exchange_u32(&queue->enqueuePos,
+											   &pos, pos + 1))
+				break;
+		}
+		else if (diff < 0)
+			return false;		/* slot not yet emptied, queue is full */
+		else
+			pos = pg_atomic_read_u32(&queue->enqueuePos);
+	}
+
+	slot->buf_id = buf_id;
+	pg_write_barrier();
+	pg_atomic_write_u32(&slot->sequence, pos + 1);
+
+	return true;
+}
+
+/*
+ * Take the oldest buffer off the victim queue.  Returns -1 if it's empty.
+ */
+static int
+VictimQueuePop(VictimQueue *queue)
+{
+	uint32		mask = VictimQueueSize() - 1;
+	uint32		pos = pg_atomic_read_u32(&queue->dequeuePos);
+	VictimQueueSlot *slot;
+	int			buf_id;
+
+	for (;;)
+	{
+		int32		diff;
+
+		slot = &queue->slots[pos & mask];
+		diff = (int32) (pg_atomic_read_u32(&slot->sequence) - (pos + 1));
+
+		if (diff == 0)
+		{
+			/* slot is filled; claim the position */
+			if (pg_atomic_compare_exchange_u32(&queue->dequeuePos,
+											   &pos, pos + 1))
+				break;
+		}
+		else if (diff < 0)
+			return -1;			/* slot not yet filled, queue is empty */
+		else
+			pos = pg_atomic_read_u32(&queue->dequeuePos);
+	}
+
+	/* the compare-and-exchange was a full barrier */
+	buf_id = slot->buf_id;
+
+	/* let the next producer at the slot only after we've read it */
+	pg_memory_barrier();
+	pg_atomic_write_u32(&slot->sequence, pos + mask + 1);
+
+	return buf_id;
+}
+
+
+/* ----------------------------------------------------------------
+ *				Buffer replacement policies
+ * ----------------------------------------------------------------
+ */
+
+/*
+ * "clocksweep": the stock PostgreSQL algorithm.  Usage counts are maintained
+ * by PinBuffer(), so no access callbacks are needed.
+ */
+static BufferDesc *
+ClockSweepGetVictim(BufferAccessStrategy strategy, uint32 *buf_state)
+{
+	BufferDesc *buf;
+	int			trycounter;
+	uint32		local_buf_state;
+	int			scanned = 0;
+	int			pinned = 0;
+
+	/* Nothing on the freelist, so run the "clock sweep" algorithm */
+	trycounter = NBuffers;
+	for (;;)
+	{
+		buf = GetBufferDescriptor(ClockSweepTick());
+		scanned++;
+
+		/*
+		 * If the buffer is pinned or has a nonzero usage_count, we cannot use
+		 * it; decrement the usage_count (unless pinned) and keep scanning.
+		 *
+		 * Most buffers the hand passes are not victims, so first look at the
+		 * state without the header lock, and decrement the usage_count by
+		 * compare-and-exchange.  Only a buffer that looks usable, or whose
+		 * header is locked at the moment, is examined under the lock.
+		 */
+		local_buf_state = pg_atomic_read_u32(&buf->state);
+
+		while (!(local_buf_state & BM_LOCKED) &&
+			   BUF_STATE_GET_REFCOUNT(local_buf_state) == 0 &&
+			   BUF_STATE_GET_USAGECOUNT(local_buf_state) != 0)
+		{
+			if (pg_atomic_compare_exchange_u32(&buf->state, &local_buf_state,
+											   local_buf_state - BUF_USAGECOUNT_ONE))
+			{
+				trycounter = NBuffers;
+				break;
+			}
+		}
+
+		if (!(local_buf_state & BM_LOCKED))
+		{
+			if (BUF_STATE_GET_REFCOUNT(local_buf_state) != 0)
+			{
+				pinned++;
+				if (--trycounter == 0)
+				{
+					/*
+					 * We've scanned all the buffers without making any state
+					 * changes, so all the buffers are pinned (or were when we
+					 * looked at them).  We could hope that someone will free
+					 * one eventually, but it's probably better to fail than
+					 * to risk getting stuck in an infinite loop.
+					 */
+					elog(ERROR, "no unpinned buffers available");
+				}
+				continue;
+			}
+			if (BUF_STATE_GET_USAGECOUNT(local_buf_state) != 0)
+				continue;		/* decremented above */
+		}
+
+		local_buf_state = LockBufHdr(buf);
+
+		if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0)
+		{
+			if (BUF_STATE_GET_USAGECOUNT(local_buf_state) != 0)
+			{
+				local_buf_state -= BUF_USAGECOUNT_ONE;
+				trycounter = NBuffers;
+			}
+			else
+			{
+				/* Found a usable buffer */
+				*buf_state = local_buf_state;
+				pgstat_count_buffer_policy_search(BufferPolicyStatsIndex,
+												  scanned, pinned);
+				return buf;
+			}
+		}
+		else
+		{
+			pinned++;
+			if (--trycounter == 0)
+			{
+				UnlockBufHdr(buf, local_buf_state);
+				elog(ERROR, "no unpinned buffers available");
+			}
+		}
+		UnlockBufHdr(buf, local_buf_state);
+	}
+}
+
+static void
+ClockSweepDescribe(BufferPolicyBufferInfo *info)
+{
+	for (int buf_id = 0; buf_id < NBuffers; buf_id++)
+	{
+		uint32		buf_state;
+
+		buf_state = pg_atomic_read_u32(&GetBufferDescriptor(buf_id)->state);
+		info[buf_id].value = BUF_STATE_GET_USAGECOUNT(buf_state);
+	}
+}
+
+static const BufferPolicyRoutine ClockSweepPolicy = {
+	.name = "clocksweep",
+	.get_victim = ClockSweepGetVictim,
+	.describe = ClockSweepDescribe,
+};
+
+/*
+ * "clock": second-chance replacement with a single reference bit per buffer.
+ * The bits are packed into ClockRefBits, so that the sweep reads the bits of
+ * 32 consecutive buffers from one word rather than touching each buffer
+ * header.
+ *
+ * The hand advances a word's worth of buffers at a time.  If all of them are
+ * referenced, none can be a victim, and all their bits are cleared at once;
+ * otherwise the backend examines them one by one, taking the header lock only
+ * for a buffer that looks usable.  Buffers of a run it doesn't get to are
+ * left for its next allocation.
+ */
+#define CLOCK_BITS_PER_WORD		32
+#define CLOCK_NUM_WORDS		((NBuffers + CLOCK_BITS_PER_WORD - 1) / CLOCK_BITS_PER_WORD)
+
+static pg_atomic_uint32 *ClockRefBits = NULL;
+
+/* the rest of this backend's current run of the clock hand */
+static uint32 ClockRunNext = 0;
+static int	ClockRunLeft = 0;
+
+static inline pg_atomic_uint32 *
+ClockRefWord(int buf_id)
+{
+	return &ClockRefBits[buf_id / CLOCK_BITS_PER_WORD];
+}
+
+static inline uint32
+ClockRefBit(int buf_id)
+{
+	return (uint32) 1 << (buf_id % CLOCK_BITS_PER_WORD);
+}
+
+static Size
+ClockShmemSize(void)
+{
+	return mul_size(CLOCK_NUM_WORDS, sizeof(pg_atomic_uint32));
+}
+
+static void
+ClockShmemInit(bool init)
+{
+	bool		found;
+
+	ClockRefBits = (pg_atomic_uint32 *)
+		ShmemInitStruct("Clock Reference Bits", ClockShmemSize(), &found);
+	if (!found)
+	{
+		Assert(init);
+		for (int i = 0; i < CLOCK_NUM_WORDS; i++)
+			pg_atomic_init_u32(&ClockRefBits[i], 0);
+	}
+}
+
+/* Set a buffer's reference bit, avoiding the write if it's already set */
+static inline void
+ClockSetRefBit(int buf_id)
+{
+	pg_atomic_uint32 *word = ClockRefWord(buf_id);
+	uint32		bit = ClockRefBit(buf_id);
+
+	if ((pg_atomic_read_u32(word) & bit) == 0)
+		pg_atomic_fetch_or_u32(word, bit);
+}
+
+/*
+ * Move the clock hand ahead by a run of buffers and return the next buffer to
+ * examine, or -1 if the whole run was passed over in one go.
+ */
+static inline int
+ClockNextBuffer(void)
+{
+	int			buf_id;
+
+	if (ClockRunLeft == 0)
+	{
+		int			runlen = ClockSweepRunLength(CLOCK_BITS_PER_WORD);
+		uint32		start = ClockSweepTickRun(runlen);
+
+		if (start % CLOCK_BITS_PER_WORD == 0 &&
+			ClockSweepRunFits(start, CLOCK_BITS_PER_WORD))
+		{
+			pg_atomic_uint32 *word = ClockRefWord(start);
+			uint32		bits = pg_atomic_read_u32(word);
+
+			/* All referenced: give them all a second chance */
+			if (bits == PG_UINT32_MAX)
+			{
+				pg_atomic_fetch_and_u32(word, ~bits);
+				return -1;
+			}
+		}
+
+		ClockRunNext = start;
+		ClockRunLeft = runlen;
+	}
+
+	buf_id = ClockRunNext;
+	ClockRunNext = ClockSweepRunNext(ClockRunNext);
+	ClockRunLeft--;
+
+	return buf_id;
 }
 
+static BufferDesc *
+ClockGetVictim(BufferAccessStrategy strategy, uint32 *buf_state)
+{
+	BufferDesc *buf;
+	int			trycounter;
+	uint32		local_buf_state;
+	int			scanned = 0;
+	int			pinned = 0;
+
+	trycounter = NBuffers;
+	for (;;)
+	{
+		pg_atomic_uint32 *word;
+		uint32		bit;
+		int			buf_id = ClockNextBuffer();
+
+		if (buf_id < 0)
+		{
+			scanned += CLOCK_BITS_PER_WORD;
+			trycounter = NBuffers;
+			continue;
+		}
+
+		buf = GetBufferDescriptor(buf_id);
+		word = ClockRefWord(buf_id);
+		bit = ClockRefBit(buf_id);
+		scanned++;
+
+		if (BUF_STATE_GET_REFCOUNT(pg_atomic_read_u32(&buf->state)) != 0)
+		{
+			pinned++;
+			if (--trycounter == 0)
+				elog(ERROR, "no unpinned buffers available");
+			continue;
+		}
+
+		if ((pg_atomic_read_u32(word) & bit) != 0)
+		{
+			/* Referenced since the hand last passed; give a second chance */
+			pg_atomic_fetch_and_u32(word, ~bit);
+			trycounter = NBuffers;
+			continue;
+		}
+
+		/* Recheck the pin count now that we hold the header lock */
+		local_buf_state = LockBufHdr(buf);
+		if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0)
+		{
+			/* Found a usable buffer */
+			*buf_state = local_buf_state;
+			pg_atomic_fetch_or_u32(word, bit);
+			pgstat_count_buffer_policy_search(BufferPolicyStatsIndex,
+											  scanned, pinned);
+			return buf;
+		}
+		UnlockBufHdr(buf, local_buf_state);
+	}
+}
+
+/*
+ * Set the reference bits of the buffers whose page has a nonzero usage count,
+ * and clear all others.  A hit reported meanwhile may be lost, which merely
+ * costs that buffer its second chance.
+ */
+static void
+ClockSeed(void)
+{
+	for (int i = 0; i < CLOCK_NUM_WORDS; i++)
+	{
+		uint32		bits = 0;
+
+		for (int buf_id = i * CLOCK_BITS_PER_WORD;
+			 buf_id < Min((i + 1) * CLOCK_BITS_PER_WORD, NBuffers);
+			 buf_id++)
+		{
+			uint32		buf_state;
+
+			buf_state = pg_atomic_read_u32(&GetBufferDescriptor(buf_id)->state);
+			if ((buf_state & BM_TAG_VALID) &&
+				BUF_STATE_GET_USAGECOUNT(buf_state) != 0)
+				bits |= ClockRefBit(buf_id);
+		}
+		pg_atomic_write_u32(&ClockRefBits[i], bits);
+	}
+}
+
+static void
+ClockAccessBuffer(BufferDesc *buf)
+{
+	ClockSetRefBit(buf->buf_id);
+}
+
+static void
+ClockAccessBufferBatch(const int *buf_ids, int nbufs)
+{
+	for (int i = 0; i < nbufs; i++)
+		ClockSetRefBit(buf_ids[i]);
+}
+
+static void
+ClockDescribe(BufferPolicyBufferInfo *info)
+{
+	for (int buf_id = 0; buf_id < NBuffers; buf_id++)
+		info[buf_id].value =
+			(pg_atomic_read_u32(ClockRefWord(buf_id)) & ClockRefBit(buf_id)) != 0;
+}
+
+static void
+ClockRestore(BufferDesc *buf, int usage, const BufferPolicyBufferInfo *info)
+{
+	if (info->value >= 0 ? info->value != 0 : usage != 0)
+		ClockSetRefBit(buf->buf_id);
+	else
+		pg_atomic_fetch_and_u32(ClockRefWord(buf->buf_id),
+								~ClockRefBit(buf->buf_id));
+}
+
+static const BufferPolicyRoutine ClockPolicy = {
+	.name = "clock",
+	.shmem_size = ClockShmemSize,
+	.shmem_init = ClockShmemInit,
+	.get_victim = ClockGetVictim,
+	.on_hit_batch = ClockAccessBufferBatch,
+	.on_miss = ClockAccessBuffer,
+	.seed = ClockSeed,
+	.describe = ClockDescribe,
+	.restore = ClockRestore,
+};
+
+/*
+ * "lru": least-recently-used replacement.
+ *
+ * A single LRU list would need one lock taken on every buffer hit, which
+ * serializes all backends.  Instead the buffers are spread over
+ * LRUNumPartitions lists by buffer id, each with its own spinlock, and each
+ * eviction takes the least recently used unpinned buffer of the next
+ * partition in round-robin order.  That approximates global LRU order
+ * closely while letting hits on different partitions proceed in parallel.
+ *
+ * The lists are threaded through LRUNodes, which has one entry per buffer,
+ * most recently used first.  A buffer that is on no list (because it is
+ * free) has NULL links.
+ */
+#define LRU_MAX_PARTITIONS	NUM_BUFFER_PARTITIONS
+#define LRU_MIN_PARTITION_SIZE	64
+
+/* the most buffers a victim search looks at per acquisition of the lock */
+#define LRU_SCAN_BATCH		16
+
+typedef struct LRUNode
+{
+	struct LRUNode *prev;
+	struct LRUNode *next;
+} LRUNode;
+
+typedef struct
+{
+	slock_t		lock;			/* protects the list, including links */
+	LRUNode		head;			/* sentinels; head.next is the MRU buffer */
+	LRUNode		tail;
+} LRUPartition;
+
+typedef union LRUPartitionPadded
+{
+	LRUPartition partition;
+	char		pad[PG_CACHE_LINE_SIZE];
+} LRUPartitionPadded;
+
+typedef struct
+{
+	/* next partition to take a victim from; wraps modulo the count */
+	pg_atomic_uint32 nextVictimPartition;
+
+	LRUPartitionPadded partitions[FLEXIBLE_ARRAY_MEMBER];
+} LRUStrategyControl;
+
+static LRUStrategyControl *LRUControl = NULL;
+static LRUNode *LRUNodes = NULL;
+static int	LRUNumPartitions = 0;
+
+/*
+ * Use as many partitions as possible while keeping each of them long enough
+ * for its order to be meaningful.  The result must be the same in every
+ * process.
+ */
+static int
+LRUComputeNumPartitions(void)
+{
+	int			nparts = LRU_MAX_PARTITIONS;
+
+	while (nparts > 1 && NBuffers / nparts < LRU_MIN_PARTITION_SIZE)
+		nparts /= 2;
+	return nparts;
+}
+
+static inline LRUPartition *
+LRUPartitionForBuffer(int buf_id)
+{
+	return &LRUControl->partitions[buf_id % LRUNumPartitions].partition;
+}
+
+static Size
+LRUShmemSize(void)
+{
+	Size		size;
+
+	size = offsetof(LRUStrategyControl, partitions);
+	size = add_size(size, mul_size(LRUComputeNumPartitions(),
+								   sizeof(LRUPartitionPadded)));
+	/* to allow aligning the partitions */
+	size = add_size(size, PG_CACHE_LINE_SIZE);
+	size = add_size(size, mul_size(NBuffers, sizeof(LRUNode)));
+
+	return size;
+}
+
+static void
+LRUShmemInit(bool init)
+{
+	bool		found;
+
+	LRUNumPartitions = LRUComputeNumPartitions();
+	LRUControl = (LRUStrategyControl *)
+		ShmemInitStruct("LRU Strategy Status",
+						offsetof(LRUStrategyControl, partitions) +
+						LRUNumPartitions * sizeof(LRUPartitionPadded),
+						&found);
+	LRUNodes = (LRUNode *)
+		ShmemInitStruct("LRU Buffer Nodes",
+						mul_size(NBuffers, sizeof(LRUNode)),
+						&found);
+	if (!found)
+	{
+		Assert(init);
+
+		pg_atomic_init_u32(&LRUControl->nextVictimPartition, 0);
+
+		for (int i = 0; i < LRUNumPartitions; i++)
+		{
+			LRUPartition *part = &LRUControl->partitions[i].partition;
+
+			SpinLockInit(&part->lock);
+			part->head.prev = NULL;
+			part->head.next = &part->tail;
+			part->tail.prev = &part->head;
+			part->tail.next = NULL;
+		}
+
+		for (int i = 0; i < NBuffers; i++)
+		{
+			LRUNodes[i].prev = NULL;
+			LRUNodes[i].next = NULL;
+		}
+	}
+}
+
+/*
+ * Move a node to the head of the partition's list, linking it in if it is
+ * not on the list yet.  Caller must hold the partition lock.
+ */
+static inline void
+LRUMoveToHead(LRUPartition *part, LRUNode *node)
+{
+	if (part->head.next == node)
+		return;
+
+	if (node->prev != NULL)
+	{
+		node->prev->next = node->next;
+		node->next->prev = node->prev;
+	}
+
+	node->prev = &part->head;
+	node->next = part->head.next;
+	part->head.next->prev = node;
+	part->head.next = node;
+}
+
+/*
+ * Move the buffer to the head of its partition's list, linking it in if it
+ * is not on the list yet.
+ */
+static void
+LRUAccessBuffer(BufferDesc *buf)
+{
+	LRUNode    *node = &LRUNodes[buf->buf_id];
+	LRUPartition *part = LRUPartitionForBuffer(buf->buf_id);
+
+	/*
+	 * Repeated accesses to a hot buffer are common.  If it's already at the
+	 * head there's nothing to do, and checking that without the lock is fine:
+	 * a stale answer just means the buffer's position is off by a little.
+	 */
+	if (part->head.next == node)
+		return;
+
+	SpinLockAcquire(&part->lock);
+	LRUMoveToHead(part, node);
+	SpinLockRelease(&part->lock);
+}
+
+/*
+ * Apply a batch of hits, taking each partition's lock once for all the hits
+ * that fall into it (the BP-Wrapper approach).  Applying them in order
+ * leaves the most recent hit at the head.  Buffers that have meanwhile been
+ * put on the freelist are left alone.
+ */
+static void
+LRUAccessBufferBatch(const int *buf_ids, int nbufs)
+{
+	bool		done[BUFFER_HIT_BATCH_SIZE] = {0};
+
+	Assert(nbufs <= BUFFER_HIT_BATCH_SIZE);
+
+	for (int i = 0; i < nbufs; i++)
+	{
+		LRUPartition *part;
+
+		if (done[i])
+			continue;
+
+		part = LRUPartitionForBuffer(buf_ids[i]);
+
+		SpinLockAcquire(&part->lock);
+		for (int j = i; j < nbufs; j++)
+		{
+			LRUNode    *node = &LRUNodes[buf_ids[j]];
+
+			if (done[j] || LRUPartitionForBuffer(buf_ids[j]) != part)
+				continue;
+
+			done[j] = true;
+			if (node->prev != NULL)
+				LRUMoveToHead(part, node);
+		}
+		SpinLockRelease(&part->lock);
+	}
+}
+
+/*
+ * Unlink a buffer that is being put on the freelist.
+ */
+static void
+LRUInvalidateBuffer(BufferDesc *buf)
+{
+	LRUNode    *node = &LRUNodes[buf->buf_id];
+	LRUPartition *part = LRUPartitionForBuffer(buf->buf_id);
+
+	SpinLockAcquire(&part->lock);
+
+	if (node->prev != NULL)
+	{
+		node->prev->next = node->next;
+		node->next->prev = node->prev;
+		node->prev = NULL;
+		node->next = NULL;
+	}
+
+	SpinLockRelease(&part->lock);
+}
+
+/*
+ * Take the least recently used buffer of a partition that isn't pinned, or
+ * return NULL if there is none.  The numbers of buffers looked at and found
+ * pinned are added to *scanned and *pinned.
+ *
+ * The list is walked from the tail going by the pin counts alone, no more
+ * than LRU_SCAN_BATCH buffers per acquisition of the partition lock, and the
+ * header of the buffer chosen is locked only once that lock is released.  A
+ * pinned buffer is in use, so it counts as just used and moves to the head;
+ * that also keeps the next round from looking at it again.  The victim moves
+ * to the head right away, where its new page will belong, so that the next
+ * caller doesn't pick it again before that page is loaded; this matters for
+ * the bgwriter, which queues up several victims in a row.  If it has been
+ * pinned by the time we lock its header, we go on to the next one.
+ */
+static BufferDesc *
+LRUGetVictimFromPartition(LRUPartition *part, uint32 *buf_state,
+						  int *scanned, int *pinned)
+{
+	int			trycounter = (NBuffers + LRUNumPartitions - 1) / LRUNumPartitions;
+
+	while (trycounter > 0)
+	{
+		BufferDesc *buf = NULL;
+		uint32		local_buf_state;
+		int			nscanned = 0;
+
+		SpinLockAcquire(&part->lock);
+		while (nscanned < LRU_SCAN_BATCH && part->tail.prev != &part->head)
+		{
+			LRUNode    *node = part->tail.prev;
+			BufferDesc *candidate = GetBufferDescriptor(node - LRUNodes);
+
+			nscanned++;
+			LRUMoveToHead(part, node);
+
+			/* For LRU, the usage count is ignored */
+			if (BUF_STATE_GET_REFCOUNT(pg_atomic_read_u32(&candidate->state)) == 0)
+			{
+				buf = candidate;
+				break;
+			}
+			(*pinned)++;
+		}
+		SpinLockRelease(&part->lock);
+
+		/* Nothing on the list at all? */
+		if (nscanned == 0)
+			break;
+
+		*scanned += nscanned;
+		trycounter -= nscanned;
+		if (buf == NULL)
+			continue;
+
+		local_buf_state = LockBufHdr(buf);
+		if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0)
+		{
+			*buf_state = local_buf_state;
+			return buf;
+		}
+		UnlockBufHdr(buf, local_buf_state);
+		(*pinned)++;
+	}
+
+	return NULL;
+}
+
+/*
+ * Rebuild the lists from the buffer headers: the buffers holding a page are
+ * linked in, most frequently used first going by their usage counts, and
+ * all others are unlinked.
+ *
+ * Pages loaded meanwhile link themselves in through on_miss, so a partition
+ * is scanned while holding its lock: a buffer whose on_miss came first
+ * already has a valid tag, and one whose on_miss comes later links itself in
+ * after we're done.
+ */
+static void
+LRUSeed(void)
+{
+	int			nslots = (NBuffers + LRUNumPartitions - 1) / LRUNumPartitions;
+	uint8	   *usages = palloc(nslots * sizeof(uint8));
+	int		   *order = palloc(nslots * sizeof(int));
+
+	for (int p = 0; p < LRUNumPartitions; p++)
+	{
+		LRUPartition *part = &LRUControl->partitions[p].partition;
+		int			start[BM_MAX_USAGE_COUNT + 2] = {0};
+		int			nbufs = 0;
+		int			slot;
+		int			buf_id;
+
+		SpinLockAcquire(&part->lock);
+
+		/* Collect the usage counts, and unlink every node */
+		for (buf_id = p, slot = 0; buf_id < NBuffers;
+			 buf_id += LRUNumPartitions, slot++)
+		{
+			uint32		buf_state;
+
+			buf_state = pg_atomic_read_u32(&GetBufferDescriptor(buf_id)->state);
+			if (buf_state & BM_TAG_VALID)
+			{
+				usages[slot] = BUF_STATE_GET_USAGECOUNT(buf_state);
+				start[BM_MAX_USAGE_COUNT - usages[slot] + 1]++;
+				nbufs++;
+			}
+			else
+				usages[slot] = PG_UINT8_MAX;
+			LRUNodes[buf_id].prev = NULL;
+			LRUNodes[buf_id].next = NULL;
+		}
+
+		/* Counting sort, highest usage count first */
+		for (int b = 1; b <= BM_MAX_USAGE_COUNT; b++)
+			start[b] += start[b - 1];
+		for (buf_id = p, slot = 0; buf_id < NBuffers;
+			 buf_id += LRUNumPartitions, slot++)
+		{
+			if (usages[slot] != PG_UINT8_MAX)
+				order[start[BM_MAX_USAGE_COUNT - usages[slot]]++] = buf_id;
+		}
+
+		/* Link them in, in that order */
+		part->head.next = &part->tail;
+		part->tail.prev = &part->head;
+		for (int i = 0; i < nbufs; i++)
+		{
+			LRUNode    *node = &LRUNodes[order[i]];
+
+			node->prev = part->tail.prev;
+			node->next = &part->tail;
+			part->tail.prev->next = node;
+			part->tail.prev = node;
+		}
+
+		SpinLockRelease(&part->lock);
+	}
+
+	pfree(usages);
+	pfree(order);
+}
+
+static BufferDesc *
+LRUGetVictim(BufferAccessStrategy strategy, uint32 *buf_state)
+{
+	uint32		start;
+	int			scanned = 0;
+	int			pinned = 0;
+
+	start = pg_atomic_fetch_add_u32(&LRUControl->nextVictimPartition, 1);
+
+	for (int i = 0; i < LRUNumPartitions; i++)
+	{
+		LRUPartition *part;
+		BufferDesc *buf;
+
+		part = &LRUControl->partitions[(start + i) % LRUNumPartitions].partition;
+		buf = LRUGetVictimFromPartition(part, buf_state, &scanned, &pinned);
+		if (buf != NULL)
+		{
+			pgstat_count_buffer_policy_search(BufferPolicyStatsIndex,
+											  scanned, pinned);
+			return buf;
+		}
+	}
+
+	elog(ERROR, "no unpinned buffers available");
+	return NULL;				/* keep compiler quiet */
+}
+
+/*
+ * Report each buffer's distance from the head of its partition's list.  The
+ * lists are walked without their locks, so a buffer that moves meanwhile
+ * may be seen twice or not at all; the walk stops at an unlinked node and
+ * after NBuffers steps, so it ends however the lists change.
+ */
+static void
+LRUDescribe(BufferPolicyBufferInfo *info)
+{
+	for (int p = 0; p < LRUNumPartitions; p++)
+	{
+		LRUPartition *part = &LRUControl->partitions[p].partition;
+		volatile LRUNode *node = part->head.next;
+		int64		position = 0;
+
+		while (node != NULL && node != &part->tail && position < NBuffers)
+		{
+			int			buf_id = node - LRUNodes;
+
+			if (buf_id < 0 || buf_id >= NBuffers)
+				break;
+			info[buf_id].position = position++;
+			node = node->next;
+		}
+	}
+}
+
+/* Buffers are restored least recently used first, so just move to the head */
+static void
+LRURestore(BufferDesc *buf, int usage, const BufferPolicyBufferInfo *info)
+{
+	LRUAccessBuffer(buf);
+}
+
+static const BufferPolicyRoutine LRUPolicy = {
+	.name = "lru",
+	.shmem_size = LRUShmemSize,
+	.shmem_init = LRUShmemInit,
+	.get_victim = LRUGetVictim,
+	.on_hit_batch = LRUAccessBufferBatch,
+	.on_miss = LRUAccessBuffer,
+	.on_invalidate = LRUInvalidateBuffer,
+	.seed = LRUSeed,
+	.describe = LRUDescribe,
+	.restore = LRURestore,
+};
+
+/*
+ * "random": evict a uniformly chosen unpinned buffer.
+ *
+ * Samples are drawn with replacement, so NBuffers of them may well miss the
+ * last few unpinned buffers; give up only after several times as many
+ * pinned ones in a row.
+ */
+#define RANDOM_TRIES_PER_BUFFER 4
+
+static BufferDesc *
+RandomGetVictim(BufferAccessStrategy strategy, uint32 *buf_state)
+{
+	BufferDesc *buf;
+	uint32		local_buf_state;
+	int			trycounter = NBuffers * RANDOM_TRIES_PER_BUFFER;
+	int			scanned = 0;
+
+	for (;;)
+	{
+		buf = GetBufferDescriptor(VictimSearchSample());
+		scanned++;
+
+		if (BUF_STATE_GET_REFCOUNT(pg_atomic_read_u32(&buf->state)) != 0)
+		{
+			if (--trycounter == 0)
+				elog(ERROR, "no unpinned buffers available");
+			continue;
+		}
+
+		local_buf_state = LockBufHdr(buf);
+
+		if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0)
+		{
+			/* Found a usable buffer */
+			*buf_state = local_buf_state;
+			pgstat_count_buffer_policy_search(BufferPolicyStatsIndex,
+											  scanned, scanned - 1);
+			return buf;
+		}
+		UnlockBufHdr(buf, local_buf_state);
+		if (--trycounter == 0)
+			elog(ERROR, "no unpinned buffers available");
+	}
+}
+
+static const BufferPolicyRoutine RandomPolicy = {
+	.name = "random",
+	.get_victim = RandomGetVictim,
+	.queue_victims = true,
+};
+
+/*
+ * "hyperbolic": hyperbolic caching.  A buffer's priority is the number of
+ * accesses to its page divided by the time the page has spent in the pool.
+ * A random sample of buffers is drawn, and the one with the lowest priority
+ * is evicted.
+ *
+ * Time is measured by a logical clock that ticks once per page load: it is
+ * cheap to read, and pages loaded close together don't tie the way they did
+ * with wall-clock seconds.  hyperbolic_sample_size sets the sample size, and
+ * hyperbolic_priority can replace the priority function by plain access
+ * counts or by load order, for comparison.  With hyperbolic_retained_samples
+ * above zero, that many of the best candidates that weren't evicted are kept
+ * in backend-local memory and put into the next sample, as the hyperbolic
+ * caching paper suggests, in place of as many random draws.
+ */
+typedef struct
+{
+	pg_atomic_uint64 loadTime;	/* clock when the page was loaded */
+	pg_atomic_uint32 accesses;	/* accesses since then, including the load */
+} HyperbolicBufferStats;
+
+typedef struct
+{
+	double		priority;
+	int			buf_id;
+} HyperbolicCandidate;
+
+/* GUC variables */
+int			hyperbolic_sample_size = 20;
+int			hyperbolic_retained_samples = 0;
+int			hyperbolic_priority = HYPERBOLIC_PRIORITY_HYPERBOLIC;
+
+/* logical clock, counting page loads since startup */
+static pg_atomic_uint64 *HyperbolicClock = NULL;
+static HyperbolicBufferStats *HyperbolicStats = NULL;
+
+/* candidates kept from this backend's previous sample */
+static int	HyperbolicRetained[HYPERBOLIC_MAX_SAMPLE_SIZE];
+static int	NumHyperbolicRetained = 0;
+
+static Size
+HyperbolicShmemSize(void)
+{
+	return add_size(sizeof(pg_atomic_uint64),
+					mul_size(NBuffers, sizeof(HyperbolicBufferStats)));
+}
+
+static void
+HyperbolicShmemInit(bool init)
+{
+	bool		found;
+
+	HyperbolicClock = (pg_atomic_uint64 *)
+		ShmemInitStruct("Hyperbolic Clock", sizeof(pg_atomic_uint64),
+						&found);
+	HyperbolicStats = (HyperbolicBufferStats *)
+		ShmemInitStruct("Hyperbolic Buffer Stats",
+						mul_size(NBuffers, sizeof(HyperbolicBufferStats)),
+						&found);
+	if (!found)
+	{
+		Assert(init);
+		pg_atomic_init_u64(HyperbolicClock, 0);
+		for (int i = 0; i < NBuffers; i++)
+		{
+			pg_atomic_init_u64(&HyperbolicStats[i].loadTime, 0);
+			pg_atomic_init_u32(&HyperbolicStats[i].accesses, 0);
+		}
+	}
+}
+
+static inline double
+HyperbolicPriority(int buf_id, uint64 now)
+{
+	HyperbolicBufferStats *stats = &HyperbolicStats[buf_id];
+	uint64		loaded = pg_atomic_read_u64(&stats->loadTime);
+	uint32		accesses = pg_atomic_read_u32(&stats->accesses);
+
+	switch ((HyperbolicPriorityFunction) hyperbolic_priority)
+	{
+		case HYPERBOLIC_PRIORITY_HYPERBOLIC:
+			/* the page may have been loaded since we read the clock */
+			return (double) accesses / ((now > loaded ? now - loaded : 0) + 1);
+		case HYPERBOLIC_PRIORITY_LFU:
+			return accesses;
+		case HYPERBOLIC_PRIORITY_FIFO:
+			return loaded;
+	}
+
+	return 0;					/* keep compiler quiet */
+}
+
+static BufferDesc *
+HyperbolicGetVictim(BufferAccessStrategy strategy, uint32 *buf_state)
+{
+	HyperbolicCandidate sample[HYPERBOLIC_MAX_SAMPLE_SIZE];
+	int			sample_size = hyperbolic_sample_size;
+	int			nretain = Min(hyperbolic_retained_samples, sample_size - 1);
+	int			trycounter = NBuffers;
+	int			scanned = 0;
+	int			pinned = 0;
+
+	for (;;)
+	{
+		uint64		now = pg_atomic_read_u64(HyperbolicClock);
+		int			nsample = 0;
+		int			victim = -1;
+		BufferDesc *buf;
+		uint32		local_buf_state;
+
+		/*
+		 * Draw the sample, starting with the candidates retained from last
+		 * time.  Pinned buffers can't be evicted, so leave them out.  If we
+		 * keep drawing pinned ones, make do with a smaller sample, and give
+		 * up only if there is no candidate at all.
+		 */
+		for (int i = 0; nsample < sample_size; i++)
+		{
+			int			buf_id;
+
+			if (i < NumHyperbolicRetained)
+				buf_id = HyperbolicRetained[i];
+			else
+				buf_id = VictimSearchSample();
+
+			buf = GetBufferDescriptor(buf_id);
+			scanned++;
+			if (BUF_STATE_GET_REFCOUNT(pg_atomic_read_u32(&buf->state)) != 0)
+			{
+				pinned++;
+				if (--trycounter > 0)
+					continue;
+				if (nsample > 0)
+					break;
+				elog(ERROR, "no unpinned buffers available");
+			}
+
+			sample[nsample].buf_id = buf_id;
+			sample[nsample].priority = HyperbolicPriority(buf_id, now);
+			if (victim < 0 || sample[nsample].priority < sample[victim].priority)
+				victim = nsample;
+			nsample++;
+		}
+		NumHyperbolicRetained = 0;
+		trycounter = NBuffers;
+
+		buf = GetBufferDescriptor(sample[victim].buf_id);
+		local_buf_state = LockBufHdr(buf);
+		if (BUF_STATE_GET_REFCOUNT(local_buf_state) != 0)
+		{
+			UnlockBufHdr(buf, local_buf_state);
+			pinned++;
+			continue;
+		}
+
+		/* Keep the next best candidates, best first */
+		sample[victim].priority = DBL_MAX;
+		while (NumHyperbolicRetained < nretain)
+		{
+			int			best = 0;
+
+			for (int i = 1; i < nsample; i++)
+			{
+				if (sample[i].priority < sample[best].priority)
+					best = i;
+			}
+			if (sample[best].priority == DBL_MAX)
+				break;
+			HyperbolicRetained[NumHyperbolicRetained++] = sample[best].buf_id;
+			sample[best].priority = DBL_MAX;
+		}
+
+		*buf_state = local_buf_state;
+		pgstat_count_buffer_policy_search(BufferPolicyStatsIndex,
+										  scanned, pinned);
+		return buf;
+	}
+}
+
+static void
+HyperbolicAccessBufferBatch(const int *buf_ids, int nbufs)
+{
+	for (int i = 0; i < nbufs; i++)
+		pg_atomic_fetch_add_u32(&HyperbolicStats[buf_ids[i]].accesses, 1);
+}
+
+static void
+HyperbolicLoadBuffer(BufferDesc *buf)
+{
+	HyperbolicBufferStats *stats = &HyperbolicStats[buf->buf_id];
+
+	pg_atomic_write_u64(&stats->loadTime,
+						pg_atomic_fetch_add_u64(HyperbolicClock, 1));
+	pg_atomic_write_u32(&stats->accesses, 1);
+}
+
+/*
+ * Treat every page in the pool as loaded just now, and accessed as many
+ * times as its usage count says.
+ */
+static void
+HyperbolicSeed(void)
+{
+	uint64		now = pg_atomic_read_u64(HyperbolicClock);
+
+	for (int buf_id = 0; buf_id < NBuffers; buf_id++)
+	{
+		HyperbolicBufferStats *stats = &HyperbolicStats[buf_id];
+		uint32		buf_state;
+
+		buf_state = pg_atomic_read_u32(&GetBufferDescriptor(buf_id)->state);
+		if (!(buf_state & BM_TAG_VALID))
+			continue;
+		pg_atomic_write_u64(&stats->loadTime, now);
+		pg_atomic_write_u32(&stats->accesses,
+							Max(BUF_STATE_GET_USAGECOUNT(buf_state), 1));
+	}
+}
+
+static void
+HyperbolicDescribe(BufferPolicyBufferInfo *info)
+{
+	uint64		now = pg_atomic_read_u64(HyperbolicClock);
+
+	for (int buf_id = 0; buf_id < NBuffers; buf_id++)
+	{
+		HyperbolicBufferStats *stats = &HyperbolicStats[buf_id];
+		uint64		loaded = pg_atomic_read_u64(&stats->loadTime);
+
+		info[buf_id].value = pg_atomic_read_u32(&stats->accesses);
+		info[buf_id].age = now > loaded ? now - loaded : 0;
+	}
+}
+
+/*
+ * Backdate the page's load by its age, so that its priority comes out as it
+ * was, provided that as many pages have been loaded since startup.
+ */
+static void
+HyperbolicRestore(BufferDesc *buf, int usage, const BufferPolicyBufferInfo *info)
+{
+	HyperbolicBufferStats *stats = &HyperbolicStats[buf->buf_id];
+	uint64		now = pg_atomic_read_u64(HyperbolicClock);
+
+	if (info->age >= 0)
+		pg_atomic_write_u64(&stats->loadTime,
+							now - Min((uint64) info->age, now));
+	pg_atomic_write_u32(&stats->accesses,
+						info->value > 0 ? info->value : Max(usage, 1));
+}
+
+static const BufferPolicyRoutine HyperbolicPolicy = {
+	.name = "hyperbolic",
+	.shmem_size = HyperbolicShmemSize,
+	.shmem_init = HyperbolicShmemInit,
+	.get_victim = HyperbolicGetVictim,
+	.queue_victims = true,
+	.on_hit_batch = HyperbolicAccessBufferBatch,
+	.on_miss = HyperbolicLoadBuffer,
+	.seed = HyperbolicSeed,
+	.describe = HyperbolicDescribe,
+	.restore = HyperbolicRestore,
+};
+
+/*
+ * "eaclock": a clock whose per-buffer counters are raised by an adaptive
+ * weight on every access.  The weight is adjusted each time NBuffers / 2
+ * buffers have been evicted, in the direction that improved the hit ratio
+ * over the previous period.
+ *
+ * Two variants are provided.  "eaclock_fdw" keeps the weight fixed and
+ * instead halves every buffer's value when the hit ratio drops sharply, so
+ * that a shifted working set is forgotten quickly.  "eaclock_fwa" credits
+ * accesses with twice the weight.
+ *
+ * The values are uint8 counters that saturate at EACLOCK_MAX_VALUE, packed
+ * four to a word of EAclockValues, so that the sweep streams through a dense
+ * array instead of touching a cache line per buffer.  A value is changed by
+ * compare-and-exchange on its word.
+ *
+ * Halving is done lazily: ending the period merely advances agingEpoch, and
+ * each word of values remembers the epoch it was last normalized to.  When
+ * the clock hand next reaches one of its buffers, all four values are halved
+ * once for every epoch missed.  Hits landing in between are halved along
+ * with the rest, as if they had happened before the aging.
+ *
+ * The hand advances EACLOCK_SWEEP_RUN buffers at a time.  If none of their
+ * values is zero, which a vector compare over the dense array tells cheaply,
+ * none of them can be a victim, and all the unpinned ones are decremented
+ * at once.  Otherwise the backend examines them one by one, taking the
+ * header lock only for an unpinned buffer whose value is zero.  Buffers of a
+ * run it doesn't get to are left for its next allocation.
+ *
+ * To keep hits cheap, each process counts them in its own cache line of
+ * hitCounters, indexed by pgprocno; the counters only ever grow.  An
+ * eviction is counted when a new page is loaded into a buffer that the sweep
+ * picked while it held another page, so buffers taken from the freelist
+ * don't count, and neither do victims the caller gives up on because they
+ * were pinned or dirtied meanwhile.  The search remembers its victim in
+ * EAclockEvictedBuffer for on_miss to check.  Once the count has reached
+ * the end of the period, that same load ends it, holding no locks.  Ending a
+ * period requires setting the "adapting" flag, so only one backend at a time
+ * sums the counters and updates the weight; one that finds the flag already
+ * set simply carries on, and a later load will look again.
+ */
+typedef union EAclockHitCounter
+{
+	pg_atomic_uint64 hits;
+	char		pad[PG_CACHE_LINE_SIZE];
+} EAclockHitCounter;
+
+typedef struct
+{
+	pg_atomic_uint64 evictions; /* evictions since startup */
+	pg_atomic_uint64 periodEnd; /* value of evictions ending this period */
+	pg_atomic_uint32 weight;	/* value added per access */
+	pg_atomic_uint32 agingEpoch;	/* number of "halve all values" steps */
+	pg_atomic_flag adapting;	/* held while the weight is being updated */
+	bool		counting;		/* true once the first eviction happened */
+	bool		isChange;		/* halve values while sweeping */
+
+	/* These are only accessed while holding the adapting flag */
+	int			lastAction;		/* last weight adjustment, +1 or -1 */
+	double		lastHR;			/* hit ratio of the previous period */
+	uint64		lastHits;		/* sum of hitCounters at the period start */
+	uint64		lastEvictions;	/* evictions at the period start */
+
+	EAclockHitCounter hitCounters[FLEXIBLE_ARRAY_MEMBER];
+} EAclockStrategyControl;
+
+static EAclockStrategyControl *EAclockControl = NULL;
+
+#define EACLOCK_VALUES_PER_WORD	4
+#define EACLOCK_MAX_VALUE		PG_UINT8_MAX
+#define EACLOCK_NUM_WORDS		((NBuffers + EACLOCK_VALUES_PER_WORD - 1) / EACLOCK_VALUES_PER_WORD)
+#define EACLOCK_SWEEP_RUN		16
+#define EACLOCK_INITIAL_WEIGHT	2
+
+/* per-buffer values, and the agingEpoch each word was normalized to */
+static pg_atomic_uint32 *EAclockValues = NULL;
+static pg_atomic_uint32 *EAclockWordEpochs = NULL;
+
+/* the rest of this backend's current run of the clock hand */
+static uint32 EAclockRunNext = 0;
+static int	EAclockRunLeft = 0;
+
+/* PGPROCs that can access shared buffers; prepared xacts' never do */
+#define EACLOCK_NUM_HIT_COUNTERS	(MaxBackends + NUM_AUXILIARY_PROCS)
+
+static inline uint64
+EAclockPeriodLength(void)
+{
+	return Max(NBuffers / 2, 1);
+}
+
+static Size
+EAclockShmemSize(void)
+{
+	Size		size;
+
+	size = add_size(offsetof(EAclockStrategyControl, hitCounters),
+					mul_size(EACLOCK_NUM_HIT_COUNTERS,
+							 sizeof(EAclockHitCounter)));
+	size = add_size(size, mul_size(2 * EACLOCK_NUM_WORDS,
+								   sizeof(pg_atomic_uint32)));
+
+	return size;
+}
+
+static void
+EAclockShmemInit(bool init)
+{
+	bool		found;
+
+	EAclockControl = (EAclockStrategyControl *)
+		ShmemInitStruct("EAclock Strategy Status",
+						add_size(offsetof(EAclockStrategyControl, hitCounters),
+								 mul_size(EACLOCK_NUM_HIT_COUNTERS,
+										  sizeof(EAclockHitCounter))),
+						&found);
+	EAclockValues = (pg_atomic_uint32 *)
+		ShmemInitStruct("EAclock Buffer Values",
+						mul_size(2 * EACLOCK_NUM_WORDS,
+								 sizeof(pg_atomic_uint32)),
+						&found);
+	EAclockWordEpochs = EAclockValues + EACLOCK_NUM_WORDS;
+	if (!found)
+	{
+		Assert(init);
+		pg_atomic_init_u64(&EAclockControl->evictions, 0);
+		pg_atomic_init_u64(&EAclockControl->periodEnd, EAclockPeriodLength());
+		pg_atomic_init_u32(&EAclockControl->weight, EACLOCK_INITIAL_WEIGHT);
+		pg_atomic_init_u32(&EAclockControl->agingEpoch, 0);
+		pg_atomic_init_flag(&EAclockControl->adapting);
+		EAclockControl->counting = false;
+		EAclockControl->isChange = false;
+		EAclockControl->lastAction = 1;
+		EAclockControl->lastHR = 0;
+		EAclockControl->lastHits = 0;
+		EAclockControl->lastEvictions = 0;
+		for (int i = 0; i < EACLOCK_NUM_HIT_COUNTERS; i++)
+			pg_atomic_init_u64(&EAclockControl->hitCounters[i].hits, 0);
+		for (int i = 0; i < EACLOCK_NUM_WORDS; i++)
+		{
+			pg_atomic_init_u32(&EAclockValues[i], 0);
+			pg_atomic_init_u32(&EAclockWordEpochs[i], 0);
+		}
+	}
+}
+
+static inline int
+EAclockValueShift(int buf_id)
+{
+	return (buf_id % EACLOCK_VALUES_PER_WORD) * 8;
+}
+
+/* Extract a buffer's value from the word holding it */
+static inline uint32
+EAclockGetValue(uint32 word, int buf_id)
+{
+	return (word >> EAclockValueShift(buf_id)) & EACLOCK_MAX_VALUE;
+}
+
+/*
+ * Try to replace a buffer's value.  *word is the expected content of the
+ * word; on failure it's updated to the current content, like
+ * pg_atomic_compare_exchange_u32().
+ */
+static inline bool
+EAclockReplaceValue(int buf_id, uint32 *word, uint32 value)
+{
+	int			shift = EAclockValueShift(buf_id);
+	uint32		newword;
+
+	Assert(value <= EACLOCK_MAX_VALUE);
+	newword = (*word & ~((uint32) EACLOCK_MAX_VALUE << shift)) | (value << shift);
+
+	return pg_atomic_compare_exchange_u32(&EAclockValues[buf_id / EACLOCK_VALUES_PER_WORD],
+										  word, newword);
+}
+
+/*
+ * Halve all four values of a word, rounding down like the sweep does for a
+ * single value.
+ */
+static inline uint32
+EAclockHalveWord(uint32 word)
+{
+	return (word >> 1) & 0x7F7F7F7F;
+}
+
+/*
+ * Decrement all four values of a word, or halve them rounding down.  Zero
+ * values stay zero.
+ */
+static inline uint32
+EAclockDecrementWord(uint32 word, bool halve)
+{
+	uint32		nonzero;
+
+	if (halve)
+		return EAclockHalveWord(word);
+
+	/* high bit of each byte set iff the byte is nonzero */
+	nonzero = (((word & 0x7F7F7F7F) + 0x7F7F7F7F) | word) & 0x80808080;
+	return word - (nonzero >> 7);
+}
+
+/*
+ * Apply any aging steps a word of values has missed, and return its current
+ * content.
+ *
+ * Whoever advances the word's epoch applies the missed steps; if two backends
+ * race, the loser just sees the values before or after the aging.
+ */
+static inline uint32
+EAclockNormalizeWord(int word_id)
+{
+	pg_atomic_uint32 *valuep = &EAclockValues[word_id];
+	uint32		epoch = pg_atomic_read_u32(&EAclockControl->agingEpoch);
+	uint32		wordEpoch = pg_atomic_read_u32(&EAclockWordEpochs[word_id]);
+	uint32		lag;
+	uint32		word;
+
+	if (likely(wordEpoch == epoch))
+		return pg_atomic_read_u32(valuep);
+
+	if (!pg_atomic_compare_exchange_u32(&EAclockWordEpochs[word_id],
+										&wordEpoch, epoch))
+		return pg_atomic_read_u32(valuep);
+
+	/* Halving a uint8 repeatedly gets it to 0 in at most 8 steps */
+	lag = Min(epoch - wordEpoch, 8);
+	word = pg_atomic_read_u32(valuep);
+	for (;;)
+	{
+		uint32		aged = word;
+
+		for (int i = 0; i < lag; i++)
+			aged = EAclockHalveWord(aged);
+
+		if (aged == word ||
+			pg_atomic_compare_exchange_u32(valuep, &word, aged))
+			return aged;
+	}
+}
+
+/*
+ * Count hits in this process's counter.  No one else writes it, so a plain
+ * read and write is enough.
+ */
+static inline void
+EAclockCountHits(int nhits)
+{
+	pg_atomic_uint64 *counter;
+
+	Assert(MyProc != NULL);
+	counter = &EAclockControl->hitCounters[MyProc->pgprocno].hits;
+	pg_atomic_write_u64(counter, pg_atomic_read_u64(counter) + nhits);
+}
+
+/*
+ * End an adaptation period: compare its hit ratio with the previous one and
+ * adjust the access weight.
+ */
+static void
+EAclockEndPeriod(bool fdw)
+{
+	EAclockStrategyControl *ctl = EAclockControl;
+	uint64		evictions;
+	uint64		hits = 0;
+	double		period_hits;
+	double		period_evictions;
+	double		newHR;
+	int			weight;
+
+	/* Only one backend at a time updates the weight */
+	if (!pg_atomic_test_set_flag(&ctl->adapting))
+		return;
+
+	/* Someone else might have ended this period while we got here */
+	evictions = pg_atomic_read_u64(&ctl->evictions);
+	if (evictions < pg_atomic_read_u64(&ctl->periodEnd))
+	{
+		pg_atomic_clear_flag(&ctl->adapting);
+		return;
+	}
+
+	for (int i = 0; i < EACLOCK_NUM_HIT_COUNTERS; i++)
+		hits += pg_atomic_read_u64(&ctl->hitCounters[i].hits);
+
+	period_hits = hits - ctl->lastHits;
+	period_evictions = evictions - ctl->lastEvictions;
+	newHR = period_hits / (period_hits + period_evictions);
+
+	weight = pg_atomic_read_u32(&ctl->weight);
+	ctl->isChange = false;
+
+	if (newHR > ctl->lastHR)
+		weight += ctl->lastAction;
+	else if (!fdw)
+	{
+		ctl->lastAction = -ctl->lastAction;
+		weight += ctl->lastAction;
+	}
+	else if (ctl->lastHR - newHR > 0.3 * (1 - ctl->lastHR))
+	{
+		/* The hit ratio collapsed; age all buffers as the hand reaches them */
+		ctl->isChange = true;
+		pg_atomic_fetch_add_u32(&ctl->agingEpoch, 1);
+	}
+
+	ctl->lastHR = newHR;
+
+	if (weight <= 0)
+	{
+		weight = 1;
+		ctl->lastHR = newHR - 0.01;
+		ctl->lastAction = -1;
+	}
+	else if (weight >= 16)
+	{
+		weight = 16;
+		ctl->lastHR = newHR - 0.01;
+		ctl->lastAction = 1;
+	}
+
+	pg_atomic_write_u32(&ctl->weight, weight);
+	ctl->lastHits = hits;
+	ctl->lastEvictions = evictions;
+	pg_atomic_write_u64(&ctl->periodEnd, evictions + EAclockPeriodLength());
+
+	pgstat_count_buffer_policy_period(BufferPolicyStatsIndex, weight, newHR,
+									  ctl->isChange);
+
+	pg_atomic_clear_flag(&ctl->adapting);
+}
+
+/*
+ * Try to pass the clock hand over a whole run of buffers starting at start,
+ * which must be aligned to EACLOCK_SWEEP_RUN.  If none of their values is
+ * zero, decrement those of the unpinned ones, as the sweep would one by one,
+ * set *npinned to the number of pinned ones, and return true; otherwise
+ * leave them alone and return false.
+ */
+static bool
+EAclockSweepRun(uint32 start, int *npinned)
+{
+	uint32		words[EACLOCK_SWEEP_RUN / EACLOCK_VALUES_PER_WORD];
+	uint32		keep[EACLOCK_SWEEP_RUN / EACLOCK_VALUES_PER_WORD] = {0};
+	int			first = start / EACLOCK_VALUES_PER_WORD;
+	bool		halve = EAclockControl->isChange;
+
+	for (int i = 0; i < lengthof(words); i++)
+		words[i] = EAclockNormalizeWord(first + i);
+
+	for (Size i = 0; i < sizeof(words); i += sizeof(Vector8))
+	{
+		Vector8		chunk;
+
+		vector8_load(&chunk, (const uint8 *) words + i);
+		if (vector8_has_zero(chunk))
+			return false;
+	}
+
+	/* Pinned buffers' values are left as they are */
+	*npinned = 0;
+	for (int buf_id = start; buf_id < start + EACLOCK_SWEEP_RUN; buf_id++)
+	{
+		if (BUF_STATE_GET_REFCOUNT(pg_atomic_read_u32(&GetBufferDescriptor(buf_id)->state)) != 0)
+		{
+			keep[(buf_id - start) / EACLOCK_VALUES_PER_WORD] |=
+				(uint32) EACLOCK_MAX_VALUE << EAclockValueShift(buf_id);
+			(*npinned)++;
+		}
+	}
+
+	for (int i = 0; i < lengthof(words); i++)
+	{
+		uint32		newword;
+
+		do
+		{
+			newword = (EAclockDecrementWord(words[i], halve) & ~keep[i]) |
+				(words[i] & keep[i]);
+		} while (newword != words[i] &&
+				 !pg_atomic_compare_exchange_u32(&EAclockValues[first + i],
+												 &words[i], newword));
+	}
+
+	return true;
+}
+
+/*
+ * Move the clock hand ahead by a run of buffers and return the next buffer to
+ * examine, or -1 if the whole run was passed over in one go, in which case
+ * *npinned is set to the number of pinned buffers in it.
+ */
+static inline int
+EAclockNextBuffer(int *npinned)
+{
+	int			buf_id;
+
+	if (EAclockRunLeft == 0)
+	{
+		int			runlen = ClockSweepRunLength(EACLOCK_SWEEP_RUN);
+		uint32		start = ClockSweepTickRun(runlen);
+
+		if (start % EACLOCK_SWEEP_RUN == 0 &&
+			ClockSweepRunFits(start, EACLOCK_SWEEP_RUN) &&
+			EAclockSweepRun(start, npinned))
+			return -1;
+
+		EAclockRunNext = start;
+		EAclockRunLeft = runlen;
+	}
+
+	buf_id = EAclockRunNext;
+	EAclockRunNext = ClockSweepRunNext(EAclockRunNext);
+	EAclockRunLeft--;
+
+	return buf_id;
+}
+
+/* the last victim this process picked while it held a page, or -1 */
+static int	EAclockEvictedBuffer = -1;
+
+static BufferDesc *
+EAclockGetVictim(BufferAccessStrategy strategy, uint32 *buf_state)
+{
+	BufferDesc *buf;
+	int			trycounter;
+	uint32		local_buf_state;
+	int			scanned = 0;
+	int			pinned = 0;
+
+	if (!EAclockControl->counting)
+		EAclockControl->counting = true;
+
+	trycounter = NBuffers;
+	for (;;)
+	{
+		uint32		word;
+		uint32		value;
+		int			npinned = 0;
+		int			buf_id = EAclockNextBuffer(&npinned);
+
+		if (buf_id < 0)
+		{
+			scanned += EACLOCK_SWEEP_RUN;
+			pinned += npinned;
+			if (npinned < EACLOCK_SWEEP_RUN)
+				trycounter = NBuffers;
+			else if ((trycounter -= npinned) <= 0)
+				elog(ERROR, "no unpinned buffers available");
+			continue;
+		}
+
+		buf = GetBufferDescriptor(buf_id);
+		scanned++;
+
+		if (BUF_STATE_GET_REFCOUNT(pg_atomic_read_u32(&buf->state)) != 0)
+		{
+			pinned++;
+			if (--trycounter == 0)
+				elog(ERROR, "no unpinned buffers available");
+			continue;
+		}
+
+		word = EAclockNormalizeWord(buf->buf_id / EACLOCK_VALUES_PER_WORD);
+		value = EAclockGetValue(word, buf->buf_id);
+		if (value >= 1)
+		{
+			bool		halve = EAclockControl->isChange;
+
+			/* A halved value must still shrink, or a 1 would never leave */
+			while (value >= 1 &&
+				   !EAclockReplaceValue(buf->buf_id, &word,
+										halve ? value / 2 : value - 1))
+				value = EAclockGetValue(word, buf->buf_id);
+			trycounter = NBuffers;
+			continue;
+		}
+
+		/* Recheck the pin count now that we hold the header lock */
+		local_buf_state = LockBufHdr(buf);
+		if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0)
+			break;
+		UnlockBufHdr(buf, local_buf_state);
+		pinned++;
+	}
+
+	/* Only replacing a page counts as an eviction, once it's done */
+	EAclockEvictedBuffer = (local_buf_state & BM_TAG_VALID) ? buf->buf_id : -1;
+
+	*buf_state = local_buf_state;
+	pgstat_count_buffer_policy_search(BufferPolicyStatsIndex, scanned, pinned);
+	return buf;
+}
+
+/*
+ * Credit a batch of hits.  Consecutive hits on the same buffer are folded
+ * into a single update.
+ */
+static inline void
+EAclockAddValue(int buf_id, uint32 add)
+{
+	uint32		word;
+	uint32		value;
+
+	word = pg_atomic_read_u32(&EAclockValues[buf_id / EACLOCK_VALUES_PER_WORD]);
+	do
+	{
+		value = EAclockGetValue(word, buf_id);
+		if (value == EACLOCK_MAX_VALUE)
+			return;
+	} while (!EAclockReplaceValue(buf_id, &word,
+								  Min(value + add, EACLOCK_MAX_VALUE)));
+}
+
+static pg_attribute_always_inline void
+EAclockHitBatchInternal(const int *buf_ids, int nbufs, uint32 weight)
+{
+	for (int i = 0; i < nbufs; i++)
+	{
+		uint32		add = weight;
+
+		while (i + 1 < nbufs && buf_ids[i + 1] == buf_ids[i])
+		{
+			add += weight;
+			i++;
+		}
+		EAclockAddValue(buf_ids[i], add);
+	}
+
+	if (EAclockControl->counting)
+		EAclockCountHits(nbufs);
+}
+
+static void
+EAclockHitBatch(const int *buf_ids, int nbufs)
+{
+	EAclockHitBatchInternal(buf_ids, nbufs,
+							pg_atomic_read_u32(&EAclockControl->weight));
+}
+
+static void
+EAclockFwaHitBatch(const int *buf_ids, int nbufs)
+{
+	EAclockHitBatchInternal(buf_ids, nbufs,
+							2 * pg_atomic_read_u32(&EAclockControl->weight));
+}
+
+static pg_attribute_always_inline void
+EAclockLoadBufferInternal(BufferDesc *buf, uint32 weight, bool fdw)
+{
+	uint32		word;
+
+	/* Age the old values of the word first, so as not to age the new one */
+	word = EAclockNormalizeWord(buf->buf_id / EACLOCK_VALUES_PER_WORD);
+	while (!EAclockReplaceValue(buf->buf_id, &word,
+								Min(weight, EACLOCK_MAX_VALUE)))
+		;
+
+	/* The page replaces the one our last victim search picked, if any */
+	if (buf->buf_id == EAclockEvictedBuffer)
+		pg_atomic_fetch_add_u64(&EAclockControl->evictions, 1);
+	EAclockEvictedBuffer = -1;
+
+	/* If evictions have completed the period, update the weight */
+	if (EAclockControl->counting &&
+		pg_atomic_read_u64(&EAclockControl->evictions) >=
+		pg_atomic_read_u64(&EAclockControl->periodEnd))
+		EAclockEndPeriod(fdw);
+}
+
+static void
+EAclockLoadBuffer(BufferDesc *buf)
+{
+	EAclockLoadBufferInternal(buf, pg_atomic_read_u32(&EAclockControl->weight),
+							  false);
+}
+
+static void
+EAclockFdwLoadBuffer(BufferDesc *buf)
+{
+	EAclockLoadBufferInternal(buf, pg_atomic_read_u32(&EAclockControl->weight),
+							  true);
+}
+
+static void
+EAclockFwaLoadBuffer(BufferDesc *buf)
+{
+	EAclockLoadBufferInternal(buf,
+							  2 * pg_atomic_read_u32(&EAclockControl->weight),
+							  false);
+}
+
+/*
+ * Start adapting afresh, as at server start, and give every page in the pool
+ * the value its usage count would have earned it at the initial weight.
+ */
+static void
+EAclockSeed(void)
+{
+	EAclockStrategyControl *ctl = EAclockControl;
+	uint64		hits = 0;
+	uint64		evictions;
+	uint32		epoch;
+
+	/* Wait out a backend still ending a period left over from earlier use */
+	ctl->counting = false;
+	while (!pg_atomic_test_set_flag(&ctl->adapting))
+		pg_usleep(1000L);
+
+	for (int i = 0; i < EACLOCK_NUM_HIT_COUNTERS; i++)
+		hits += pg_atomic_read_u64(&ctl->hitCounters[i].hits);
+	evictions = pg_atomic_read_u64(&ctl->evictions);
+
+	pg_atomic_write_u32(&ctl->weight, EACLOCK_INITIAL_WEIGHT);
+	pg_atomic_write_u64(&ctl->periodEnd, evictions + EAclockPeriodLength());
+	ctl->isChange = false;
+	ctl->lastAction = 1;
+	ctl->lastHR = 0;
+	ctl->lastHits = hits;
+	ctl->lastEvictions = evictions;
+
+	pg_atomic_clear_flag(&ctl->adapting);
+
+	epoch = pg_atomic_read_u32(&ctl->agingEpoch);
+	for (int i = 0; i < EACLOCK_NUM_WORDS; i++)
+	{
+		uint32		word = 0;
+
+		for (int buf_id = i * EACLOCK_VALUES_PER_WORD;
+			 buf_id < Min((i + 1) * EACLOCK_VALUES_PER_WORD, NBuffers);
+			 buf_id++)
+		{
+			uint32		buf_state;
+
+			buf_state = pg_atomic_read_u32(&GetBufferDescriptor(buf_id)->state);
+			if (buf_state & BM_TAG_VALID)
+				word |= (BUF_STATE_GET_USAGECOUNT(buf_state) *
+						 EACLOCK_INITIAL_WEIGHT) << EAclockValueShift(buf_id);
+		}
+		pg_atomic_write_u32(&EAclockWordEpochs[i], epoch);
+		pg_atomic_write_u32(&EAclockValues[i], word);
+	}
+}
+
+/*
+ * Report the values as they'll be once their words have caught up with the
+ * aging steps they missed, without writing the aged words back.
+ */
+static void
+EAclockDescribe(BufferPolicyBufferInfo *info)
+{
+	uint32		epoch = pg_atomic_read_u32(&EAclockControl->agingEpoch);
+
+	for (int i = 0; i < EACLOCK_NUM_WORDS; i++)
+	{
+		uint32		word = pg_atomic_read_u32(&EAclockValues[i]);
+		uint32		lag;
+
+		lag = Min(epoch - pg_atomic_read_u32(&EAclockWordEpochs[i]), 8);
+		for (int j = 0; j < lag; j++)
+			word = EAclockHalveWord(word);
+
+		for (int buf_id = i * EACLOCK_VALUES_PER_WORD;
+			 buf_id < Min((i + 1) * EACLOCK_VALUES_PER_WORD, NBuffers);
+			 buf_id++)
+			info[buf_id].value = EAclockGetValue(word, buf_id);
+	}
+}
+
+static void
+EAclockRestore(BufferDesc *buf, int usage, const BufferPolicyBufferInfo *info)
+{
+	uint32		value;
+	uint32		word;
+
+	if (info->value >= 0)
+		value = Min(info->value, EACLOCK_MAX_VALUE);
+	else
+		value = usage * EACLOCK_INITIAL_WEIGHT;
+
+	word = EAclockNormalizeWord(buf->buf_id / EACLOCK_VALUES_PER_WORD);
+	while (!EAclockReplaceValue(buf->buf_id, &word, value))
+		;
+}
+
+static const BufferPolicyRoutine EAclockPolicy = {
+	.name = "eaclock",
+	.shmem_size = EAclockShmemSize,
+	.shmem_init = EAclockShmemInit,
+	.get_victim = EAclockGetVictim,
+	.on_hit_batch = EAclockHitBatch,
+	.on_miss = EAclockLoadBuffer,
+	.seed = EAclockSeed,
+	.describe = EAclockDescribe,
+	.restore = EAclockRestore,
+};
+
+static const BufferPolicyRoutine EAclockFdwPolicy = {
+	.name = "eaclock_fdw",
+	.shmem_size = EAclockShmemSize,
+	.shmem_init = EAclockShmemInit,
+	.get_victim = EAclockGetVictim,
+	.on_hit_batch = EAclockHitBatch,
+	.on_miss = EAclockFdwLoadBuffer,
+	.seed = EAclockSeed,
+	.describe = EAclockDescribe,
+	.restore = EAclockRestore,
+};
+
+static const BufferPolicyRoutine EAclockFwaPolicy = {
+	.name = "eaclock_fwa",
+	.shmem_size = EAclockShmemSize,
+	.shmem_init = EAclockShmemInit,
+	.get_victim = EAclockGetVictim,
+	.on_hit_batch = EAclockFwaHitBatch,
+	.on_miss = EAclockFwaLoadBuffer,
+	.seed = EAclockSeed,
+	.describe = EAclockDescribe,
+	.restore = EAclockRestore,
+};
+
+/*
+ * Support for the queue-based policies "arc" and "s3fifo".
+ *
+ * Their resident queues are Queues of buffer ids (see buf_internals.h),
+ * protected by one spinlock per policy.  A queue's head is its most recently
+ * inserted (or, for arc, used) buffer, and victims are taken from its tail.
+ */
+/*
+ * Report the positions of a queue's buffers, walking it without the lock,
+ * which is safe as far as it goes: the walk stops at a bad link and after
+ * NBuffers steps.  A buffer that moves meanwhile may be seen twice or not at
+ * all.
+ */
+static void
+QueueDescribe(const Queue *queue, const QueueLink *links, const char *name,
+			  BufferPolicyBufferInfo *info)
+{
+	int			i = ((volatile const Queue *) queue)->head;
+	int64		position = 0;
+
+	while (i >= 0 && i < NBuffers && position < NBuffers)
+	{
+		info[i].queue = name;
+		info[i].position = position++;
+		i = ((volatile const QueueLink *) links)[i].next;
+	}
+}
+
+/*
+ * A ghost table remembers pages that were recently evicted, so that a
+ * policy can tell when it let go of a page too early.  To keep it compact it
+ * stores the 32-bit BufTableHashCode() of each page's tag, not the tag.  Two
+ * pages with the same hash code are indistinguishable here; with a table of
+ * NBuffers entries that happens rarely enough, and only makes a policy think
+ * it has seen a page before.
+ *
+ * The entries are on up to GHOST_MAX_LISTS lists, oldest at the tail, and
+ * chained into buckets by hash code.  All access must be protected by the
+ * owning policy's lock.
+ */
+#define GHOST_MAX_LISTS		2
+
+typedef struct
+{
+	Queue		lists[GHOST_MAX_LISTS];
+	Queue		free;			/* unused entries */
+	int			nentries;
+	int			nbuckets;		/* a power of 2 */
+} GhostTableHeader;
+
+/* a process's pointers into a ghost table in shared memory */
+typedef struct
+{
+	GhostTableHeader *hdr;
+	QueueLink  *links;
+	uint32	   *hashcodes;
+	int32	   *hashNext;		/* next entry in the bucket, or -1 */
+	uint8	   *list;			/* which list the entry is on */
+	int32	   *buckets;		/* first entry of each bucket, or -1 */
+} GhostTable;
+
+static int
+GhostTableBuckets(int nentries)
+{
+	return pg_nextpower2_32(Max(nentries, 2));
+}
+
+static Size
+GhostTableSize(int nentries)
+{
+	Size		size;
+
+	size = MAXALIGN(sizeof(GhostTableHeader));
+	size = add_size(size, mul_size(nentries,
+								   sizeof(QueueLink) + 2 * sizeof(int32) +
+								   sizeof(uint8)));
+	size = add_size(size, mul_size(GhostTableBuckets(nentries), sizeof(int32)));
+
+	return MAXALIGN(size);
+}
+
+/*
+ * Set up a process's pointers to the ghost table at ptr, and initialize it
+ * if init is true.
+ */
+static void
+GhostTableAttach(GhostTable *ghosts, void *ptr, int nentries, bool init)
+{
+	char	   *p = ptr;
+	int			nbuckets = GhostTableBuckets(nentries);
+
+	ghosts->hdr = (GhostTableHeader *) p;
+	p += MAXALIGN(sizeof(GhostTableHeader));
+	ghosts->links = (QueueLink *) p;
+	p += nentries * sizeof(QueueLink);
+	ghosts->hashcodes = (uint32 *) p;
+	p += nentries * sizeof(uint32);
+	ghosts->hashNext = (int32 *) p;
+	p += nentries * sizeof(int32);
+	ghosts->buckets = (int32 *) p;
+	p += nbuckets * sizeof(int32);
+	ghosts->list = (uint8 *) p;
+
+	if (init)
+	{
+		ghosts->hdr->nentries = nentries;
+		ghosts->hdr->nbuckets = nbuckets;
+		for (int i = 0; i < GHOST_MAX_LISTS; i++)
+			QueueInit(&ghosts->hdr->lists[i]);
+		QueueInit(&ghosts->hdr->free);
+		for (int i = 0; i < nentries; i++)
+			QueuePushHead(&ghosts->hdr->free, ghosts->links, i);
+		for (int i = 0; i < nbuckets; i++)
+			ghosts->buckets[i] = -1;
+	}
+}
+
+/* Forget all pages */
+static void
+GhostTableReset(GhostTable *ghosts)
+{
+	GhostTableAttach(ghosts, ghosts->hdr, ghosts->hdr->nentries, true);
+}
+
+/* Returns the entry with the given hash code, or -1 if there is none */
+static int
+GhostLookup(GhostTable *ghosts, uint32 hashcode)
+{
+	int			i = ghosts->buckets[hashcode & (ghosts->hdr->nbuckets - 1)];
+
+	while (i >= 0 && ghosts->hashcodes[i] != hashcode)
+		i = ghosts->hashNext[i];
+	return i;
+}
+
+static void
+GhostRemove(GhostTable *ghosts, int i)
+{
+	int32	   *prevp;
+
+	prevp = &ghosts->buckets[ghosts->hashcodes[i] & (ghosts->hdr->nbuckets - 1)];
+	while (*prevp != i)
+		prevp = &ghosts->hashNext[*prevp];
+	*prevp = ghosts->hashNext[i];
+
+	QueueRemove(&ghosts->hdr->lists[ghosts->list[i]], ghosts->links, i);
+	QueuePushHead(&ghosts->hdr->free, ghosts->links, i);
+}
+
+/* Forget the oldest page on the list */
+static void
+GhostRemoveOldest(GhostTable *ghosts, int list)
+{
+	Assert(ghosts->hdr->lists[list].count > 0);
+	GhostRemove(ghosts, ghosts->hdr->lists[list].tail);
+}
+
+/*
+ * Remember a page on the given list.  If the table is full, the oldest page
+ * on that list is forgotten to make room, so callers that want a particular
+ * balance between lists should trim them first.
+ */
+static void
+GhostAdd(GhostTable *ghosts, int list, uint32 hashcode)
+{
+	int			i = GhostLookup(ghosts, hashcode);
+	int32	   *bucket;
+
+	if (i >= 0)
+		GhostRemove(ghosts, i);
+	if (ghosts->hdr->free.count == 0)
+		GhostRemoveOldest(ghosts, list);
+
+	i = ghosts->hdr->free.head;
+	QueueRemove(&ghosts->hdr->free, ghosts->links, i);
+
+	ghosts->hashcodes[i] = hashcode;
+	ghosts->list[i] = list;
+	bucket = &ghosts->buckets[hashcode & (ghosts->hdr->nbuckets - 1)];
+	ghosts->hashNext[i] = *bucket;
+	*bucket = i;
+	QueuePushHead(&ghosts->hdr->lists[list], ghosts->links, i);
+}
+
+/*
+ * A page evicted by this process but not yet remembered in a ghost table.
+ * A victim search hands back its buffer with the header locked, after
+ * releasing the policy's lock, so all it can do is copy the page's tag; the
+ * page is remembered the next time the process takes the lock, with the hash
+ * code computed beforehand.
+ */
+typedef struct
+{
+	bool		valid;
+	int			list;			/* ghost list to put it on */
+	BufferTag	tag;
+} GhostPending;
+
+/* Returns the hash code of the pending page, to be computed without a lock */
+static inline uint32
+GhostPendingHashCode(GhostPending *pending)
+{
+	return pending->valid ? BufTableHashCode(&pending->tag) : 0;
+}
+
+static inline void
+GhostPendingSet(GhostPending *pending, int list, BufferDesc *buf)
+{
+	pending->valid = true;
+	pending->list = list;
+	pending->tag = buf->tag;
+}
+
+/*
+ * Build a queue-based policy's state from the buffer headers: every buffer
+ * holding a page that isn't on a queue yet is passed to place(), in order of
+ * increasing usage count, so that place() putting buffers at the heads of
+ * queues leaves the most used ones furthest from eviction.  The caller must
+ * have emptied the queues, and where[] tells whether a buffer has been put
+ * on one since, by an on_miss call that happened meanwhile.
+ *
+ * The lock is taken for a chunk of buffers at a time, so as not to hold up
+ * other processes for long.
+ */
+#define QUEUE_SEED_CHUNK	1024
+
+static void
+QueueSeed(slock_t *lock, const uint8 *where, void (*place) (int buf_id, int usage))
+{
+	for (int usage = 0; usage <= BM_MAX_USAGE_COUNT; usage++)
+	{
+		for (int start = 0; start < NBuffers; start += QUEUE_SEED_CHUNK)
+		{
+			SpinLockAcquire(lock);
+			for (int buf_id = start;
+				 buf_id < Min(start + QUEUE_SEED_CHUNK, NBuffers);
+				 buf_id++)
+			{
+				uint32		buf_state;
+
+				buf_state = pg_atomic_read_u32(&GetBufferDescriptor(buf_id)->state);
+				if (where[buf_id] == 0 && (buf_state & BM_TAG_VALID) &&
+					BUF_STATE_GET_USAGECOUNT(buf_state) == usage)
+					place(buf_id, usage);
+			}
+			SpinLockRelease(lock);
+		}
+	}
+}
+
+/*
+ * "arc": adaptive replacement cache.  Resident pages are on T1 if they have
+ * been used once since they were loaded, or on T2 if more often, both in LRU
+ * order; recently evicted pages are remembered on the ghost lists B1 and B2,
+ * according to the list they were evicted from.  Victims are taken from T1
+ * while it is longer than a target length, else from T2.  A miss on a page
+ * in B1 means T1 was too short and raises the target; one in B2 lowers it.
+ * A one-time scan thus churns through T1 and leaves the pages used
+ * repeatedly on T2 alone.
+ *
+ * Unlike in the original algorithm the victim is chosen without knowing the
+ * page it's for, so the tie-break in favour of pages returning from B2 is
+ * left out.  The victim is put at the head of T1 until the new page arrives
+ * through on_miss, so that it's not lost if the caller doesn't use it after
+ * all.
+ *
+ * The victim search walks no more than ARC_SCAN_BATCH buffers per
+ * acquisition of the lock, going by the pin counts, and locks the header of
+ * the buffer it picks only after releasing it.  A pinned buffer it comes
+ * across is in use, so it moves to the head of its list, which also keeps
+ * the next round from looking at it again.
+ */
+#define ARC_T1		1
+#define ARC_T2		2
+#define ARC_B1		0			/* ghost lists */
+#define ARC_B2		1
+
+#define ARC_SCAN_BATCH	16
+
+typedef struct
+{
+	slock_t		lock;			/* protects everything here */
+	int			targetT1;		/* target length of T1 */
+	Queue		t1;
+	Queue		t2;
+} ArcStrategyControl;
+
+static ArcStrategyControl *ArcControl = NULL;
+static QueueLink *ArcLinks = NULL;
+static uint8 *ArcWhere = NULL;	/* ARC_T1, ARC_T2 or 0 per buffer */
+static GhostTable ArcGhosts;
+static GhostPending ArcPendingGhost;
+
+static Size
+ArcShmemSize(void)
+{
+	Size		size;
+
+	size = MAXALIGN(sizeof(ArcStrategyControl));
+	size = add_size(size, GhostTableSize(NBuffers));
+	size = add_size(size, mul_size(NBuffers, sizeof(QueueLink) + sizeof(uint8)));
+
+	return size;
+}
+
+static void
+ArcShmemInit(bool init)
+{
+	bool		found;
+	char	   *ptr;
+
+	ptr = ShmemInitStruct("ARC Strategy Status", ArcShmemSize(), &found);
+	ArcControl = (ArcStrategyControl *) ptr;
+	ptr += MAXALIGN(sizeof(ArcStrategyControl));
+	GhostTableAttach(&ArcGhosts, ptr, NBuffers, !found);
+	ptr += GhostTableSize(NBuffers);
+	ArcLinks = (QueueLink *) ptr;
+	ptr += NBuffers * sizeof(QueueLink);
+	ArcWhere = (uint8 *) ptr;
+
+	if (!found)
+	{
+		Assert(init);
+		SpinLockInit(&ArcControl->lock);
+		ArcControl->targetT1 = 0;
+		QueueInit(&ArcControl->t1);
+		QueueInit(&ArcControl->t2);
+		memset(ArcWhere, 0, NBuffers * sizeof(uint8));
+	}
+}
+
+static inline Queue *
+ArcQueue(int where)
+{
+	return where == ARC_T1 ? &ArcControl->t1 : &ArcControl->t2;
+}
+
+/* Move a buffer to the head of T1 or T2.  Caller must hold the lock. */
+static inline void
+ArcMoveToHead(int buf_id, int where)
+{
+	if (ArcWhere[buf_id] != 0)
+		QueueRemove(ArcQueue(ArcWhere[buf_id]), ArcLinks, buf_id);
+	QueuePushHead(ArcQueue(where), ArcLinks, buf_id);
+	ArcWhere[buf_id] = where;
+}
+
+/*
+ * Remember the page this process evicted last, if it hasn't been yet, on B1
+ * or B2, keeping T1 and B1 together, and B1 and B2 together, no longer than
+ * the pool.  hashcode is the result of GhostPendingHashCode().  Caller must
+ * hold the lock.
+ */
+static void
+ArcRememberPage(uint32 hashcode)
+{
+	GhostTableHeader *hdr = ArcGhosts.hdr;
+	int			ghost = ArcPendingGhost.list;
+
+	if (!ArcPendingGhost.valid)
+		return;
+	ArcPendingGhost.valid = false;
+
+	if (ghost == ARC_B1 && hdr->lists[ARC_B1].count > 0 &&
+		ArcControl->t1.count + hdr->lists[ARC_B1].count >= NBuffers)
+		GhostRemoveOldest(&ArcGhosts, ARC_B1);
+	if (hdr->lists[ARC_B1].count + hdr->lists[ARC_B2].count >= NBuffers)
+		GhostRemoveOldest(&ArcGhosts,
+						  hdr->lists[ARC_B2].count > 0 ? ARC_B2 : ARC_B1);
+
+	GhostAdd(&ArcGhosts, ghost, hashcode);
+}
+
+/*
+ * Walk a list from its tail, for at most *budget buffers, and return the
+ * least recently used one that isn't pinned, or -1 if there is none.  It is
+ * moved to the head of T1.  Pinned buffers move to the head of their list;
+ * their number is added to *pinned.  Caller must hold the lock.
+ */
+static int
+ArcTakeCandidate(int where, int *budget, int *pinned)
+{
+	Queue	   *queue = ArcQueue(where);
+
+	for (int n = queue->count; n > 0 && *budget > 0; n--)
+	{
+		int			buf_id = queue->tail;
+		uint32		buf_state;
+
+		(*budget)--;
+		buf_state = pg_atomic_read_u32(&GetBufferDescriptor(buf_id)->state);
+		if (BUF_STATE_GET_REFCOUNT(buf_state) == 0)
+		{
+			ArcMoveToHead(buf_id, ARC_T1);
+			return buf_id;
+		}
+		ArcMoveToHead(buf_id, where);
+		(*pinned)++;
+	}
+
+	return -1;
+}
+
+static BufferDesc *
+ArcGetVictim(BufferAccessStrategy strategy, uint32 *buf_state)
+{
+	int			trycounter = NBuffers;
+	int			scanned = 0;
+	int			pinned = 0;
+
+	for (;;)
+	{
+		uint32		hashcode = GhostPendingHashCode(&ArcPendingGhost);
+		int			budget = ARC_SCAN_BATCH;
+		int			round_pinned = 0;
+		int			first;
+		int			from;
+		int			buf_id;
+		BufferDesc *buf;
+		uint32		local_buf_state;
+
+		SpinLockAcquire(&ArcControl->lock);
+
+		ArcRememberPage(hashcode);
+
+		if (ArcControl->t1.count > 0 &&
+			(ArcControl->t1.count > ArcControl->targetT1 ||
+			 ArcControl->t2.count == 0))
+			first = ARC_T1;
+		else
+			first = ARC_T2;
+
+		from = first;
+		buf_id = ArcTakeCandidate(from, &budget, &round_pinned);
+		if (buf_id < 0 && budget > 0)
+		{
+			from = (first == ARC_T1 ? ARC_T2 : ARC_T1);
+			buf_id = ArcTakeCandidate(from, &budget, &round_pinned);
+		}
+
+		SpinLockRelease(&ArcControl->lock);
+
+		scanned += ARC_SCAN_BATCH - budget;
+		pinned += round_pinned;
+		trycounter -= round_pinned;
+		if (buf_id < 0)
+		{
+			/* Give up if both lists are empty, or all we see is pinned */
+			if (budget == ARC_SCAN_BATCH || trycounter <= 0)
+				break;
+			continue;
+		}
+
+		buf = GetBufferDescriptor(buf_id);
+		local_buf_state = LockBufHdr(buf);
+		if (BUF_STATE_GET_REFCOUNT(local_buf_state) != 0)
+		{
+			UnlockBufHdr(buf, local_buf_state);
+			pinned++;
+			if (--trycounter <= 0)
+				break;
+			continue;
+		}
+
+		if (local_buf_state & BM_TAG_VALID)
+			GhostPendingSet(&ArcPendingGhost,
+							from == ARC_T1 ? ARC_B1 : ARC_B2, buf);
+
+		*buf_state = local_buf_state;
+		pgstat_count_buffer_policy_search(BufferPolicyStatsIndex,
+										  scanned, pinned);
+		return buf;
+	}
+
+	elog(ERROR, "no unpinned buffers available");
+	return NULL;				/* keep compiler quiet */
+}
+
+static void
+ArcAccessBufferBatch(const int *buf_ids, int nbufs)
+{
+	SpinLockAcquire(&ArcControl->lock);
+	for (int i = 0; i < nbufs; i++)
+	{
+		/* Buffers that have been freed meanwhile are left alone */
+		if (ArcWhere[buf_ids[i]] != 0)
+			ArcMoveToHead(buf_ids[i], ARC_T2);
+	}
+	SpinLockRelease(&ArcControl->lock);
+}
+
+/*
+ * A new page has been loaded.  If it was evicted recently, adjust the target
+ * length of T1 in favour of the list it was evicted from, and put it on T2;
+ * otherwise it goes on T1.
+ */
+static void
+ArcLoadBuffer(BufferDesc *buf)
+{
+	uint32		hashcode = BufTableHashCode(&buf->tag);
+	uint32		evicted_hashcode = GhostPendingHashCode(&ArcPendingGhost);
+	GhostTableHeader *hdr = ArcGhosts.hdr;
+	int			ghost;
+
+	SpinLockAcquire(&ArcControl->lock);
+
+	ArcRememberPage(evicted_hashcode);
+
+	ghost = GhostLookup(&ArcGhosts, hashcode);
+	if (ghost < 0)
+		ArcMoveToHead(buf->buf_id, ARC_T1);
+	else
+	{
+		int			b1 = hdr->lists[ARC_B1].count;
+		int			b2 = hdr->lists[ARC_B2].count;
+
+		if (ArcGhosts.list[ghost] == ARC_B1)
+			ArcControl->targetT1 = Min(ArcControl->targetT1 + Max(b2 / b1, 1),
+									   NBuffers);
+		else
+			ArcControl->targetT1 = Max(ArcControl->targetT1 - Max(b1 / b2, 1),
+									   0);
+		GhostRemove(&ArcGhosts, ghost);
+		ArcMoveToHead(buf->buf_id, ARC_T2);
+	}
+
+	SpinLockRelease(&ArcControl->lock);
+}
+
+static void
+ArcInvalidateBuffer(BufferDesc *buf)
+{
+	SpinLockAcquire(&ArcControl->lock);
+	if (ArcWhere[buf->buf_id] != 0)
+	{
+		QueueRemove(ArcQueue(ArcWhere[buf->buf_id]), ArcLinks, buf->buf_id);
+		ArcWhere[buf->buf_id] = 0;
+	}
+	SpinLockRelease(&ArcControl->lock);
+}
+
+/* Pages used more than once since the hand last passed go on T2 */
+static void
+ArcSeedBuffer(int buf_id, int usage)
+{
+	ArcMoveToHead(buf_id, usage > 1 ? ARC_T2 : ARC_T1);
+}
+
+static void
+ArcSeed(void)
+{
+	SpinLockAcquire(&ArcControl->lock);
+	ArcControl->targetT1 = 0;
+	QueueInit(&ArcControl->t1);
+	QueueInit(&ArcControl->t2);
+	memset(ArcWhere, 0, NBuffers * sizeof(uint8));
+	GhostTableReset(&ArcGhosts);
+	SpinLockRelease(&ArcControl->lock);
+
+	QueueSeed(&ArcControl->lock, ArcWhere, ArcSeedBuffer);
+}
+
+static void
+ArcDescribe(BufferPolicyBufferInfo *info)
+{
+	QueueDescribe(&ArcControl->t1, ArcLinks, "T1", info);
+	QueueDescribe(&ArcControl->t2, ArcLinks, "T2", info);
+}
+
+/* Buffers are restored least recently used first, so just move to the head */
+static void
+ArcRestore(BufferDesc *buf, int usage, const BufferPolicyBufferInfo *info)
+{
+	int			where;
+
+	if (info->queue != NULL && strcmp(info->queue, "T1") == 0)
+		where = ARC_T1;
+	else if (info->queue != NULL && strcmp(info->queue, "T2") == 0)
+		where = ARC_T2;
+	else
+		where = usage > 1 ? ARC_T2 : ARC_T1;
+
+	SpinLockAcquire(&ArcControl->lock);
+	ArcMoveToHead(buf->buf_id, where);
+	SpinLockRelease(&ArcControl->lock);
+}
+
+static const BufferPolicyRoutine ArcPolicy = {
+	.name = "arc",
+	.shmem_size = ArcShmemSize,
+	.shmem_init = ArcShmemInit,
+	.get_victim = ArcGetVictim,
+	.on_hit_batch = ArcAccessBufferBatch,
+	.on_miss = ArcLoadBuffer,
+	.on_invalidate = ArcInvalidateBuffer,
+	.seed = ArcSeed,
+	.describe = ArcDescribe,
+	.restore = ArcRestore,
+};
+
+/*
+ * "s3fifo": S3-FIFO.  New pages enter a small FIFO queue S, about a tenth of
+ * the pool; pages evicted from S are remembered in a ghost FIFO G.  A page
+ * that is used again while it's on S moves to the main FIFO queue M when it
+ * reaches the tail of S, and a page that is loaded while it's on G goes to M
+ * right away.  M is managed like a clock: a page reaching its tail goes back
+ * to the head if it was used since it last passed, with one use fewer to
+ * its credit, and is evicted otherwise.  Pages seen only once, as in a scan,
+ * thus leave through S without disturbing M.
+ *
+ * Hits only bump a small per-buffer counter, which is done without the
+ * lock: an update lost to a concurrent change of the same counter costs a
+ * little accuracy, nothing more.  As with arc, the victim search looks at no
+ * more than S3FIFO_SCAN_BATCH buffers per acquisition of the lock and locks
+ * the header of the buffer it picks only after releasing it.
+ */
+#define S3FIFO_SMALL	1
+#define S3FIFO_MAIN		2
+#define S3FIFO_MAX_FREQ	3
+#define S3FIFO_GHOST	0		/* the ghost list */
+
+#define S3FIFO_SCAN_BATCH	16
+
+typedef struct
+{
+	slock_t		lock;			/* protects everything here but freqs */
+	Queue		small;
+	Queue		main;
+} S3FifoStrategyControl;
+
+static S3FifoStrategyControl *S3FifoControl = NULL;
+static QueueLink *S3FifoLinks = NULL;
+static uint8 *S3FifoWhere = NULL;	/* S3FIFO_SMALL, S3FIFO_MAIN or 0 */
+static uint8 *S3FifoFreqs = NULL;	/* uses, up to S3FIFO_MAX_FREQ */
+static GhostTable S3FifoGhosts;
+static GhostPending S3FifoPendingGhost;
+
+static inline int
+S3FifoSmallTarget(void)
+{
+	return Max(NBuffers / 10, 1);
+}
+
+static Size
+S3FifoShmemSize(void)
+{
+	Size		size;
+
+	size = MAXALIGN(sizeof(S3FifoStrategyControl));
+	size = add_size(size, GhostTableSize(NBuffers));
+	size = add_size(size, mul_size(NBuffers,
+								   sizeof(QueueLink) + 2 * sizeof(uint8)));
+
+	return size;
+}
+
+static void
+S3FifoShmemInit(bool init)
+{
+	bool		found;
+	char	   *ptr;
+
+	ptr = ShmemInitStruct("S3-FIFO Strategy Status", S3FifoShmemSize(), &found);
+	S3FifoControl = (S3FifoStrategyControl *) ptr;
+	ptr += MAXALIGN(sizeof(S3FifoStrategyControl));
+	GhostTableAttach(&S3FifoGhosts, ptr, NBuffers, !found);
+	ptr += GhostTableSize(NBuffers);
+	S3FifoLinks = (QueueLink *) ptr;
+	ptr += NBuffers * sizeof(QueueLink);
+	S3FifoWhere = (uint8 *) ptr;
+	ptr += NBuffers * sizeof(uint8);
+	S3FifoFreqs = (uint8 *) ptr;
+
+	if (!found)
+	{
+		Assert(init);
+		SpinLockInit(&S3FifoControl->lock);
+		QueueInit(&S3FifoControl->small);
+		QueueInit(&S3FifoControl->main);
+		memset(S3FifoWhere, 0, NBuffers * sizeof(uint8));
+		memset(S3FifoFreqs, 0, NBuffers * sizeof(uint8));
+	}
+}
+
+static inline Queue *
+S3FifoQueue(int where)
+{
+	return where == S3FIFO_SMALL ? &S3FifoControl->small : &S3FifoControl->main;
+}
+
+/* Move a buffer to the head of S or M.  Caller must hold the lock. */
+static inline void
+S3FifoMoveToHead(int buf_id, int where)
+{
+	if (S3FifoWhere[buf_id] != 0)
+		QueueRemove(S3FifoQueue(S3FifoWhere[buf_id]), S3FifoLinks, buf_id);
+	QueuePushHead(S3FifoQueue(where), S3FifoLinks, buf_id);
+	S3FifoWhere[buf_id] = where;
+}
+
+/*
+ * Remember the page this process evicted last from S, if it hasn't been yet,
+ * keeping G no longer than M can be.  hashcode is the result of
+ * GhostPendingHashCode().  Caller must hold the lock.
+ */
+static void
+S3FifoRememberPage(uint32 hashcode)
+{
+	Queue	   *ghosts = &S3FifoGhosts.hdr->lists[S3FIFO_GHOST];
+
+	if (!S3FifoPendingGhost.valid)
+		return;
+	S3FifoPendingGhost.valid = false;
+
+	while (ghosts->count > 0 &&
+		   ghosts->count >= NBuffers - S3FifoSmallTarget())
+		GhostRemoveOldest(&S3FifoGhosts, S3FIFO_GHOST);
+	GhostAdd(&S3FifoGhosts, S3FIFO_GHOST, hashcode);
+}
+
+static BufferDesc *
+S3FifoGetVictim(BufferAccessStrategy strategy, uint32 *buf_state)
+{
+	S3FifoStrategyControl *ctl = S3FifoControl;
+	int			trycounter = NBuffers;
+	int			scanned = 0;
+	int			pinned = 0;
+
+	for (;;)
+	{
+		uint32		hashcode = GhostPendingHashCode(&S3FifoPendingGhost);
+		bool		empty = false;
+		int			victim = -1;
+		int			from = 0;
+		BufferDesc *buf;
+		uint32		local_buf_state;
+
+		SpinLockAcquire(&ctl->lock);
+
+		S3FifoRememberPage(hashcode);
+
+		for (int budget = S3FIFO_SCAN_BATCH; budget > 0; budget--)
+		{
+			int			where;
+			int			buf_id;
+			uint32		buf_state_now;
+
+			if (ctl->small.count > 0 &&
+				(ctl->small.count >= S3FifoSmallTarget() || ctl->main.count == 0))
+				where = S3FIFO_SMALL;
+			else if (ctl->main.count > 0)
+				where = S3FIFO_MAIN;
+			else
+			{
+				empty = true;
+				break;
+			}
+
+			buf_id = S3FifoQueue(where)->tail;
+			buf_state_now = pg_atomic_read_u32(&GetBufferDescriptor(buf_id)->state);
+			scanned++;
+
+			/* Pinned buffers are in use, so treat them as just inserted */
+			if (BUF_STATE_GET_REFCOUNT(buf_state_now) != 0)
+			{
+				S3FifoMoveToHead(buf_id, where);
+				pinned++;
+				if (--trycounter <= 0)
+					break;
+				continue;
+			}
+
+			/*
+			 * Moving a page to M or back to its head uses up a use, so it
+			 * doesn't count against trycounter: it can only happen a bounded
+			 * number of times before a victim turns up.
+			 */
+			if (where == S3FIFO_SMALL && S3FifoFreqs[buf_id] > 0)
+			{
+				/* Used again while on probation: promote it */
+				S3FifoFreqs[buf_id] = 0;
+				S3FifoMoveToHead(buf_id, S3FIFO_MAIN);
+				continue;
+			}
+			if (where == S3FIFO_MAIN && S3FifoFreqs[buf_id] > 0)
+			{
+				S3FifoFreqs[buf_id]--;
+				S3FifoMoveToHead(buf_id, S3FIFO_MAIN);
+				continue;
+			}
+
+			/* Keep the buffer on S until its new page arrives */
+			S3FifoFreqs[buf_id] = 0;
+			S3FifoMoveToHead(buf_id, S3FIFO_SMALL);
+			victim = buf_id;
+			from = where;
+			break;
+		}
+
+		SpinLockRelease(&ctl->lock);
+
+		if (victim < 0)
+		{
+			if (empty || trycounter <= 0)
+				break;
+			continue;
+		}
+
+		/* Recheck the pin count now that we hold the header lock */
+		buf = GetBufferDescriptor(victim);
+		local_buf_state = LockBufHdr(buf);
+		if (BUF_STATE_GET_REFCOUNT(local_buf_state) != 0)
+		{
+			UnlockBufHdr(buf, local_buf_state);
+			pinned++;
+			if (--trycounter <= 0)
+				break;
+			continue;
+		}
+
+		/* Pages leaving S are remembered, for as many as M holds */
+		if (from == S3FIFO_SMALL && (local_buf_state & BM_TAG_VALID))
+			GhostPendingSet(&S3FifoPendingGhost, S3FIFO_GHOST, buf);
+
+		*buf_state = local_buf_state;
+		pgstat_count_buffer_policy_search(BufferPolicyStatsIndex,
+										  scanned, pinned);
+		return buf;
+	}
+
+	elog(ERROR, "no unpinned buffers available");
+	return NULL;				/* keep compiler quiet */
+}
+
+static void
+S3FifoAccessBufferBatch(const int *buf_ids, int nbufs)
+{
+	for (int i = 0; i < nbufs; i++)
+	{
+		uint8		freq = S3FifoFreqs[buf_ids[i]];
+
+		if (freq < S3FIFO_MAX_FREQ)
+			S3FifoFreqs[buf_ids[i]] = freq + 1;
+	}
+}
+
+/* A page evicted from S not long ago goes straight to M */
+static void
+S3FifoLoadBuffer(BufferDesc *buf)
+{
+	uint32		hashcode = BufTableHashCode(&buf->tag);
+	uint32		evicted_hashcode = GhostPendingHashCode(&S3FifoPendingGhost);
+	int			ghost;
+
+	SpinLockAcquire(&S3FifoControl->lock);
+
+	S3FifoRememberPage(evicted_hashcode);
+
+	S3FifoFreqs[buf->buf_id] = 0;
+	ghost = GhostLookup(&S3FifoGhosts, hashcode);
+	if (ghost >= 0)
+	{
+		GhostRemove(&S3FifoGhosts, ghost);
+		S3FifoMoveToHead(buf->buf_id, S3FIFO_MAIN);
+	}
+	else
+		S3FifoMoveToHead(buf->buf_id, S3FIFO_SMALL);
+
+	SpinLockRelease(&S3FifoControl->lock);
+}
+
+static void
+S3FifoInvalidateBuffer(BufferDesc *buf)
+{
+	SpinLockAcquire(&S3FifoControl->lock);
+	if (S3FifoWhere[buf->buf_id] != 0)
+	{
+		QueueRemove(S3FifoQueue(S3FifoWhere[buf->buf_id]), S3FifoLinks,
+					buf->buf_id);
+		S3FifoWhere[buf->buf_id] = 0;
+	}
+	S3FifoFreqs[buf->buf_id] = 0;
+	SpinLockRelease(&S3FifoControl->lock);
+}
+
+/* Pages in use go on M, crediting their usage count; the others on S */
+static void
+S3FifoSeedBuffer(int buf_id, int usage)
+{
+	S3FifoFreqs[buf_id] = Min(usage, S3FIFO_MAX_FREQ);
+	S3FifoMoveToHead(buf_id, usage > 0 ? S3FIFO_MAIN : S3FIFO_SMALL);
+}
+
+static void
+S3FifoSeed(void)
+{
+	SpinLockAcquire(&S3FifoControl->lock);
+	QueueInit(&S3FifoControl->small);
+	QueueInit(&S3FifoControl->main);
+	memset(S3FifoWhere, 0, NBuffers * sizeof(uint8));
+	GhostTableReset(&S3FifoGhosts);
+	SpinLockRelease(&S3FifoControl->lock);
+
+	QueueSeed(&S3FifoControl->lock, S3FifoWhere, S3FifoSeedBuffer);
+}
+
+static void
+S3FifoDescribe(BufferPolicyBufferInfo *info)
+{
+	QueueDescribe(&S3FifoControl->small, S3FifoLinks, "small", info);
+	QueueDescribe(&S3FifoControl->main, S3FifoLinks, "main", info);
+	for (int buf_id = 0; buf_id < NBuffers; buf_id++)
+	{
+		if (info[buf_id].queue != NULL)
+			info[buf_id].value = S3FifoFreqs[buf_id];
+	}
+}
+
+static void
+S3FifoRestore(BufferDesc *buf, int usage, const BufferPolicyBufferInfo *info)
+{
+	int			where;
+
+	if (info->queue != NULL && strcmp(info->queue, "small") == 0)
+		where = S3FIFO_SMALL;
+	else if (info->queue != NULL && strcmp(info->queue, "main") == 0)
+		where = S3FIFO_MAIN;
+	else
+		where = usage > 0 ? S3FIFO_MAIN : S3FIFO_SMALL;
+
+	S3FifoFreqs[buf->buf_id] =
+		Min(info->value >= 0 ? info->value : usage, S3FIFO_MAX_FREQ);
+	SpinLockAcquire(&S3FifoControl->lock);
+	S3FifoMoveToHead(buf->buf_id, where);
+	SpinLockRelease(&S3FifoControl->lock);
+}
+
+static const BufferPolicyRoutine S3FifoPolicy = {
+	.name = "s3fifo",
+	.shmem_size = S3FifoShmemSize,
+	.shmem_init = S3FifoShmemInit,
+	.get_victim = S3FifoGetVictim,
+	.on_hit_batch = S3FifoAccessBufferBatch,
+	.on_miss = S3FifoLoadBuffer,
+	.on_invalidate = S3FifoInvalidateBuffer,
+	.seed = S3FifoSeed,
+	.describe = S3FifoDescribe,
+	.restore = S3FifoRestore,
+};
+
+/*
+ * Registry of replacement policies.  The built-in ones are always available;
+ * others are added by RegisterBufferPolicy().
+ */
+static const BufferPolicyRoutine *const BuiltinBufferPolicies[] = {
+	&ClockSweepPolicy,
+	&ClockPolicy,
+	&LRUPolicy,
+	&RandomPolicy,
+	&HyperbolicPolicy,
+	&EAclockPolicy,
+	&EAclockFdwPolicy,
+	&EAclockFwaPolicy,
+	&ArcPolicy,
+	&S3FifoPolicy,
+};
+
+#define MAX_CUSTOM_BUFFER_POLICIES	16
+
+static const BufferPolicyRoutine *CustomBufferPolicies[MAX_CUSTOM_BUFFER_POLICIES];
+static int	NumCustomBufferPolicies = 0;
+
+/*
+ * Policies are identified in shared memory by their position in the registry,
+ * built-in ones first.  Custom policies are registered in the same order in
+ * every process, so the positions agree.
+ */
+static int
+NumBufferPolicies(void)
+{
+	return lengthof(BuiltinBufferPolicies) + NumCustomBufferPolicies;
+}
+
+static const BufferPolicyRoutine *
+GetBufferPolicy(int policy_idx)
+{
+	Assert(policy_idx >= 0 && policy_idx < NumBufferPolicies());
+
+	if (policy_idx < lengthof(BuiltinBufferPolicies))
+		return BuiltinBufferPolicies[policy_idx];
+	return CustomBufferPolicies[policy_idx - lengthof(BuiltinBufferPolicies)];
+}
+
+/*
+ * Returns the registry position of the named policy, or -1 if none.
+ */
+static int
+LookupBufferPolicy(const char *name)
+{
+	for (int i = 0; i < NumBufferPolicies(); i++)
+	{
+		if (pg_strcasecmp(GetBufferPolicy(i)->name, name) == 0)
+			return i;
+	}
+	return -1;
+}
+
+/*
+ * RegisterBufferPolicy -- make a replacement policy selectable through
+ *		buffer_replacement_policy
+ *
+ * Must be called from the _PG_init() of a library listed in
+ * shared_preload_libraries.  The routine struct is not copied, so it must be
+ * allocated statically.
+ */
+void
+RegisterBufferPolicy(const BufferPolicyRoutine *routine)
+{
+	if (routine->name == NULL || routine->name[0] == '\0')
+		ereport(ERROR,
+				(errmsg("buffer replacement policy name is invalid"),
+				 errhint("Provide a non-empty name for the buffer replacement policy.")));
+
+	if (!process_shared_preload_libraries_in_progress)
+		ereport(ERROR,
+				(errmsg("failed to register buffer replacement policy \"%s\"",
+						routine->name),
+				 errdetail("Buffer replacement policies must be registered while initializing modules in shared_preload_libraries.")));
+
+	if (routine->get_victim == NULL)
+		ereport(ERROR,
+				(errmsg("failed to register buffer replacement policy \"%s\"",
+						routine->name),
+				 errdetail("The get_victim callback is required.")));
+
+	if (LookupBufferPolicy(routine->name) >= 0)
+		ereport(ERROR,
+				(errmsg("failed to register buffer replacement policy \"%s\"",
+						routine->name),
+				 errdetail("A buffer replacement policy with the same name already exists.")));
+
+	if (NumCustomBufferPolicies >= MAX_CUSTOM_BUFFER_POLICIES)
+		ereport(ERROR,
+				(errmsg("failed to register buffer replacement policy \"%s\"",
+						routine->name),
+				 errdetail("At most %d custom buffer replacement policies can be registered.",
+						   MAX_CUSTOM_BUFFER_POLICIES)));
+
+	CustomBufferPolicies[NumCustomBufferPolicies++] = routine;
+
+	ereport(LOG,
+			(errmsg("registered buffer replacement policy \"%s\"",
+					routine->name)));
+}
+
+/*
+ * check_buffer_replacement_policy -- GUC check hook
+ *
+ * Policies registered by libraries are unknown until shared_preload_libraries
+ * have been loaded, so the initial value is checked by StrategyInitialize()
+ * instead.
+ */
+bool
+check_buffer_replacement_policy(char **newval, void **extra, GucSource source)
+{
+	if (!process_shared_preload_libraries_done)
+		return true;
+
+	if (LookupBufferPolicy(*newval) < 0)
+	{
+		GUC_check_errdetail("Buffer replacement policy \"%s\" does not exist.",
+							*newval);
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * The policy in use while switching from SwitchFromPolicy to SwitchToPolicy.
+ * Victims are still chosen by the former, but accesses are reported to both,
+ * so that the latter's state doesn't miss any that happen while it is being
+ * seeded.
+ */
+static BufferDesc *
+SwitchingGetVictim(BufferAccessStrategy strategy, uint32 *buf_state)
+{
+	return SwitchFromPolicy->get_victim(strategy, buf_state);
+}
+
+static void
+SwitchingHitBatch(const int *buf_ids, int nbufs)
+{
+	DeliverBufferHits(SwitchFromPolicy, buf_ids, nbufs);
+	DeliverBufferHits(SwitchToPolicy, buf_ids, nbufs);
+}
+
+static void
+SwitchingMiss(BufferDesc *buf)
+{
+	if (SwitchFromPolicy->on_miss != NULL)
+		SwitchFromPolicy->on_miss(buf);
+	if (SwitchToPolicy->on_miss != NULL)
+		SwitchToPolicy->on_miss(buf);
+}
+
+static void
+SwitchingInvalidate(BufferDesc *buf)
+{
+	if (SwitchFromPolicy->on_invalidate != NULL)
+		SwitchFromPolicy->on_invalidate(buf);
+	if (SwitchToPolicy->on_invalidate != NULL)
+		SwitchToPolicy->on_invalidate(buf);
+}
+
+static const BufferPolicyRoutine SwitchingBufferPolicy = {
+	.name = "switching",
+	.get_victim = SwitchingGetVictim,
+	.on_hit_batch = SwitchingHitBatch,
+	.on_miss = SwitchingMiss,
+	.on_invalidate = SwitchingInvalidate,
+};
+
+/*
+ * RefreshBufferPolicy -- make this process use the policy set in shared memory
+ */
+void
+RefreshBufferPolicy(void)
+{
+	int			active;
+	int			next;
+
+	SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
+	BufferPolicyGeneration =
+		pg_atomic_read_u32(&StrategyControl->policyGeneration);
+	active = StrategyControl->activePolicy;
+	next = StrategyControl->nextPolicy;
+	SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+
+	SwitchFromPolicy = GetBufferPolicy(active);
+	if (next >= 0)
+	{
+		SwitchToPolicy = GetBufferPolicy(next);
+		BufferPolicy = &SwitchingBufferPolicy;
+	}
+	else
+	{
+		SwitchToPolicy = NULL;
+		BufferPolicy = SwitchFromPolicy;
+	}
+
+	/* Statistics go to the policy that chooses the victims */
+	BufferPolicyStatsIndex =
+		pgstat_get_buffer_policy_index(SwitchFromPolicy->name);
+}
+
+/*
+ * ProcessBarrierBufferPolicy -- absorb PROCSIGNAL_BARRIER_BUFFER_POLICY
+ */
+bool
+ProcessBarrierBufferPolicy(void)
+{
+	RefreshBufferPolicy();
+	return true;
+}
+
+/*
+ * Publish a new policy state, and wait until every process has adopted it.
+ */
+static void
+SetBufferPolicyState(int active, int next)
+{
+	SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
+	StrategyControl->activePolicy = active;
+	StrategyControl->nextPolicy = next;
+	pg_atomic_fetch_add_u32(&StrategyControl->policyGeneration, 1);
+	SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+
+	WaitForProcSignalBarrier(EmitProcSignalBarrier(PROCSIGNAL_BARRIER_BUFFER_POLICY));
+}
+
+/*
+ * StrategyUpdateBufferPolicy -- switch to the policy named by
+ *		buffer_replacement_policy, if that isn't the one in use
+ *
+ * Called by the bgwriter, the only process that switches policies, after it
+ * has reloaded the configuration.  A new policy knows nothing about the
+ * pages in the pool, and starting it cold would throw away the working set,
+ * so it is seeded from the usage counts in the buffer headers, which are kept
+ * up to date whatever policy is in use.  To seed it without missing accesses
+ * that happen meanwhile, we go through three steps:
+ *
+ * 1. Every process is made to report accesses to both the old and the new
+ *	  policy, while the old one keeps choosing the victims.
+ * 2. Once all have done so, the new policy is seeded.  Any access it doesn't
+ *	  find reflected in the buffer headers is reported to it directly.
+ * 3. Every process is made to switch over to the new policy.
+ *
+ * Policies that share their state, like the eaclock variants, hand it over
+ * as is.  The old policy's state is left behind, and is seeded afresh if it
+ * is switched back to.
+ */
+void
+StrategyUpdateBufferPolicy(void)
+{
+	int			from_idx = StrategyControl->activePolicy;
+	int			to_idx;
+	const BufferPolicyRoutine *from;
+	const BufferPolicyRoutine *to;
+
+	from = GetBufferPolicy(from_idx);
+	if (pg_strcasecmp(from->name, buffer_replacement_policy) == 0 &&
+		StrategyControl->nextPolicy < 0)
+		return;
+
+	to_idx = LookupBufferPolicy(buffer_replacement_policy);
+	if (to_idx < 0)
+		elog(ERROR, "buffer replacement policy \"%s\" does not exist",
+			 buffer_replacement_policy);
+	to = GetBufferPolicy(to_idx);
+
+	if (to_idx != from_idx)
+	{
+		SetBufferPolicyState(from_idx, to_idx);
+
+		if (to->seed != NULL &&
+			(to->shmem_init == NULL || to->shmem_init != from->shmem_init))
+			to->seed();
+	}
+
+	SetBufferPolicyState(to_idx, -1);
+
+	if (to_idx != from_idx)
+		ereport(LOG,
+				(errmsg("buffer replacement policy changed from \"%s\" to \"%s\"",
+						from->name, to->name)));
+}
+
+/*
+ * StrategyDescribeBuffers -- the replacement policy's view of every buffer
+ *
+ * Fills info, an array of NBuffers entries, with what the policy choosing
+ * the victims knows about each buffer holding a valid page, and returns the
+ * policy's name.  Nothing is locked, so this is cheap enough to run against
+ * a busy server, at the price of a slightly blurred picture.
+ */
+const char *
+StrategyDescribeBuffers(BufferPolicyBufferInfo *info)
+{
+	const BufferPolicyRoutine *policy;
+
+	StrategyCheckBufferPolicy();
+	policy = SwitchFromPolicy;
+
+	for (int buf_id = 0; buf_id < NBuffers; buf_id++)
+	{
+		info[buf_id].value = -1;
+		info[buf_id].queue = NULL;
+		info[buf_id].position = -1;
+		info[buf_id].age = -1;
+	}
+
+	if (policy->describe != NULL)
+		policy->describe(info);
+
+	/* Whatever the policy remembers about free buffers is stale */
+	for (int buf_id = 0; buf_id < NBuffers; buf_id++)
+	{
+		uint32		buf_state;
+
+		buf_state = pg_atomic_read_u32(&GetBufferDescriptor(buf_id)->state);
+		if (!(buf_state & BM_VALID))
+		{
+			info[buf_id].value = -1;
+			info[buf_id].queue = NULL;
+			info[buf_id].position = -1;
+			info[buf_id].age = -1;
+		}
+	}
+
+	return policy->name;
+}
+
+/*
+ * StrategyRestoreBuffer -- hand a resident page the policy state it had
+ *
+ * info is what StrategyDescribeBuffers() reported for the page, possibly in
+ * an earlier life of the server, under the policy named "policy".  Unless
+ * that's the policy in use, only usage, the page's usage count, is passed
+ * on.  The caller must hold a pin on buf, and must restore the buffers in
+ * decreasing order of their positions, so that list-based policies can
+ * rebuild their order by moving each to the head.
+ */
+void
+StrategyRestoreBuffer(BufferDesc *buf, int usage, const char *policy,
+					  const BufferPolicyBufferInfo *info)
+{
+	BufferPolicyBufferInfo unknown = {-1, NULL, -1, -1};
+
+	StrategyCheckBufferPolicy();
+
+	/* While switching policies, the new one's seed will take care of it */
+	if (BufferPolicy->restore == NULL)
+		return;
+
+	if (policy == NULL || strcmp(policy, BufferPolicy->name) != 0)
+		info = &unknown;
+
+	BufferPolicy->restore(buf, usage, info);
+}
 
 /* ----------------------------------------------------------------
  *				Backend-private buffer ring management
@@ -45,8 +45,6 @@ BufferDesc *LocalBufferDescriptors = NULL;
 Block	   *LocalBufferBlockPointers = NULL;
 int32	   *LocalRefCount = NULL;
 
-static int	nextFreeLocalBufId = 0;
-
 static HTAB *LocalBufHash = NULL;
 
 /* number of local buffers pinned at least once */
@@ -166,6 +164,8 @@ LocalBufferAlloc(SMgrRelation smgr, ForkNumber forkNum, BlockNumber blockNum,
 		buf_state |= BM_TAG_VALID | BUF_USAGECOUNT_ONE;
 		pg_atomic_unlocked_write_u32(&bufHdr->state, buf_state);
 
+		LocalBufferPolicyLoad(bufid);
+
 		*foundPtr = false;
 	}
 
@@ -176,48 +176,20 @@ static Buffer
 GetLocalVictimBuffer(void)
 {
 	int			victim_bufid;
-	int			trycounter;
 	uint32		buf_state;
 	BufferDesc *bufHdr;
 
 	ResourceOwnerEnlargeBuffers(CurrentResourceOwner);
 
 	/*
-	 * Need to get a new buffer.  We use a clock sweep algorithm (essentially
-	 * the same as what freelist.c does now...)
+	 * Need to get a new buffer.  The replacement policy chosen by
+	 * temp_buffer_replacement_policy picks an unpinned one (see
+	 * localpolicy.c).
 	 */
-	trycounter = NLocBuffer;
-	for (;;)
-	{
-		victim_bufid = nextFreeLocalBufId;
-
-		if (++nextFreeLocalBufId >= NLocBuffer)
-			nextFreeLocalBufId = 0;
-
-		bufHdr = GetLocalBufferDescriptor(victim_bufid);
-
-		if (LocalRefCount[victim_bufid] == 0)
-		{
-			buf_state = pg_atomic_read_u32(&bufHdr->state);
-
-			if (BUF_STATE_GET_USAGECOUNT(buf_state) > 0)
-			{
-				buf_state -= BUF_USAGECOUNT_ONE;
-				pg_atomic_unlocked_write_u32(&bufHdr->state, buf_state);
-				trycounter = NLocBuffer;
-			}
-			else
-			{
-				/* Found a usable buffer */
-				PinLocalBuffer(bufHdr, false);
-				break;
-			}
-		}
-		else if (--trycounter == 0)
-			ereport(ERROR,
-					(errcode(ERRCODE_INSUFFICIENT_RESOURCES),
-					 errmsg("no empty local buffer available")));
-	}
+	victim_bufid = LocalBufferPolicyGetVictim();
+	bufHdr = GetLocalBufferDescriptor(victim_bufid);
+	PinLocalBuffer(bufHdr, false);
+	buf_state = pg_atomic_read_u32(&bufHdr->state);
 
 	/*
 	 * lazy memory allocation: allocate space on first use of a buffer.
@@ -381,6 +353,7 @@ ExtendBufferedRelLocal(BufferManagerRelation bmr,
 			uint32		buf_state;
 
 			UnpinLocalBuffer(BufferDescriptorGetBuffer(victim_buf_hdr));
+			LocalBufferPolicyInvalidate(victim_buf_id);
 
 			existing_hdr = GetLocalBufferDescriptor(hresult->id);
 			PinLocalBuffer(existing_hdr, false);
@@ -405,6 +378,8 @@ ExtendBufferedRelLocal(BufferManagerRelation bmr,
 			pg_atomic_unlocked_write_u32(&victim_buf_hdr->state, buf_state);
 
 			hresult->id = victim_buf_id;
+
+			LocalBufferPolicyLoad(victim_buf_id);
 		}
 	}
 
@@ -517,6 +492,7 @@ DropRelationLocalBuffers(RelFileLocator rlocator, ForkNumber forkNum,
 			buf_state &= ~BUF_FLAG_MASK;
 			buf_state &= ~BUF_USAGECOUNT_MASK;
 			pg_atomic_unlocked_write_u32(&bufHdr->state, buf_state);
+			LocalBufferPolicyInvalidate(i);
 		}
 	}
 }
@@ -561,6 +537,7 @@ DropRelationAllLocalBuffers(RelFileLocator rlocator)
 			buf_state &= ~BUF_FLAG_MASK;
 			buf_state &= ~BUF_USAGECOUNT_MASK;
 			pg_atomic_unlocked_write_u32(&bufHdr->state, buf_state);
+			LocalBufferPolicyInvalidate(i);
 		}
 	}
 }
@@ -600,8 +577,6 @@ InitLocalBuffers(void)
 				(errcode(ERRCODE_OUT_OF_MEMORY),
 				 errmsg("out of memory")));
 
-	nextFreeLocalBufId = 0;
-
 	/* initialize fields that need to start off nonzero */
 	for (i = 0; i < nbufs; i++)
 	{
@@ -635,6 +610,9 @@ InitLocalBuffers(void)
 	if (!LocalBufHash)
 		elog(ERROR, "could not initialize local buffer hash table");
 
+	/* Set up the replacement policy, with every buffer free */
+	LocalBufferPolicyInit(nbufs);
+
 	/* Initialization done, mark buffers allocated */
 	NLocBuffer = nbufs;
 }
@@ -656,11 +634,14 @@ PinLocalBuffer(BufferDesc *buf_hdr, bool adjust_usagecount)
 	if (LocalRefCount[bufid] == 0)
 	{
 		NLocalPinnedBuffers++;
-		if (adjust_usagecount &&
-			BUF_STATE_GET_USAGECOUNT(buf_state) < BM_MAX_USAGE_COUNT)
+		if (adjust_usagecount)
 		{
-			buf_state += BUF_USAGECOUNT_ONE;
-			pg_atomic_unlocked_write_u32(&buf_hdr->state, buf_state);
+			if (BUF_STATE_GET_USAGECOUNT(buf_state) < BM_MAX_USAGE_COUNT)
+			{
+				buf_state += BUF_USAGECOUNT_ONE;
+				pg_atomic_unlocked_write_u32(&buf_hdr->state, buf_state);
+			}
+			LocalBufferPolicyHit(bufid);
 		}
 	}
 	LocalRefCount[bufid]++;
@@ -0,0 +1,242 @@
+/*-------------------------------------------------------------------------
+ *
+ * localpolicy.c
+ *	  replacement policies for local buffers
+ *
+ * Local buffers can be replaced under the same policies as shared buffers,
+ * chosen by temp_buffer_replacement_policy.  Since local buffers are only
+ * ever touched by the backend that owns them, they use the single-threaded
+ * versions of the policies in common/bufpolicy.c, which pg_bufsim simulates
+ * shared buffers with too.  Policies registered by extensions apply to
+ * shared buffers only.
+ *
+ * Buffers that hold no page are kept on a free stack, which is used before
+ * the policy is asked for a victim, whatever the policy.  Every buffer
+ * holding a page is known to the policy, which is told about it by
+ * LocalBufferPolicyLoad() and forgets it again when it's invalidated.  A
+ * buffer handed out to be reused stays where it is, on the free stack or
+ * known to the policy, until its new page is loaded, so that it's not lost
+ * if writing out the old page fails.
+ *
+ * The policy's state is set up when the local buffers are first used, and
+ * rebuilt from the buffers' usage counts, which PinLocalBuffer() keeps up
+ * whatever the policy, when the setting has changed since.  Should that
+ * fail, nothing is tracked until the next attempt, which starts over from
+ * the buffer headers again.
+ *
+ * Portions Copyright (c) 1996-2023, PostgreSQL Global Development Group
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/storage/buffer/localpolicy.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "common/bufpolicy.h"
+#include "common/hashfn.h"
+#include "common/pg_prng.h"
+#include "storage/buf_internals.h"
+#include "storage/bufmgr.h"
+#include "utils/memutils.h"
+
+/* GUC variable */
+int			temp_buffer_replacement_policy = LOCAL_BUFFER_POLICY_CLOCKSWEEP;
+
+/* the policy in use, as a LocalBufferPolicyType, or -1 before the first use */
+static int	LocalPolicyType = -1;
+static BufPolicyPool *LocalPolicy = NULL;
+static BufPolicyOptions LocalPolicyOptions;
+static MemoryContext LocalPolicyContext = NULL;
+static int	LocalPolicyNBuffers = 0;
+
+/* buffers holding no page */
+static int *LocalFreeStack = NULL;
+static int	LocalNumFree = 0;
+static bool *LocalIsFree = NULL;
+
+static bool
+LocalBufferIsPinned(int bufid, void *arg)
+{
+	return LocalRefCount[bufid] != 0;
+}
+
+static uint32
+LocalBufferPageHash(int bufid, void *arg)
+{
+	return tag_hash(&GetLocalBufferDescriptor(bufid)->tag, sizeof(BufferTag));
+}
+
+static inline uint32
+LocalBufferGetState(int bufid)
+{
+	return pg_atomic_read_u32(&GetLocalBufferDescriptor(bufid)->state);
+}
+
+static inline void
+LocalFreePush(int bufid)
+{
+	if (!LocalIsFree[bufid])
+	{
+		LocalIsFree[bufid] = true;
+		LocalFreeStack[LocalNumFree++] = bufid;
+	}
+}
+
+/* Take a buffer off the free stack; it's near the top, if not on top */
+static inline void
+LocalFreeRemove(int bufid)
+{
+	int			i = LocalNumFree;
+
+	if (!LocalIsFree[bufid])
+		return;
+	while (LocalFreeStack[--i] != bufid)
+		;
+	memmove(&LocalFreeStack[i], &LocalFreeStack[i + 1],
+			(LocalNumFree - i - 1) * sizeof(int));
+	LocalNumFree--;
+	LocalIsFree[bufid] = false;
+}
+
+/*
+ * Set up the policy chosen by temp_buffer_replacement_policy, and tell it
+ * about the pages in the local buffers, hottest last.
+ */
+static void
+LocalBufferPolicySetup(void)
+{
+	MemoryContext oldcontext;
+	BufPolicyPool *policy;
+
+	if (LocalPolicyContext == NULL)
+		LocalPolicyContext = AllocSetContextCreate(TopMemoryContext,
+												   "LocalBufferPolicy",
+												   ALLOCSET_DEFAULT_SIZES);
+	else
+		MemoryContextReset(LocalPolicyContext);
+
+	LocalPolicy = NULL;
+	LocalPolicyType = -1;
+
+	LocalPolicyOptions.max_usage = BM_MAX_USAGE_COUNT;
+	LocalPolicyOptions.sample_size = hyperbolic_sample_size;
+	LocalPolicyOptions.priority = hyperbolic_priority;
+	LocalPolicyOptions.is_pinned = LocalBufferIsPinned;
+	LocalPolicyOptions.page_hash = LocalBufferPageHash;
+	LocalPolicyOptions.arg = NULL;
+
+	oldcontext = MemoryContextSwitchTo(LocalPolicyContext);
+	LocalFreeStack = palloc_array(int, LocalPolicyNBuffers);
+	LocalIsFree = palloc0_array(bool, LocalPolicyNBuffers);
+	LocalNumFree = 0;
+	policy = BufPolicyCreate(temp_buffer_replacement_policy,
+							 LocalPolicyNBuffers, &LocalPolicyOptions,
+							 pg_prng_uint64(&pg_global_prng_state));
+	MemoryContextSwitchTo(oldcontext);
+
+	/* free buffers are handed out lowest first, as their memory is lazy */
+	for (int bufid = LocalPolicyNBuffers - 1; bufid >= 0; bufid--)
+	{
+		if (!(LocalBufferGetState(bufid) & BM_TAG_VALID))
+			LocalFreePush(bufid);
+	}
+
+	for (int usage = 0; usage <= BM_MAX_USAGE_COUNT; usage++)
+	{
+		for (int bufid = 0; bufid < LocalPolicyNBuffers; bufid++)
+		{
+			uint32		buf_state = LocalBufferGetState(bufid);
+
+			if ((buf_state & BM_TAG_VALID) &&
+				BUF_STATE_GET_USAGECOUNT(buf_state) == usage)
+				BufPolicySeed(policy, bufid, usage);
+		}
+	}
+
+	LocalPolicy = policy;
+	LocalPolicyType = temp_buffer_replacement_policy;
+}
+
+/*
+ * LocalBufferPolicyInit -- set up the replacement policy for nbufs local
+ * buffers, which hold no pages yet
+ */
+void
+LocalBufferPolicyInit(int nbufs)
+{
+	LocalPolicyNBuffers = nbufs;
+	LocalBufferPolicySetup();
+}
+
+/*
+ * LocalBufferPolicyGetVictim -- choose an unpinned local buffer to reuse
+ *
+ * A buffer holding no page is used if there is one; otherwise the policy
+ * picks one.  The buffer is returned unpinned, and the caller evicts the
+ * page it holds.  A free buffer stays on the free stack until its new page
+ * is loaded, skipped meanwhile since the caller pins it.
+ */
+int
+LocalBufferPolicyGetVictim(void)
+{
+	int			bufid;
+
+	if (LocalPolicyType != temp_buffer_replacement_policy)
+		LocalBufferPolicySetup();
+
+	for (int i = LocalNumFree - 1; i >= 0; i--)
+	{
+		bufid = LocalFreeStack[i];
+		if (!LocalBufferIsPinned(bufid, NULL))
+			return bufid;
+	}
+
+	/* these can change without the policy being set up again */
+	LocalPolicyOptions.sample_size = hyperbolic_sample_size;
+	LocalPolicyOptions.priority = hyperbolic_priority;
+
+	bufid = BufPolicyGetVictim(LocalPolicy);
+	if (bufid < 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_INSUFFICIENT_RESOURCES),
+				 errmsg("no empty local buffer available")));
+
+	return bufid;
+}
+
+/*
+ * LocalBufferPolicyHit -- report an access to the page in a local buffer
+ */
+void
+LocalBufferPolicyHit(int bufid)
+{
+	if (LocalPolicy)
+		BufPolicyHit(LocalPolicy, bufid);
+}
+
+/*
+ * LocalBufferPolicyLoad -- report that a local buffer now holds a new page
+ */
+void
+LocalBufferPolicyLoad(int bufid)
+{
+	if (LocalPolicy == NULL)
+		return;
+	LocalFreeRemove(bufid);
+	BufPolicyLoad(LocalPolicy, bufid);
+}
+
+/*
+ * LocalBufferPolicyInvalidate -- report that a local buffer holds no page
+ * anymore, and can be reused first
+ */
+void
+LocalBufferPolicyInvalidate(int bufid)
+{
+	if (LocalPolicy == NULL)
+		return;
+	BufPolicyInvalidate(LocalPolicy, bufid);
+	LocalFreePush(bufid);
+}
@@ -78,9 +78,6 @@
 #include "utils/timeout.h"
 #include "utils/timestamp.h"
 
-// change 修改
-#include "storage/buf_internals.h"
-
 /* ----------------
  *		global variables
  * ----------------
@@ -4571,48 +4568,6 @@ PostgresMain(const char *dbname, const char *username)
 		 */
 		firstchar = ReadCommand(&input_message);
 
-		// change
-		char *algorithm="algorithm";
-
-		// algorithm s
-		// algorithm clock
-		// algorithm ea
-		// algorithm random
-		// algorithm ew
-		// algorithm ed
-        for(uint16 i=0; i<20; i++)
-        {
-			if(input_message.data[i]!=algorithm[i]){
-				break;
-			}
-			if(i==8){
-				char tmp = input_message.data[10];
-				elog(LOG, "Algorithm-> = %c", tmp);
-				if(tmp =='f')
-				{
-					elog(LOG, "Algorithm->GetFromFreelist = %d", Algorithm->GetFromFreelist);
-					elog(LOG, "Algorithm->GetFromCLOCK = %d", Algorithm->GetFromCLOCK);
-					elog(LOG, "Algorithm->GetFromCLOCKSWEEP = %d", Algorithm->GetFromCLOCKSWEEP);
-					elog(LOG, "Algorithm->GetFromEAclock = %d", Algorithm->GetFromEAclock);
-					elog(LOG, "Algorithm->GetFromLRU = %d", Algorithm->GetFromLRU);
-					elog(LOG, "Algorithm->GetFromHyperbolic = %d", Algorithm->GetFromHyperbolic);
-					elog(LOG, "Algorithm->GetFromRandom = %d", Algorithm->GetFromRandom);
-					elog(LOG, "Algorithm->StrategyAccessBuffer = %d", Algorithm->StrategyAccessBuffer);
-					//elog(LOG, "Algorithm->EAclockFdwAgeTimes = %d", Algorithm->EAclockFdwAgeTimes);
-				}else if(tmp == 'p')
-				{
-					readLRU();
-				}
-				else
-				{
-					Algorithm->algorithm_first = tmp;
-					//Algorithm->algorithm_second = tmp2;
-					elog(LOG, "Algorithm->algorithm_first = %c", Algorithm->algorithm_first);
-				}
-				break;
-			}
-        }
-
 		/*
 		 * (4) turn off the idle-in-transaction and idle-session timeouts if
 		 * active.  We do this before step (5) so that any last-moment timeout
@@ -69,6 +69,7 @@
  * Each statistics kind is handled in a dedicated file:
  * - pgstat_archiver.c
  * - pgstat_bgwriter.c
+ * - pgstat_buffer_policy.c
  * - pgstat_checkpointer.c
  * - pgstat_database.c
  * - pgstat_function.c
@@ -358,6 +359,15 @@ static const PgStat_KindInfo pgstat_kind_infos[PGSTAT_NUM_KINDS] = {
 		.snapshot_cb = pgstat_bgwriter_snapshot_cb,
 	},
 
+	[PGSTAT_KIND_BUFFER_POLICY] = {
+		.name = "buffer_policy",
+
+		.fixed_amount = true,
+
+		.reset_all_cb = pgstat_buffer_policy_reset_all_cb,
+		.snapshot_cb = pgstat_buffer_policy_snapshot_cb,
+	},
+
 	[PGSTAT_KIND_CHECKPOINTER] = {
 		.name = "checkpointer",
 
@@ -601,6 +611,7 @@ pgstat_report_stat(bool force)
 	if (dlist_is_empty(&pgStatPending) &&
 		!have_iostats &&
 		!have_slrustats &&
+		!have_bufferpolicystats &&
 		!pgstat_have_pending_wal())
 	{
 		Assert(pending_since == 0);
@@ -666,6 +677,9 @@ pgstat_report_stat(bool force)
 	/* flush SLRU stats */
 	partial_flush |= pgstat_slru_flush(nowait);
 
+	/* flush buffer replacement policy stats */
+	partial_flush |= pgstat_buffer_policy_flush(nowait);
+
 	last_flush = now;
 
 	/*
@@ -1358,6 +1372,12 @@ pgstat_write_statsfile(void)
 	pgstat_build_snapshot_fixed(PGSTAT_KIND_BGWRITER);
 	write_chunk_s(fpout, &pgStatLocal.snapshot.bgwriter);
 
+	/*
+	 * Write buffer replacement policy stats struct
+	 */
+	pgstat_build_snapshot_fixed(PGSTAT_KIND_BUFFER_POLICY);
+	write_chunk_s(fpout, &pgStatLocal.snapshot.buffer_policy);
+
 	/*
 	 * Write checkpointer stats struct
 	 */
@@ -1538,6 +1558,12 @@ pgstat_read_statsfile(void)
 	if (!read_chunk_s(fpin, &shmem->bgwriter.stats))
 		goto error;
 
+	/*
+	 * Read buffer replacement policy stats struct
+	 */
+	if (!read_chunk_s(fpin, &shmem->buffer_policy.stats))
+		goto error;
+
 	/*
 	 * Read checkpointer stats struct
 	 */
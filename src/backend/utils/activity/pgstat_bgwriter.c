@@ -24,7 +24,7 @@ PgStat_BgWriterStats PendingBgWriterStats = {0};
 
 
 /*
- * Report bgwriter and IO statistics
+ * Report bgwriter, buffer replacement policy and IO statistics
  */
 void
 pgstat_report_bgwriter(void)
@@ -35,6 +35,12 @@ pgstat_report_bgwriter(void)
 	Assert(!pgStatLocal.shmem->is_shutdown);
 	pgstat_assert_is_up();
 
+	/*
+	 * The bgwriter runs the replacement policy to fill the victim queue even
+	 * when it has nothing to write.
+	 */
+	pgstat_buffer_policy_flush(false);
+
 	/*
 	 * This function can be called even if nothing at all has happened. In
 	 * this case, avoid unnecessarily modifying the stats entry.
@@ -0,0 +1,261 @@
+/* -------------------------------------------------------------------------
+ *
+ * pgstat_buffer_policy.c
+ *	  Implementation of buffer replacement policy statistics.
+ *
+ * This file contains the implementation of buffer replacement policy
+ * statistics. It is kept separate from pgstat.c to enforce the line between
+ * the statistics access / storage implementation and the details about
+ * individual types of statistics.
+ *
+ * Counts are attributed to the policy that was active when they happened.
+ * They are only taken when a buffer is allocated, never on a buffer hit.
+ *
+ * Copyright (c) 2001-2023, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *	  src/backend/utils/activity/pgstat_buffer_policy.c
+ * -------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "utils/pgstat_internal.h"
+#include "utils/timestamp.h"
+
+
+static inline PgStat_BufferPolicyStats *get_buffer_policy_entry(int policy_idx);
+
+
+/*
+ * Buffer replacement policy statistics counts waiting to be flushed out.
+ * Entries are one-to-one with buffer_policy_names[].  They are counted while
+ * holding a buffer header spinlock, so we use static memory in order to
+ * avoid memory allocation.
+ */
+static PgStat_BufferPolicyStats pending_BufferPolicyStats[BUFFER_POLICY_NUM_ELEMENTS];
+bool		have_bufferpolicystats = false;
+
+
+/*
+ * Buffer replacement policy statistics count accumulation functions ---
+ * called from freelist.c
+ */
+
+void
+pgstat_count_buffer_policy_freelist_alloc(int policy_idx)
+{
+	get_buffer_policy_entry(policy_idx)->freelist_allocs += 1;
+}
+
+/*
+ * Count a buffer allocation that evicted the policy's victim, either chosen
+ * right away or earlier by the bgwriter ("queued").
+ */
+void
+pgstat_count_buffer_policy_eviction(int policy_idx, bool queued)
+{
+	PgStat_BufferPolicyStats *entry = get_buffer_policy_entry(policy_idx);
+
+	entry->evictions += 1;
+	if (queued)
+		entry->queue_allocs += 1;
+}
+
+/*
+ * Count a victim search, having looked at "scanned" buffers, of which
+ * "pinned" were skipped because they were pinned.
+ */
+void
+pgstat_count_buffer_policy_search(int policy_idx, int scanned, int pinned)
+{
+	PgStat_BufferPolicyStats *entry = get_buffer_policy_entry(policy_idx);
+
+	entry->searches += 1;
+	entry->buffers_scanned += scanned;
+	entry->pinned_skips += pinned;
+}
+
+void
+pgstat_count_buffer_policy_clock_pass(int policy_idx)
+{
+	get_buffer_policy_entry(policy_idx)->clock_passes += 1;
+}
+
+/*
+ * Record the end of an EAclock adaptation period.
+ */
+void
+pgstat_count_buffer_policy_period(int policy_idx, int weight,
+								  double hit_ratio, bool aged)
+{
+	PgStat_BufferPolicyStats *entry = get_buffer_policy_entry(policy_idx);
+	PgStat_EAclockPeriod *period;
+
+	period = &entry->eaclock_history[entry->eaclock_periods %
+									 PGSTAT_EACLOCK_HISTORY_SIZE];
+	period->weight = weight;
+	period->hit_ratio = hit_ratio;
+	entry->eaclock_periods += 1;
+	if (aged)
+		entry->eaclock_agings += 1;
+}
+
+/*
+ * Support function for the SQL-callable pgstat* functions. Returns
+ * a pointer to the buffer replacement policy statistics struct.
+ */
+PgStat_BufferPolicyStats *
+pgstat_fetch_buffer_policy(void)
+{
+	pgstat_snapshot_fixed(PGSTAT_KIND_BUFFER_POLICY);
+
+	return pgStatLocal.snapshot.buffer_policy;
+}
+
+/*
+ * Returns the policy name for an index. The index may be above
+ * BUFFER_POLICY_NUM_ELEMENTS, in which case this returns NULL. This allows
+ * writing code that does not know the number of entries in advance.
+ */
+const char *
+pgstat_get_buffer_policy_name(int policy_idx)
+{
+	if (policy_idx < 0 || policy_idx >= BUFFER_POLICY_NUM_ELEMENTS)
+		return NULL;
+
+	return buffer_policy_names[policy_idx];
+}
+
+/*
+ * Determine index of entry for a policy with a given name. If there's no
+ * exact match, returns index of the last "other" entry used for policies
+ * registered by extensions.
+ */
+int
+pgstat_get_buffer_policy_index(const char *name)
+{
+	int			i;
+
+	for (i = 0; i < BUFFER_POLICY_NUM_ELEMENTS; i++)
+	{
+		if (strcmp(buffer_policy_names[i], name) == 0)
+			return i;
+	}
+
+	/* return index of the last entry (which is the "other" one) */
+	return (BUFFER_POLICY_NUM_ELEMENTS - 1);
+}
+
+/*
+ * Flush out locally pending buffer replacement policy stats entries
+ *
+ * If nowait is true, this function returns true if the lock could not be
+ * acquired. Otherwise return false.
+ */
+bool
+pgstat_buffer_policy_flush(bool nowait)
+{
+	PgStatShared_BufferPolicy *stats_shmem = &pgStatLocal.shmem->buffer_policy;
+	int			i;
+
+	if (!have_bufferpolicystats)
+		return false;
+
+	if (!nowait)
+		LWLockAcquire(&stats_shmem->lock, LW_EXCLUSIVE);
+	else if (!LWLockConditionalAcquire(&stats_shmem->lock, LW_EXCLUSIVE))
+		return true;
+
+	for (i = 0; i < BUFFER_POLICY_NUM_ELEMENTS; i++)
+	{
+		PgStat_BufferPolicyStats *sharedent = &stats_shmem->stats[i];
+		PgStat_BufferPolicyStats *pendingent = &pending_BufferPolicyStats[i];
+		PgStat_Counter first;
+
+#define BUFFER_POLICY_ACC(fld) sharedent->fld += pendingent->fld
+		BUFFER_POLICY_ACC(freelist_allocs);
+		BUFFER_POLICY_ACC(evictions);
+		BUFFER_POLICY_ACC(queue_allocs);
+		BUFFER_POLICY_ACC(searches);
+		BUFFER_POLICY_ACC(buffers_scanned);
+		BUFFER_POLICY_ACC(pinned_skips);
+		BUFFER_POLICY_ACC(clock_passes);
+		BUFFER_POLICY_ACC(eaclock_agings);
+#undef BUFFER_POLICY_ACC
+
+		/*
+		 * Append the periods this backend ended to the shared history.
+		 * Another backend may have ended later periods and flushed them
+		 * first, so the history is only approximately in order.
+		 */
+		first = Max(pendingent->eaclock_periods - PGSTAT_EACLOCK_HISTORY_SIZE, 0);
+		sharedent->eaclock_periods += first;
+		for (PgStat_Counter p = first; p < pendingent->eaclock_periods; p++)
+		{
+			sharedent->eaclock_history[sharedent->eaclock_periods %
+									   PGSTAT_EACLOCK_HISTORY_SIZE] =
+				pendingent->eaclock_history[p % PGSTAT_EACLOCK_HISTORY_SIZE];
+			sharedent->eaclock_periods++;
+		}
+	}
+
+	/* done, clear the pending entry */
+	MemSet(pending_BufferPolicyStats, 0, sizeof(pending_BufferPolicyStats));
+
+	LWLockRelease(&stats_shmem->lock);
+
+	have_bufferpolicystats = false;
+
+	return false;
+}
+
+void
+pgstat_buffer_policy_reset_all_cb(TimestampTz ts)
+{
+	PgStatShared_BufferPolicy *stats_shmem = &pgStatLocal.shmem->buffer_policy;
+
+	LWLockAcquire(&stats_shmem->lock, LW_EXCLUSIVE);
+
+	for (int i = 0; i < BUFFER_POLICY_NUM_ELEMENTS; i++)
+	{
+		memset(&stats_shmem->stats[i], 0, sizeof(PgStat_BufferPolicyStats));
+		stats_shmem->stats[i].stat_reset_timestamp = ts;
+	}
+
+	LWLockRelease(&stats_shmem->lock);
+}
+
+void
+pgstat_buffer_policy_snapshot_cb(void)
+{
+	PgStatShared_BufferPolicy *stats_shmem = &pgStatLocal.shmem->buffer_policy;
+
+	LWLockAcquire(&stats_shmem->lock, LW_SHARED);
+
+	memcpy(pgStatLocal.snapshot.buffer_policy, &stats_shmem->stats,
+		   sizeof(stats_shmem->stats));
+
+	LWLockRelease(&stats_shmem->lock);
+}
+
+/*
+ * Returns pointer to the pending entry of the given policy.
+ */
+static inline PgStat_BufferPolicyStats *
+get_buffer_policy_entry(int policy_idx)
+{
+	pgstat_assert_is_up();
+
+	/*
+	 * The postmaster never allocates buffers; if it counted anything, the
+	 * counts would be duplicated into child processes via fork().
+	 */
+	Assert(IsUnderPostmaster || !IsPostmasterEnvironment);
+
+	Assert((policy_idx >= 0) && (policy_idx < BUFFER_POLICY_NUM_ELEMENTS));
+
+	have_bufferpolicystats = true;
+
+	return &pending_BufferPolicyStats[policy_idx];
+}
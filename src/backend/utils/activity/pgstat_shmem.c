@@ -199,6 +199,7 @@ StatsShmemInit(void)
 		/* initialize fixed-numbered stats */
 		LWLockInitialize(&ctl->archiver.lock, LWTRANCHE_PGSTATS_DATA);
 		LWLockInitialize(&ctl->bgwriter.lock, LWTRANCHE_PGSTATS_DATA);
+		LWLockInitialize(&ctl->buffer_policy.lock, LWTRANCHE_PGSTATS_DATA);
 		LWLockInitialize(&ctl->checkpointer.lock, LWTRANCHE_PGSTATS_DATA);
 		LWLockInitialize(&ctl->slru.lock, LWTRANCHE_PGSTATS_DATA);
 		LWLockInitialize(&ctl->wal.lock, LWTRANCHE_PGSTATS_DATA);
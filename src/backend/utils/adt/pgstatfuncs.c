@@ -30,6 +30,7 @@
 #include "storage/proc.h"
 #include "storage/procarray.h"
 #include "utils/acl.h"
+#include "utils/array.h"
 #include "utils/builtins.h"
 #include "utils/inet.h"
 #include "utils/timestamp.h"
@@ -1567,6 +1568,98 @@ pg_stat_get_slru(PG_FUNCTION_ARGS)
 	return (Datum) 0;
 }
 
+/*
+ * Returns statistics of the buffer replacement policies.
+ */
+Datum
+pg_stat_get_buffer_policy(PG_FUNCTION_ARGS)
+{
+#define PG_STAT_GET_BUFFER_POLICY_COLS	16
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	int			i;
+	PgStat_BufferPolicyStats *stats;
+
+	InitMaterializedSRF(fcinfo, 0);
+
+	/* request buffer policy stats from the cumulative stats system */
+	stats = pgstat_fetch_buffer_policy();
+
+	for (i = 0;; i++)
+	{
+		/* for each row */
+		Datum		values[PG_STAT_GET_BUFFER_POLICY_COLS] = {0};
+		bool		nulls[PG_STAT_GET_BUFFER_POLICY_COLS] = {0};
+		PgStat_BufferPolicyStats *stat;
+		const char *name;
+
+		name = pgstat_get_buffer_policy_name(i);
+
+		if (!name)
+			break;
+
+		stat = &stats[i];
+
+		values[0] = PointerGetDatum(cstring_to_text(name));
+		values[1] = Int64GetDatum(stat->freelist_allocs);
+		values[2] = Int64GetDatum(stat->evictions);
+		values[3] = Int64GetDatum(stat->queue_allocs);
+		values[4] = Int64GetDatum(stat->searches);
+		values[5] = Int64GetDatum(stat->buffers_scanned);
+		if (stat->searches > 0)
+			values[6] = Float8GetDatum((double) stat->buffers_scanned /
+									   stat->searches);
+		else
+			nulls[6] = true;
+		values[7] = Int64GetDatum(stat->pinned_skips);
+		values[8] = Int64GetDatum(stat->clock_passes);
+		values[9] = Int64GetDatum(stat->eaclock_periods);
+		values[10] = Int64GetDatum(stat->eaclock_agings);
+
+		if (stat->eaclock_periods > 0)
+		{
+			Datum		weights[PGSTAT_EACLOCK_HISTORY_SIZE];
+			Datum		hit_ratios[PGSTAT_EACLOCK_HISTORY_SIZE];
+			int			nperiods;
+			PgStat_Counter first;
+
+			/* oldest period first */
+			nperiods = Min(stat->eaclock_periods, PGSTAT_EACLOCK_HISTORY_SIZE);
+			first = stat->eaclock_periods - nperiods;
+			for (int j = 0; j < nperiods; j++)
+			{
+				PgStat_EAclockPeriod *period;
+
+				period = &stat->eaclock_history[(first + j) %
+												PGSTAT_EACLOCK_HISTORY_SIZE];
+				weights[j] = Int32GetDatum(period->weight);
+				hit_ratios[j] = Float8GetDatum(period->hit_ratio);
+			}
+
+			values[11] = weights[nperiods - 1];
+			values[12] = hit_ratios[nperiods - 1];
+			values[13] = PointerGetDatum(construct_array_builtin(weights,
+																 nperiods,
+																 INT4OID));
+			values[14] = PointerGetDatum(construct_array_builtin(hit_ratios,
+																 nperiods,
+																 FLOAT8OID));
+		}
+		else
+		{
+			nulls[11] = true;
+			nulls[12] = true;
+			nulls[13] = true;
+			nulls[14] = true;
+		}
+
+		values[15] = TimestampTzGetDatum(stat->stat_reset_timestamp);
+
+		tuplestore_putvalues(rsinfo->setResult, rsinfo->setDesc, values, nulls);
+	}
+
+	return (Datum) 0;
+}
+
 #define PG_STAT_GET_XACT_RELENTRY_INT64(stat)			\
 Datum													\
 CppConcat(pg_stat_get_xact_,stat)(PG_FUNCTION_ARGS)		\
@@ -1753,6 +1846,8 @@ pg_stat_reset_shared(PG_FUNCTION_ARGS)
 
 	if (strcmp(target, "archiver") == 0)
 		pgstat_reset_of_kind(PGSTAT_KIND_ARCHIVER);
+	else if (strcmp(target, "buffer_policy") == 0)
+		pgstat_reset_of_kind(PGSTAT_KIND_BUFFER_POLICY);
 	else if (strcmp(target, "bgwriter") == 0)
 	{
 		/*
@@ -1772,7 +1867,7 @@ pg_stat_reset_shared(PG_FUNCTION_ARGS)
 		ereport(ERROR,
 				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
 				 errmsg("unrecognized reset target: \"%s\"", target),
-				 errhint("Target must be \"archiver\", \"bgwriter\", \"io\", \"recovery_prefetch\", or \"wal\".")));
+				 errhint("Target must be \"archiver\", \"bgwriter\", \"buffer_policy\", \"io\", \"recovery_prefetch\", or \"wal\".")));
 
 	PG_RETURN_VOID();
 }
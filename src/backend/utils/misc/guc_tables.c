@@ -28,6 +28,7 @@
 
 #include "access/commit_ts.h"
 #include "access/gin.h"
+#include "access/slru.h"
 #include "access/toast_compression.h"
 #include "access/twophase.h"
 #include "access/xlog_internal.h"
@@ -66,6 +67,7 @@
 #include "replication/slot.h"
 #include "replication/syncrep.h"
 #include "storage/bufmgr.h"
+#include "storage/buftrace.h"
 #include "storage/large_object.h"
 #include "storage/pg_shmem.h"
 #include "storage/predicate.h"
@@ -470,6 +472,27 @@ static const struct config_enum_entry wal_compression_options[] = {
 	{NULL, 0, false}
 };
 
+static const struct config_enum_entry hyperbolic_priority_options[] = {
+	{"hyperbolic", HYPERBOLIC_PRIORITY_HYPERBOLIC, false},
+	{"lfu", HYPERBOLIC_PRIORITY_LFU, false},
+	{"fifo", HYPERBOLIC_PRIORITY_FIFO, false},
+	{NULL, 0, false}
+};
+
+static const struct config_enum_entry temp_buffer_replacement_policy_options[] = {
+	{"clocksweep", LOCAL_BUFFER_POLICY_CLOCKSWEEP, false},
+	{"clock", LOCAL_BUFFER_POLICY_CLOCK, false},
+	{"lru", LOCAL_BUFFER_POLICY_LRU, false},
+	{"random", LOCAL_BUFFER_POLICY_RANDOM, false},
+	{"hyperbolic", LOCAL_BUFFER_POLICY_HYPERBOLIC, false},
+	{"eaclock", LOCAL_BUFFER_POLICY_EACLOCK, false},
+	{"eaclock_fdw", LOCAL_BUFFER_POLICY_EACLOCK_FDW, false},
+	{"eaclock_fwa", LOCAL_BUFFER_POLICY_EACLOCK_FWA, false},
+	{"arc", LOCAL_BUFFER_POLICY_ARC, false},
+	{"s3fifo", LOCAL_BUFFER_POLICY_S3FIFO, false},
+	{NULL, 0, false}
+};
+
 /*
  * Options for enum values stored in other modules
  */
@@ -477,6 +500,7 @@ extern const struct config_enum_entry wal_level_options[];
 extern const struct config_enum_entry archive_mode_options[];
 extern const struct config_enum_entry recovery_target_action_options[];
 extern const struct config_enum_entry sync_method_options[];
+extern const struct config_enum_entry wal_io_method_options[];
 extern const struct config_enum_entry dynamic_shared_memory_options[];
 
 /*
@@ -1188,6 +1212,16 @@ struct config_bool ConfigureNamesBool[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"wal_group_commit", PGC_SIGHUP, WAL_SETTINGS,
+			gettext_noop("Flushes WAL for concurrently committing transactions in groups."),
+			NULL
+		},
+		&wal_group_commit,
+		false,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"log_checkpoints", PGC_SIGHUP, LOGGING_WHAT,
 			gettext_noop("Logs each checkpoint."),
@@ -1890,6 +1924,16 @@ struct config_bool ConfigureNamesBool[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"lock_free_buffer_mapping", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Uses a shared buffer lookup table that can be searched without locking."),
+			NULL
+		},
+		&lock_free_buffer_mapping,
+		false,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"parallel_leader_participation", PGC_USERSET, RESOURCES_ASYNCHRONOUS,
 			gettext_noop("Controls whether Gather and Gather Merge also run subplans."),
@@ -2230,6 +2274,36 @@ struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"buffer_pool_numa_nodes", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the number of partitions the shared buffer pool is divided into across NUMA nodes."),
+			gettext_noop("0 means one partition per NUMA node.")
+		},
+		&buffer_pool_numa_nodes,
+		0, 0, MAX_BUFFER_POOL_PARTITIONS,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"hyperbolic_sample_size", PGC_SIGHUP, RESOURCES_MEM,
+			gettext_noop("Sets the number of buffers sampled per eviction by the hyperbolic replacement policy."),
+			NULL
+		},
+		&hyperbolic_sample_size,
+		20, 1, HYPERBOLIC_MAX_SAMPLE_SIZE,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"hyperbolic_retained_samples", PGC_SIGHUP, RESOURCES_MEM,
+			gettext_noop("Sets the number of sampled buffers the hyperbolic replacement policy keeps for the next eviction."),
+			NULL
+		},
+		&hyperbolic_retained_samples,
+		0, 0, HYPERBOLIC_MAX_SAMPLE_SIZE - 1,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"vacuum_buffer_usage_limit", PGC_USERSET, RESOURCES_MEM,
 			gettext_noop("Sets the buffer pool size for VACUUM, ANALYZE, and autovacuum."),
@@ -2263,6 +2337,83 @@ struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"commit_timestamp_buffers", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the size of the dedicated buffer pool used for the commit timestamp cache."),
+			gettext_noop("0 means use a fraction of \"shared_buffers\"."),
+			GUC_UNIT_BLOCKS
+		},
+		&commit_timestamp_buffers,
+		0, 0, SLRU_MAX_ALLOWED_BUFFERS,
+		check_commit_ts_buffers, NULL, NULL
+	},
+
+	{
+		{"multixact_member_buffers", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the size of the dedicated buffer pool used for the MultiXact member cache."),
+			NULL,
+			GUC_UNIT_BLOCKS
+		},
+		&multixact_member_buffers,
+		32, 16, SLRU_MAX_ALLOWED_BUFFERS,
+		check_multixact_member_buffers, NULL, NULL
+	},
+
+	{
+		{"multixact_offset_buffers", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the size of the dedicated buffer pool used for the MultiXact offset cache."),
+			NULL,
+			GUC_UNIT_BLOCKS
+		},
+		&multixact_offset_buffers,
+		16, 16, SLRU_MAX_ALLOWED_BUFFERS,
+		check_multixact_offset_buffers, NULL, NULL
+	},
+
+	{
+		{"notify_buffers", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the size of the dedicated buffer pool used for the LISTEN/NOTIFY message cache."),
+			NULL,
+			GUC_UNIT_BLOCKS
+		},
+		&notify_buffers,
+		16, 16, SLRU_MAX_ALLOWED_BUFFERS,
+		check_notify_buffers, NULL, NULL
+	},
+
+	{
+		{"serializable_buffers", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the size of the dedicated buffer pool used for the serializable transaction cache."),
+			NULL,
+			GUC_UNIT_BLOCKS
+		},
+		&serializable_buffers,
+		32, 16, SLRU_MAX_ALLOWED_BUFFERS,
+		check_serial_buffers, NULL, NULL
+	},
+
+	{
+		{"subtransaction_buffers", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the size of the dedicated buffer pool used for the subtransaction cache."),
+			gettext_noop("0 means use a fraction of \"shared_buffers\"."),
+			GUC_UNIT_BLOCKS
+		},
+		&subtransaction_buffers,
+		0, 0, SLRU_MAX_ALLOWED_BUFFERS,
+		check_subtrans_buffers, NULL, NULL
+	},
+
+	{
+		{"transaction_buffers", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the size of the dedicated buffer pool used for the transaction status cache."),
+			gettext_noop("0 means use a fraction of \"shared_buffers\"."),
+			GUC_UNIT_BLOCKS
+		},
+		&transaction_buffers,
+		0, 0, SLRU_MAX_ALLOWED_BUFFERS,
+		check_transaction_buffers, NULL, NULL
+	},
+
 	{
 		{"temp_buffers", PGC_USERSET, RESOURCES_MEM,
 			gettext_noop("Sets the maximum number of temporary buffers used by each session."),
@@ -2757,6 +2908,16 @@ struct config_int ConfigureNamesInt[] =
 		check_wal_buffers, NULL, NULL
 	},
 
+	{
+		{"wal_insert_locks", PGC_POSTMASTER, WAL_SETTINGS,
+			gettext_noop("Sets the number of locks used for concurrent WAL insertions."),
+			NULL
+		},
+		&wal_insert_locks,
+		8, 1, MAX_WAL_INSERT_LOCKS,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"wal_writer_delay", PGC_SIGHUP, WAL_SETTINGS,
 			gettext_noop("Time between WAL flushes performed in the WAL writer."),
@@ -4527,6 +4688,27 @@ struct config_string ConfigureNamesString[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"buffer_trace_directory", PGC_SUSET, STATS_MONITORING,
+			gettext_noop("Sets the directory to which shared buffer accesses are traced."),
+			gettext_noop("An empty string disables tracing."),
+			GUC_SUPERUSER_ONLY
+		},
+		&buffer_trace_directory,
+		"",
+		NULL, assign_buffer_trace_directory, NULL
+	},
+
+	{
+		{"buffer_replacement_policy", PGC_SIGHUP, RESOURCES_MEM,
+			gettext_noop("Sets the replacement policy of the shared buffer pool."),
+			NULL
+		},
+		&buffer_replacement_policy,
+		"clocksweep",
+		check_buffer_replacement_policy, NULL, NULL
+	},
+
 	{
 		{"backtrace_functions", PGC_SUSET, DEVELOPER_OPTIONS,
 			gettext_noop("Log backtrace for errors in these functions."),
@@ -4845,6 +5027,17 @@ struct config_enum ConfigureNamesEnum[] =
 		NULL, assign_xlog_sync_method, NULL
 	},
 
+	{
+		{"wal_io_method", PGC_SIGHUP, WAL_SETTINGS,
+			gettext_noop("Selects the method used for writing WAL to disk."),
+			gettext_noop("io_uring submits the writes and syncs of each WAL flush with one system call, "
+						 "but still waits for them to complete.")
+		},
+		&wal_io_method,
+		WAL_IO_METHOD_SYNC, wal_io_method_options,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"xmlbinary", PGC_USERSET, CLIENT_CONN_STATEMENT,
 			gettext_noop("Sets how binary values are to be encoded in XML."),
@@ -4876,6 +5069,26 @@ struct config_enum ConfigureNamesEnum[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"hyperbolic_priority", PGC_SIGHUP, RESOURCES_MEM,
+			gettext_noop("Sets the priority function of the hyperbolic replacement policy."),
+			NULL
+		},
+		&hyperbolic_priority,
+		HYPERBOLIC_PRIORITY_HYPERBOLIC, hyperbolic_priority_options,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"temp_buffer_replacement_policy", PGC_USERSET, RESOURCES_MEM,
+			gettext_noop("Sets the replacement policy for temporary buffers."),
+			NULL
+		},
+		&temp_buffer_replacement_policy,
+		LOCAL_BUFFER_POLICY_CLOCKSWEEP, temp_buffer_replacement_policy_options,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"recovery_prefetch", PGC_SIGHUP, WAL_RECOVERY,
 			gettext_noop("Prefetch referenced blocks during recovery."),
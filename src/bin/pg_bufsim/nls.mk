@@ -0,0 +1,5 @@
+# src/bin/pg_bufsim/nls.mk
+CATALOG_NAME     = pg_bufsim
+GETTEXT_FILES    = $(FRONTEND_COMMON_GETTEXT_FILES) pg_bufsim.c
+GETTEXT_TRIGGERS = $(FRONTEND_COMMON_GETTEXT_TRIGGERS)
+GETTEXT_FLAGS    = $(FRONTEND_COMMON_GETTEXT_FLAGS)
@@ -0,0 +1,510 @@
+/*-------------------------------------------------------------------------
+ *
+ * pg_bufsim.c
+ *	  Replay shared buffer access traces against buffer replacement policies
+ *
+ * The traces are written by the server when buffer_trace_directory is set,
+ * one file per process (see storage/buftrace.h).  The files are merged in
+ * timestamp order and the resulting access stream is fed, in a single pass,
+ * to a simulated buffer pool for every requested combination of policy and
+ * pool size.  For each we report the number of hits and misses.
+ *
+ * The simulated policies are the single-threaded versions of the server's
+ * ones in common/bufpolicy.c, which local buffers use as well, with no
+ * buffer ever pinned.  Relation extensions count as misses, since they
+ * install a new page just like a read does.
+ *
+ * Portions Copyright (c) 1996-2023, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *	  src/bin/pg_bufsim/pg_bufsim.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres_fe.h"
+
+#include <ctype.h>
+#include <dirent.h>
+#include <limits.h>
+#include <sys/stat.h>
+
+#include "common/bufpolicy.h"
+#include "common/hashfn.h"
+#include "common/logging.h"
+#include "getopt_long.h"
+#include "storage/buftrace.h"
+
+/* seed for the policies that draw random numbers, to make runs repeatable */
+#define BUFSIM_PRNG_SEED		0x5eed
+
+/* defaults of the corresponding server settings */
+#define BUFSIM_DEFAULT_SIZE		"128MB"
+#define BUFSIM_MAX_USAGE_COUNT	5
+#define HYPERBOLIC_SAMPLE_SIZE	20
+
+/* number of records read from a trace file at a time */
+#define READER_BUFFER_RECORDS	1024
+
+/*
+ * Page identity.  Unlike BufferTag this has no padding, so that it can be
+ * hashed bytewise.
+ */
+typedef struct SimTag
+{
+	Oid			spcOid;
+	Oid			dbOid;
+	RelFileNumber relNumber;
+	BlockNumber blockNum;
+	int32		forkNum;
+} SimTag;
+
+typedef struct SimEntry
+{
+	SimTag		tag;
+	int			buf_id;
+	char		status;			/* for simplehash */
+} SimEntry;
+
+#define SH_PREFIX		simtab
+#define SH_ELEMENT_TYPE	SimEntry
+#define SH_KEY_TYPE		SimTag
+#define SH_KEY			tag
+#define SH_HASH_KEY(tb, key)	hash_bytes((const unsigned char *) &(key), sizeof(SimTag))
+#define SH_EQUAL(tb, a, b)		(memcmp(&(a), &(b), sizeof(SimTag)) == 0)
+#define SH_SCOPE		static inline
+#define SH_RAW_ALLOCATOR	pg_malloc0
+#define SH_DECLARE
+#define SH_DEFINE
+#include "lib/simplehash.h"
+
+/*
+ * A simulated buffer pool.
+ */
+typedef struct SimPool
+{
+	BufPolicyType policy;
+	BufPolicyOptions options;
+	BufPolicyPool *state;		/* the policy's state */
+	int			nbuffers;
+	int			nused;			/* buffers 0..nused-1 hold a page */
+	SimTag	   *tags;			/* page held by each buffer */
+	simtab_hash *map;			/* page -> buffer */
+	uint64		hits;
+	uint64		misses;
+} SimPool;
+
+/*
+ * A trace file being read.
+ */
+typedef struct TraceReader
+{
+	const char *path;
+	FILE	   *file;
+	BufferTraceRecord records[READER_BUFFER_RECORDS];
+	int			nrecords;
+	int			next;
+} TraceReader;
+
+static const char *progname;
+
+static TraceReader **readers = NULL;
+static int	nreaders = 0;
+static uint32 trace_blcksz = 0;
+
+static SimPool **pools = NULL;
+static int	npools = 0;
+
+static void
+usage(void)
+{
+	printf(_("%s replays shared buffer access traces against buffer replacement policies.\n\n"),
+		   progname);
+	printf(_("Usage:\n"));
+	printf(_("  %s [OPTION]... FILE|DIRECTORY...\n"), progname);
+	printf(_("\nOptions:\n"));
+	printf(_("  -p, --policy=NAME      simulate this policy (may be repeated; default: all)\n"));
+	printf(_("  -s, --size=SIZE        simulate a pool of SIZE buffers, or kB, MB or GB\n"
+			 "                         (may be repeated; default: %s)\n"),
+		   BUFSIM_DEFAULT_SIZE);
+	printf(_("  -V, --version          output version information, then exit\n"));
+	printf(_("  -?, --help             show this help, then exit\n"));
+	printf(_("\nPolicies:"));
+	for (int i = 0; i < NUM_BUFPOLICIES; i++)
+		printf(" %s", BufPolicyNames[i]);
+	printf("\n");
+	printf(_("\nReport bugs to <%s>.\n"), PACKAGE_BUGREPORT);
+	printf(_("%s home page: <%s>\n"), PACKAGE_NAME, PACKAGE_URL);
+}
+
+static BufPolicyType
+lookup_policy(const char *name)
+{
+	for (int i = 0; i < NUM_BUFPOLICIES; i++)
+	{
+		if (pg_strcasecmp(BufPolicyNames[i], name) == 0)
+			return (BufPolicyType) i;
+	}
+
+	pg_log_error("unrecognized buffer replacement policy \"%s\"", name);
+	pg_log_error_hint("Try \"%s --help\" for more information.", progname);
+	exit(1);
+}
+
+/*
+ * Convert a pool size, given as a number of buffers or with a memory unit,
+ * into a number of buffers of the traced block size.
+ */
+static int
+parse_size(const char *str)
+{
+	char	   *endptr;
+	double		val;
+	double		unit = 0;
+
+	errno = 0;
+	val = strtod(str, &endptr);
+	if (endptr != str && errno == 0 && val >= 1)
+	{
+		while (isspace((unsigned char) *endptr))
+			endptr++;
+		if (*endptr == '\0')
+			unit = trace_blcksz;
+		else if (strcmp(endptr, "kB") == 0)
+			unit = 1024;
+		else if (strcmp(endptr, "MB") == 0)
+			unit = 1024 * 1024;
+		else if (strcmp(endptr, "GB") == 0)
+			unit = 1024 * 1024 * 1024;
+	}
+
+	if (unit != 0)
+	{
+		val = val * unit / trace_blcksz;
+		if (val >= 16 && val <= INT_MAX / 2)
+			return (int) val;
+		pg_log_error("pool size \"%s\" must be between 16 buffers and %d buffers",
+					 str, INT_MAX / 2);
+		exit(1);
+	}
+
+	pg_log_error("invalid pool size: \"%s\"", str);
+	pg_log_error_hint("Try \"%s --help\" for more information.", progname);
+	exit(1);
+}
+
+static void
+add_trace_file(const char *path)
+{
+	TraceReader *reader;
+	BufferTraceFileHeader hdr;
+
+	reader = pg_malloc0(sizeof(TraceReader));
+	reader->path = pg_strdup(path);
+	reader->file = fopen(path, PG_BINARY_R);
+	if (reader->file == NULL)
+		pg_fatal("could not open file \"%s\": %m", path);
+
+	if (fread(&hdr, sizeof(hdr), 1, reader->file) != 1)
+	{
+		if (ferror(reader->file))
+			pg_fatal("could not read file \"%s\": %m", path);
+		pg_fatal("file \"%s\" is too short to be a buffer trace", path);
+	}
+	if (hdr.magic != BUFTRACE_MAGIC)
+		pg_fatal("file \"%s\" is not a buffer trace", path);
+	if (hdr.version != BUFTRACE_VERSION)
+		pg_fatal("buffer trace \"%s\" has unsupported version %u", path,
+				 hdr.version);
+	if (trace_blcksz == 0)
+		trace_blcksz = hdr.blcksz;
+	else if (hdr.blcksz != trace_blcksz)
+		pg_fatal("buffer trace \"%s\" has block size %u, expected %u",
+				 path, hdr.blcksz, trace_blcksz);
+
+	readers = pg_realloc(readers, (nreaders + 1) * sizeof(TraceReader *));
+	readers[nreaders++] = reader;
+}
+
+/*
+ * Add a trace file, or all trace files in a directory.
+ */
+static void
+add_trace_path(const char *path)
+{
+	struct stat st;
+	DIR		   *dir;
+	struct dirent *de;
+
+	if (stat(path, &st) != 0)
+		pg_fatal("could not stat file \"%s\": %m", path);
+
+	if (!S_ISDIR(st.st_mode))
+	{
+		add_trace_file(path);
+		return;
+	}
+
+	dir = opendir(path);
+	if (dir == NULL)
+		pg_fatal("could not open directory \"%s\": %m", path);
+
+	while (errno = 0, (de = readdir(dir)) != NULL)
+	{
+		char		file[MAXPGPATH];
+
+		if (strncmp(de->d_name, BUFTRACE_FILE_PREFIX,
+					strlen(BUFTRACE_FILE_PREFIX)) != 0)
+			continue;
+		snprintf(file, sizeof(file), "%s/%s", path, de->d_name);
+		add_trace_file(file);
+	}
+	if (errno)
+		pg_fatal("could not read directory \"%s\": %m", path);
+
+	closedir(dir);
+}
+
+/*
+ * Return the next record of a trace file without consuming it, or NULL at
+ * the end of the file.  A trailing partial record, left by a server crash,
+ * is ignored.
+ */
+static BufferTraceRecord *
+peek_record(TraceReader *reader)
+{
+	if (reader->next == reader->nrecords)
+	{
+		if (reader->file == NULL)
+			return NULL;
+		reader->nrecords = fread(reader->records, sizeof(BufferTraceRecord),
+								 READER_BUFFER_RECORDS, reader->file);
+		reader->next = 0;
+		if (reader->nrecords < READER_BUFFER_RECORDS)
+		{
+			if (ferror(reader->file))
+				pg_fatal("could not read file \"%s\": %m", reader->path);
+			fclose(reader->file);
+			reader->file = NULL;
+		}
+		if (reader->nrecords == 0)
+			return NULL;
+	}
+
+	return &reader->records[reader->next];
+}
+
+/*
+ * Return the earliest record not yet consumed from any trace, or NULL when
+ * all traces are exhausted.  The number of traces is the number of server
+ * processes that did any buffer access, so a linear scan is good enough.
+ */
+static BufferTraceRecord *
+next_record(void)
+{
+	TraceReader *best = NULL;
+	BufferTraceRecord *best_rec = NULL;
+
+	for (int i = 0; i < nreaders; i++)
+	{
+		BufferTraceRecord *rec = peek_record(readers[i]);
+
+		if (rec != NULL && (best_rec == NULL || rec->time < best_rec->time))
+		{
+			best = readers[i];
+			best_rec = rec;
+		}
+	}
+
+	if (best != NULL)
+		best->next++;
+
+	return best_rec;
+}
+
+/* hash code of the page in a buffer, for arc and s3fifo */
+static uint32
+sim_page_hash(int buf_id, void *arg)
+{
+	SimPool    *pool = (SimPool *) arg;
+
+	return hash_bytes((const unsigned char *) &pool->tags[buf_id],
+					  sizeof(SimTag));
+}
+
+static void
+add_pool(BufPolicyType policy, int nbuffers)
+{
+	SimPool    *pool;
+
+	pool = pg_malloc0(sizeof(SimPool));
+	pool->policy = policy;
+	pool->options.max_usage = BUFSIM_MAX_USAGE_COUNT;
+	pool->options.sample_size = HYPERBOLIC_SAMPLE_SIZE;
+	pool->options.priority = HYPERBOLIC_PRIORITY_HYPERBOLIC;
+	pool->options.is_pinned = NULL;
+	pool->options.page_hash = sim_page_hash;
+	pool->options.arg = pool;
+	pool->state = BufPolicyCreate(policy, nbuffers, &pool->options,
+								  BUFSIM_PRNG_SEED);
+	pool->nbuffers = nbuffers;
+	pool->tags = pg_malloc(nbuffers * sizeof(SimTag));
+	pool->map = simtab_create(nbuffers, NULL);
+
+	pools = pg_realloc(pools, (npools + 1) * sizeof(SimPool *));
+	pools[npools++] = pool;
+}
+
+static void
+simulate_access(SimPool *pool, const SimTag *tag)
+{
+	SimEntry   *entry;
+	bool		found;
+	int			buf_id;
+
+	entry = simtab_insert(pool->map, *tag, &found);
+	if (found)
+	{
+		pool->hits++;
+		BufPolicyHit(pool->state, entry->buf_id);
+		return;
+	}
+
+	pool->misses++;
+	if (pool->nused < pool->nbuffers)
+		buf_id = pool->nused++;
+	else
+	{
+		buf_id = BufPolicyGetVictim(pool->state);
+		Assert(buf_id >= 0);
+		simtab_delete(pool->map, pool->tags[buf_id]);
+		/* deletion may have moved the new entry */
+		entry = simtab_lookup(pool->map, *tag);
+	}
+
+	entry->buf_id = buf_id;
+	pool->tags[buf_id] = *tag;
+	BufPolicyLoad(pool->state, buf_id);
+}
+
+int
+main(int argc, char *argv[])
+{
+	static struct option long_options[] = {
+		{"policy", required_argument, NULL, 'p'},
+		{"size", required_argument, NULL, 's'},
+		{NULL, 0, NULL, 0}
+	};
+
+	BufPolicyType *policies = NULL;
+	int			npolicies = 0;
+	const char **sizes = NULL;
+	int			nsizes = 0;
+	BufferTraceRecord *rec;
+	uint64		naccesses = 0;
+	int			c;
+
+	pg_logging_init(argv[0]);
+	set_pglocale_pgservice(argv[0], PG_TEXTDOMAIN("pg_bufsim"));
+	progname = get_progname(argv[0]);
+
+	if (argc > 1)
+	{
+		if (strcmp(argv[1], "--help") == 0 || strcmp(argv[1], "-?") == 0)
+		{
+			usage();
+			exit(0);
+		}
+		if (strcmp(argv[1], "--version") == 0 || strcmp(argv[1], "-V") == 0)
+		{
+			puts("pg_bufsim (PostgreSQL) " PG_VERSION);
+			exit(0);
+		}
+	}
+
+	while ((c = getopt_long(argc, argv, "p:s:", long_options, NULL)) != -1)
+	{
+		switch (c)
+		{
+			case 'p':
+				policies = pg_realloc(policies,
+									  (npolicies + 1) * sizeof(BufPolicyType));
+				policies[npolicies++] = lookup_policy(optarg);
+				break;
+			case 's':
+				sizes = pg_realloc(sizes, (nsizes + 1) * sizeof(char *));
+				sizes[nsizes++] = pg_strdup(optarg);
+				break;
+			default:
+				/* getopt_long already emitted a complaint */
+				pg_log_error_hint("Try \"%s --help\" for more information.", progname);
+				exit(1);
+		}
+	}
+
+	if (optind >= argc)
+	{
+		pg_log_error("no trace file specified");
+		pg_log_error_hint("Try \"%s --help\" for more information.", progname);
+		exit(1);
+	}
+
+	for (; optind < argc; optind++)
+		add_trace_path(argv[optind]);
+	if (nreaders == 0)
+		pg_fatal("no buffer trace files found");
+
+	if (nsizes == 0)
+	{
+		sizes = pg_malloc(sizeof(char *));
+		sizes[nsizes++] = BUFSIM_DEFAULT_SIZE;
+	}
+
+	for (int i = 0; i < nsizes; i++)
+	{
+		int			nbuffers = parse_size(sizes[i]);
+
+		if (npolicies == 0)
+		{
+			for (int j = 0; j < NUM_BUFPOLICIES; j++)
+				add_pool((BufPolicyType) j, nbuffers);
+		}
+		else
+		{
+			for (int j = 0; j < npolicies; j++)
+				add_pool(policies[j], nbuffers);
+		}
+	}
+
+	while ((rec = next_record()) != NULL)
+	{
+		SimTag		tag;
+
+		tag.spcOid = rec->spcOid;
+		tag.dbOid = rec->dbOid;
+		tag.relNumber = rec->relNumber;
+		tag.blockNum = rec->blockNum;
+		tag.forkNum = rec->forkNum;
+
+		for (int i = 0; i < npools; i++)
+			simulate_access(pools[i], &tag);
+		naccesses++;
+	}
+
+	printf(_("%llu buffer accesses from %d trace files\n\n"),
+		   (unsigned long long) naccesses, nreaders);
+	printf("%-12s %10s %14s %14s %9s\n",
+		   _("policy"), _("buffers"), _("hits"), _("misses"), _("hit ratio"));
+	for (int i = 0; i < npools; i++)
+	{
+		SimPool    *pool = pools[i];
+		uint64		total = pool->hits + pool->misses;
+
+		printf("%-12s %10d %14llu %14llu %8.2f%%\n",
+			   BufPolicyNames[pool->policy], pool->nbuffers,
+			   (unsigned long long) pool->hits,
+			   (unsigned long long) pool->misses,
+			   total > 0 ? 100.0 * pool->hits / total : 0.0);
+	}
+
+	return 0;
+}
@@ -0,0 +1,60 @@
+# Copyright (c) 2023, PostgreSQL Global Development Group
+
+use strict;
+use warnings;
+
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+#########################################
+# Basic checks
+
+program_help_ok('pg_bufsim');
+program_version_ok('pg_bufsim');
+program_options_handling_ok('pg_bufsim');
+
+#########################################
+# Replay a small trace
+
+my $tempdir = PostgreSQL::Test::Utils::tempdir;
+my $trace = "$tempdir/buftrace.1";
+
+# header: magic, version, block size, pid
+my $data = pack('LLLl', 0x43525442, 1, 8192, 1);
+
+# Cycle over 20 pages, then over the first 10 again.  With 16 buffers, LRU
+# has always just evicted the page that is needed next.
+my $time = 0;
+foreach my $block ((0 .. 19), (0 .. 9))
+{
+	# time, spcOid, dbOid, relNumber, blockNum, pid, forkNum, event, padding
+	$data .= pack('qLLLLlcCS', $time++, 1663, 5, 16384, $block, 1, 0, 1, 0);
+}
+append_to_file($trace, $data);
+
+command_like(
+	[ 'pg_bufsim', '--policy', 'lru', '--size', '16', $trace ],
+	qr/^30 buffer accesses.*^lru\s+16\s+0\s+30\s/ms,
+	'pg_bufsim: LRU misses on a cyclic pattern larger than the pool');
+command_like(
+	[ 'pg_bufsim', '--size', '16', $tempdir ],
+	qr/^clocksweep\s+16\s.*^eaclock_fwa\s+16\s.*^s3fifo\s+16\s/ms,
+	'pg_bufsim: all policies on a trace directory');
+
+#########################################
+# Test invalid arguments
+
+command_fails_like(
+	[ 'pg_bufsim', '--policy', 'foo', $trace ],
+	qr/\Qpg_bufsim: error: unrecognized buffer replacement policy "foo"\E/,
+	'pg_bufsim: unrecognized policy');
+command_fails_like(
+	[ 'pg_bufsim', '--size', '4', $trace ],
+	qr/\Qpg_bufsim: error: pool size "4" must be between 16 buffers\E/,
+	'pg_bufsim: pool size out of range');
+command_fails_like(
+	[ 'pg_bufsim', "$tempdir/nonexistent" ],
+	qr/\Qpg_bufsim: error: could not stat file\E/,
+	'pg_bufsim: nonexistent trace file');
+
+done_testing();
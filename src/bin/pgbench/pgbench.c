@@ -818,6 +818,56 @@ static const BuiltinScript builtin_script[] =
 		"<builtin: select only>",
 		"\\set aid random(1, " CppAsString2(naccounts) " * :scale)\n"
 		"SELECT abalance FROM pgbench_accounts WHERE aid = :aid;\n"
+	},
+
+	/*
+	 * The remaining scripts are read-only access patterns meant for comparing
+	 * buffer replacement policies.  They only touch pgbench_accounts, which
+	 * should be sized larger than shared_buffers for the results to mean
+	 * anything.  Zipfian keys are scattered with permute(), so that the hot
+	 * rows are spread over the whole table instead of sharing a few pages.
+	 */
+	{
+		"zipfian",
+		"<builtin: zipfian select>",
+		"\\set aid 1 + permute(random_zipfian(0, " CppAsString2(naccounts) " * :scale - 1, 1.1), " CppAsString2(naccounts) " * :scale)\n"
+		"SELECT abalance FROM pgbench_accounts WHERE aid = :aid;\n"
+	},
+	{
+		/* zipfian point reads, with a 10000-row range scan 1% of the time */
+		"scan-polluted",
+		"<builtin: zipfian select with range scans>",
+		"\\if random(1, 100) = 1\n"
+		"\\set aid random(1, greatest(" CppAsString2(naccounts) " * :scale - 9999, 1))\n"
+		"SELECT sum(abalance) FROM pgbench_accounts WHERE aid BETWEEN :aid AND :aid + 9999;\n"
+		"\\else\n"
+		"\\set aid 1 + permute(random_zipfian(0, " CppAsString2(naccounts) " * :scale - 1, 1.1), " CppAsString2(naccounts) " * :scale)\n"
+		"SELECT abalance FROM pgbench_accounts WHERE aid = :aid;\n"
+		"\\endif\n"
+	},
+	{
+		/*
+		 * 90% of reads go to a window of 1% of the rows, which moves on to
+		 * the next 1% every 10 seconds; the rest are uniform.
+		 */
+		"shifting-hotspot",
+		"<builtin: shifting hotspot select>",
+		"\\set nrows " CppAsString2(naccounts) " * :scale\n"
+		"\\set hotrows greatest(:nrows / 100, 1)\n"
+		"\\if random(1, 100) <= 90\n"
+		"\\set aid random(0, :hotrows - 1)\n"
+		"SELECT abalance FROM pgbench_accounts WHERE aid = 1 + (:aid + (extract(epoch FROM now())::bigint / 10) * :hotrows) % :nrows;\n"
+		"\\else\n"
+		"\\set aid random(1, :nrows)\n"
+		"SELECT abalance FROM pgbench_accounts WHERE aid = :aid;\n"
+		"\\endif\n"
+	},
+	{
+		/* sweep the whole table in key order once every 10 seconds */
+		"loop",
+		"<builtin: looping select>",
+		"\\set nrows " CppAsString2(naccounts) " * :scale\n"
+		"SELECT abalance FROM pgbench_accounts WHERE aid = 1 + ((extract(epoch FROM now()) * 1000000)::bigint % 10000000) * :nrows / 10000000;\n"
 	}
 };
 
@@ -6041,7 +6091,7 @@ listAvailableScripts(void)
 
 	fprintf(stderr, "Available builtin scripts:\n");
 	for (i = 0; i < lengthof(builtin_script); i++)
-		fprintf(stderr, "  %13s: %s\n", builtin_script[i].name, builtin_script[i].desc);
+		fprintf(stderr, "  %16s: %s\n", builtin_script[i].name, builtin_script[i].desc);
 	fprintf(stderr, "\n");
 }
 
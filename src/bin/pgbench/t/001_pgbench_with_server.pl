@@ -145,6 +145,23 @@ $node->pgbench(
 	],
 	'pgbench select only');
 
+# Buffer replacement access patterns, in both simple and prepared mode
+for my $mode ('simple', 'prepared')
+{
+	$node->pgbench(
+		"-t 20 -c 2 -M $mode -n -b zipfian -b scan-polluted -b shifting-hotspot -b loop",
+		0,
+		[
+			qr{builtin: zipfian select},
+			qr{builtin: zipfian select with range scans},
+			qr{builtin: shifting hotspot select},
+			qr{builtin: looping select},
+			qr{processed: 40/40}
+		],
+		[qr{^$}],
+		"pgbench buffer policy access patterns, $mode");
+}
+
 # check if threads are supported
 my $nthreads = 2;
 
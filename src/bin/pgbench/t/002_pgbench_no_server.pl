@@ -257,7 +257,9 @@ pgbench(
 	[qr{^$}],
 	[
 		qr{Available builtin scripts:}, qr{tpcb-like},
-		qr{simple-update}, qr{select-only}
+		qr{simple-update}, qr{select-only},
+		qr{zipfian}, qr{scan-polluted},
+		qr{shifting-hotspot}, qr{loop}
 	],
 	'pgbench builtin list');
 
@@ -0,0 +1,241 @@
+
+# Copyright (c) 2023, PostgreSQL Global Development Group
+
+#
+# Buffer replacement policy benchmark.
+#
+# Runs pgbench's buffer access pattern scripts against pgbench_accounts
+# tables sized to several multiples of shared_buffers, once per replacement
+# policy, and writes one JSON report covering all runs.  This takes a long
+# time, so it only runs when PG_TEST_EXTRA contains "buffer_policy_bench".
+#
+# The following environment variables adjust the runs:
+#
+#   PG_BUFFER_POLICY_BENCH_POLICIES   policies to compare
+#   PG_BUFFER_POLICY_BENCH_PATTERNS   pgbench builtin scripts to run
+#   PG_BUFFER_POLICY_BENCH_RATIOS     table size as multiples of shared_buffers
+#   PG_BUFFER_POLICY_BENCH_SHARED_BUFFERS
+#   PG_BUFFER_POLICY_BENCH_CLIENTS
+#   PG_BUFFER_POLICY_BENCH_DURATION   seconds measured per run
+#   PG_BUFFER_POLICY_BENCH_WARMUP     seconds run before each measurement
+#   PG_BUFFER_POLICY_BENCH_REPORT     report file name
+#
+use strict;
+use warnings;
+
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+use POSIX qw(ceil);
+
+if (!$ENV{PG_TEST_EXTRA} || $ENV{PG_TEST_EXTRA} !~ /\bbuffer_policy_bench\b/)
+{
+	plan skip_all =>
+	  'Benchmark buffer_policy_bench not enabled in PG_TEST_EXTRA';
+}
+
+my @policies = split(' ',
+	$ENV{PG_BUFFER_POLICY_BENCH_POLICIES}
+	  // 'clocksweep clock lru hyperbolic eaclock arc s3fifo');
+my @patterns = split(' ',
+	$ENV{PG_BUFFER_POLICY_BENCH_PATTERNS}
+	  // 'zipfian scan-polluted shifting-hotspot loop');
+my @ratios = split(' ', $ENV{PG_BUFFER_POLICY_BENCH_RATIOS} // '1 4 10');
+my $shared_buffers = $ENV{PG_BUFFER_POLICY_BENCH_SHARED_BUFFERS} // '32MB';
+my $clients = $ENV{PG_BUFFER_POLICY_BENCH_CLIENTS} // 4;
+my $duration = $ENV{PG_BUFFER_POLICY_BENCH_DURATION} // 20;
+my $warmup = $ENV{PG_BUFFER_POLICY_BENCH_WARMUP} // 5;
+my $report = $ENV{PG_BUFFER_POLICY_BENCH_REPORT}
+  // "$PostgreSQL::Test::Utils::tmp_check/buffer_policy_bench.json";
+
+my $node = PostgreSQL::Test::Cluster->new('main');
+$node->init;
+$node->append_conf(
+	'postgresql.conf', qq(
+shared_buffers = '$shared_buffers'
+max_connections = @{[ $clients + 10 ]}
+autovacuum = off
+));
+$node->start;
+
+my $bdir = $node->basedir;
+my $sb_bytes = $node->safe_psql('postgres',
+	"SELECT pg_size_bytes(current_setting('shared_buffers'))");
+
+# Measure how much of pgbench_accounts (heap and primary key) one unit of
+# scale takes, to translate the requested ratios into scale factors.
+$node->command_ok([ 'pgbench', '-i', '-q', '-s', '1', 'postgres' ],
+	'pgbench scale 1 initialization');
+my $unit_bytes = $node->safe_psql('postgres',
+	"SELECT pg_total_relation_size('pgbench_accounts')");
+
+# Percentile of a sorted list, by the nearest-rank method.
+sub percentile
+{
+	my ($sorted, $p) = @_;
+
+	return 'null' if !@$sorted;
+	my $rank = ceil($p / 100 * @$sorted);
+	$rank = 1 if $rank < 1;
+	return $sorted->[ $rank - 1 ];
+}
+
+# Collect transaction latencies (in microseconds) from pgbench's per-client
+# logs, and remove them so that the next run starts afresh.
+sub collect_latencies
+{
+	my ($prefix) = @_;
+	my @latencies;
+
+	for my $log (glob("$bdir/$prefix.*"))
+	{
+		for my $line (split(/\n/, slurp_file($log)))
+		{
+			my @fields = split(/ /, $line);
+			push @latencies, $fields[2] if @fields >= 6;
+		}
+		unlink $log;
+	}
+	return [ sort { $a <=> $b } @latencies ];
+}
+
+# Run pgbench with the given script, returning its standard output.
+sub run_pgbench
+{
+	my ($pattern, $seconds, @extra) = @_;
+	my ($stdout, $stderr);
+
+	my $ok = run_log(
+		[
+			'pgbench', '-n', '-b', $pattern,
+			'-c', $clients, '-j', $clients,
+			'-T', $seconds, @extra,
+			'-h', $node->host, '-p', $node->port,
+			'postgres'
+		],
+		'>', \$stdout, '2>', \$stderr);
+	ok($ok, "pgbench $pattern for $seconds s");
+	diag($stderr) if !$ok;
+	return $stdout // '';
+}
+
+my @runs;
+
+for my $ratio (@ratios)
+{
+	my $scale = ceil($ratio * $sb_bytes / $unit_bytes);
+	$scale = 1 if $scale < 1;
+
+	$node->command_ok(
+		[ 'pgbench', '-i', '-q', '-I', 'dtgvp', '-s', $scale, 'postgres' ],
+		"pgbench initialization at scale $scale");
+	my $table_bytes = $node->safe_psql('postgres',
+		"SELECT pg_total_relation_size('pgbench_accounts')");
+
+	for my $pattern (@patterns)
+	{
+		for my $policy (@policies)
+		{
+			$node->safe_psql('postgres',
+				"ALTER SYSTEM SET buffer_replacement_policy = '$policy'");
+			$node->reload;
+			$node->poll_query_until('postgres',
+				"SELECT current_setting('buffer_replacement_policy') = '$policy'"
+			) or die "timed out waiting for policy $policy";
+
+			run_pgbench($pattern, $warmup) if $warmup > 0;
+
+			$node->safe_psql('postgres',
+				"SELECT pg_stat_reset(), pg_stat_reset_shared('buffer_policy')");
+
+			my $prefix = "bench_${ratio}_${pattern}_${policy}";
+			my $stdout = run_pgbench($pattern, $duration, '-l',
+				"--log-prefix=$bdir/$prefix");
+			my ($tps) = $stdout =~ /tps = ([\d.]+) \(without initial/;
+			my $latencies = collect_latencies($prefix);
+
+			# Backends flush their statistics before disappearing from
+			# pg_stat_activity, so wait for pgbench's connections to go away.
+			$node->poll_query_until('postgres',
+				"SELECT count(*) = 0 FROM pg_stat_activity "
+				  . "WHERE backend_type = 'client backend' "
+				  . "AND pid <> pg_backend_pid()");
+
+			my ($blks_hit, $blks_read) = split(
+				/\|/,
+				$node->safe_psql(
+					'postgres',
+					"SELECT blks_hit, blks_read FROM pg_stat_database "
+					  . "WHERE datname = current_database()"));
+			my ($evictions, $searches, $scanned, $sweep) = split(
+				/\|/,
+				$node->safe_psql(
+					'postgres',
+					"SELECT evictions, searches, buffers_scanned, "
+					  . "coalesce(avg_sweep_distance, 0) "
+					  . "FROM pg_stat_buffer_policy WHERE policy = '$policy'"
+				));
+			my $accesses = $blks_hit + $blks_read;
+
+			push @runs,
+			  {
+				policy => $policy,
+				pattern => $pattern,
+				size_ratio => $ratio,
+				scale => $scale,
+				table_bytes => $table_bytes,
+				tps => $tps // 'null',
+				transactions => scalar(@$latencies),
+				blks_hit => $blks_hit,
+				blks_read => $blks_read,
+				hit_ratio => $accesses
+				? sprintf('%.6f', $blks_hit / $accesses)
+				: 'null',
+				evictions => $evictions // 0,
+				victim_searches => $searches // 0,
+				buffers_scanned => $scanned // 0,
+				avg_sweep_distance => $sweep // 0,
+				latency_us_p50 => percentile($latencies, 50),
+				latency_us_p90 => percentile($latencies, 90),
+				latency_us_p99 => percentile($latencies, 99),
+				latency_us_p999 => percentile($latencies, 99.9),
+				latency_us_max => percentile($latencies, 100),
+			  };
+		}
+	}
+}
+
+# Write the report.  Every value above is either numeric or a plain word, so
+# only the string fields need quoting.
+my %strings = map { $_ => 1 } qw(policy pattern);
+my @keys = qw(policy pattern size_ratio scale table_bytes tps transactions
+  blks_hit blks_read hit_ratio evictions victim_searches buffers_scanned
+  avg_sweep_distance latency_us_p50 latency_us_p90 latency_us_p99
+  latency_us_p999 latency_us_max);
+my @lines;
+
+for my $run (@runs)
+{
+	push @lines,
+	  '    {'
+	  . join(', ',
+		map { $strings{$_} ? qq("$_": "$run->{$_}") : qq("$_": $run->{$_}) }
+		  @keys)
+	  . '}';
+}
+
+open my $fh, '>', $report or die "could not open \"$report\": $!";
+print $fh "{\n";
+print $fh qq(  "shared_buffers_bytes": $sb_bytes,\n);
+print $fh qq(  "clients": $clients,\n);
+print $fh qq(  "duration_s": $duration,\n);
+print $fh qq(  "warmup_s": $warmup,\n);
+print $fh qq(  "runs": [\n), join(",\n", @lines), "\n  ]\n";
+print $fh "}\n";
+close $fh;
+
+note "buffer policy benchmark report written to $report";
+
+$node->stop;
+
+done_testing();
@@ -0,0 +1,968 @@
+/*-------------------------------------------------------------------------
+ *
+ * bufpolicy.c
+ *	  Buffer replacement policies for a buffer pool used by one process
+ *
+ * These are single-threaded versions of the built-in policies for shared
+ * buffers in storage/buffer/freelist.c: no atomics, no locks, no hit
+ * batching, one clock hand and one LRU list, and EAclock ages all values at
+ * once as soon as it decides to.  The server uses them for local buffers
+ * (see storage/buffer/localpolicy.c), and pg_bufsim to replay traces of
+ * shared buffer accesses, so that both behave the same.
+ *
+ * The caller keeps track of which page is in which buffer, and of the
+ * buffers that hold no page, and reports every hit, every page loaded and
+ * every buffer emptied.  BufPolicyGetVictim() is only asked for a buffer
+ * once every buffer holds a page that the policy was told about, but it may
+ * be asked again before the page is loaded, if the caller couldn't use the
+ * buffer after all.  Until then, the victim stays where it is or is moved to
+ * where its new page will go, so that it's not lost.
+ *
+ * All memory is allocated by BufPolicyCreate(), in the current memory
+ * context in the backend, and never freed.
+ *
+ * Portions Copyright (c) 1996-2023, PostgreSQL Global Development Group
+ *
+ *
+ * IDENTIFICATION
+ *	  src/common/bufpolicy.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef FRONTEND
+#include "postgres.h"
+#else
+#include "postgres_fe.h"
+#endif
+
+#include <float.h>
+
+#include "common/bufpolicy.h"
+#include "common/hashfn.h"
+#include "common/pg_prng.h"
+
+#define EACLOCK_MAX_VALUE		PG_UINT8_MAX
+#define EACLOCK_INITIAL_WEIGHT	2
+#define S3FIFO_MAX_FREQ			3
+
+const char *const BufPolicyNames[NUM_BUFPOLICIES] = {
+	[BUFPOLICY_CLOCKSWEEP] = "clocksweep",
+	[BUFPOLICY_CLOCK] = "clock",
+	[BUFPOLICY_LRU] = "lru",
+	[BUFPOLICY_RANDOM] = "random",
+	[BUFPOLICY_HYPERBOLIC] = "hyperbolic",
+	[BUFPOLICY_EACLOCK] = "eaclock",
+	[BUFPOLICY_EACLOCK_FDW] = "eaclock_fdw",
+	[BUFPOLICY_EACLOCK_FWA] = "eaclock_fwa",
+	[BUFPOLICY_ARC] = "arc",
+	[BUFPOLICY_S3FIFO] = "s3fifo",
+};
+
+/*
+ * Recently evicted pages for arc and s3fifo, by hash code of the page, on up
+ * to two lists, most recently added first.  The entries are found through a
+ * fixed-size chained hash table, so that nothing is allocated after setup.
+ */
+typedef struct BufPolicyGhosts
+{
+	int			capacity;
+	Queue		lists[2];
+	Queue		free;			/* unused entries */
+	QueueLink  *links;
+	uint32	   *hashcodes;
+	uint8	   *list;			/* which list the entry is on */
+	int		   *buckets;		/* first entry of each hash chain, or -1 */
+	int		   *chain;			/* next entry of the same chain, or -1 */
+	uint32		bucket_mask;
+} BufPolicyGhosts;
+
+typedef struct BufPolicyRoutine
+{
+	void		(*init) (BufPolicyPool *pool);
+	int			(*get_victim) (BufPolicyPool *pool);
+	void		(*on_hit) (BufPolicyPool *pool, int buf_id);
+	void		(*on_load) (BufPolicyPool *pool, int buf_id);
+	void		(*on_invalidate) (BufPolicyPool *pool, int buf_id);
+	void		(*seed) (BufPolicyPool *pool, int buf_id, int usage);
+} BufPolicyRoutine;
+
+struct BufPolicyPool
+{
+	const BufPolicyRoutine *routine;
+	const BufPolicyOptions *options;
+	int			nbuffers;
+
+	/* policy state; each policy uses what it needs */
+	int			hand;			/* clock hand */
+	uint8	   *values;			/* usage counts, reference bits, ... */
+	QueueLink  *links;
+	Queue		queues[2];		/* T1 and T2, S and M, or lru's one list */
+	uint64	   *loadTime;
+	uint32	   *accesses;
+	uint64		clock;
+	pg_prng_state prng;
+
+	/* EAclock adaptation, see freelist.c */
+	bool		eaCounting;
+	bool		eaIsChange;
+	uint32		eaWeight;
+	int			eaLastAction;
+	double		eaLastHR;
+	uint64		eaHits;
+	uint64		eaEvictions;
+	uint64		eaLastHits;
+	uint64		eaLastEvictions;
+	uint64		eaPeriodEnd;
+
+	/* arc and s3fifo */
+	uint8	   *freqs;
+	int			targetT1;
+	BufPolicyGhosts ghosts;
+};
+
+static void *
+BufPolicyAlloc(Size size)
+{
+	return palloc_extended(size, MCXT_ALLOC_HUGE | MCXT_ALLOC_ZERO);
+}
+
+static inline bool
+BufPolicyIsPinned(BufPolicyPool *pool, int buf_id)
+{
+	return pool->options->is_pinned != NULL &&
+		pool->options->is_pinned(buf_id, pool->options->arg);
+}
+
+/* Advance the clock hand and return the buffer it was on */
+static inline int
+ClockTick(BufPolicyPool *pool)
+{
+	int			buf_id = pool->hand;
+
+	if (++pool->hand >= pool->nbuffers)
+		pool->hand = 0;
+
+	return buf_id;
+}
+
+static void
+ValuesInit(BufPolicyPool *pool)
+{
+	pool->values = BufPolicyAlloc(pool->nbuffers);
+}
+
+static void
+ValuesInvalidate(BufPolicyPool *pool, int buf_id)
+{
+	pool->values[buf_id] = 0;
+}
+
+/*
+ * "clocksweep": usage counts, bumped on every hit up to a limit.
+ */
+static int
+ClockSweepGetVictim(BufPolicyPool *pool)
+{
+	int			trycounter = pool->nbuffers;
+
+	for (;;)
+	{
+		int			buf_id = ClockTick(pool);
+
+		if (BufPolicyIsPinned(pool, buf_id))
+		{
+			if (--trycounter == 0)
+				return -1;
+			continue;
+		}
+		if (pool->values[buf_id] == 0)
+			return buf_id;
+		pool->values[buf_id]--;
+		trycounter = pool->nbuffers;
+	}
+}
+
+static void
+ClockSweepHit(BufPolicyPool *pool, int buf_id)
+{
+	if (pool->values[buf_id] < pool->options->max_usage)
+		pool->values[buf_id]++;
+}
+
+static void
+ClockSweepLoad(BufPolicyPool *pool, int buf_id)
+{
+	pool->values[buf_id] = 1;
+}
+
+static void
+ClockSweepSeed(BufPolicyPool *pool, int buf_id, int usage)
+{
+	pool->values[buf_id] = Min(usage, pool->options->max_usage);
+}
+
+/*
+ * "clock": one reference bit per buffer.
+ */
+static int
+ClockGetVictim(BufPolicyPool *pool)
+{
+	int			trycounter = pool->nbuffers;
+
+	for (;;)
+	{
+		int			buf_id = ClockTick(pool);
+
+		if (BufPolicyIsPinned(pool, buf_id))
+		{
+			if (--trycounter == 0)
+				return -1;
+			continue;
+		}
+		if (pool->values[buf_id] == 0)
+			return buf_id;
+		pool->values[buf_id] = 0;
+		trycounter = pool->nbuffers;
+	}
+}
+
+static void
+ClockAccess(BufPolicyPool *pool, int buf_id)
+{
+	pool->values[buf_id] = 1;
+}
+
+static void
+ClockSeed(BufPolicyPool *pool, int buf_id, int usage)
+{
+	pool->values[buf_id] = usage > 0;
+}
+
+/*
+ * Queues 1 and 2 of lru, arc and s3fifo.  values[] says which queue a buffer
+ * is on, or 0.
+ */
+static void
+QueuesInit(BufPolicyPool *pool)
+{
+	ValuesInit(pool);
+	pool->links = BufPolicyAlloc(pool->nbuffers * sizeof(QueueLink));
+	QueueInit(&pool->queues[0]);
+	QueueInit(&pool->queues[1]);
+}
+
+static void
+QueueMoveToHead(BufPolicyPool *pool, int buf_id, int where)
+{
+	if (pool->values[buf_id] != 0)
+		QueueRemove(&pool->queues[pool->values[buf_id] - 1], pool->links,
+					buf_id);
+	QueuePushHead(&pool->queues[where - 1], pool->links, buf_id);
+	pool->values[buf_id] = where;
+}
+
+static void
+QueuesRemove(BufPolicyPool *pool, int buf_id)
+{
+	if (pool->values[buf_id] == 0)
+		return;
+	QueueRemove(&pool->queues[pool->values[buf_id] - 1], pool->links, buf_id);
+	pool->values[buf_id] = 0;
+}
+
+/*
+ * Return the unpinned buffer nearest the tail of a queue, or -1 if there is
+ * none.
+ */
+static int
+QueueTailUnpinned(BufPolicyPool *pool, int where)
+{
+	for (int buf_id = pool->queues[where - 1].tail; buf_id >= 0;
+		 buf_id = pool->links[buf_id].prev)
+	{
+		if (!BufPolicyIsPinned(pool, buf_id))
+			return buf_id;
+	}
+
+	return -1;
+}
+
+/*
+ * "lru": a single queue, most recently used first.  The victim stays at the
+ * tail until its new page moves it to the head.
+ */
+static int
+LRUGetVictim(BufPolicyPool *pool)
+{
+	return QueueTailUnpinned(pool, 1);
+}
+
+static void
+LRUAccess(BufPolicyPool *pool, int buf_id)
+{
+	QueueMoveToHead(pool, buf_id, 1);
+}
+
+/*
+ * "random": a uniformly chosen unpinned buffer.
+ */
+static int
+RandomGetVictim(BufPolicyPool *pool)
+{
+	/* as in freelist.c, allow for drawing the same pinned buffers again */
+	int			trycounter = pool->nbuffers * 4;
+
+	for (;;)
+	{
+		int			buf_id;
+
+		buf_id = (int) pg_prng_uint64_range(&pool->prng, 0, pool->nbuffers - 1);
+		if (!BufPolicyIsPinned(pool, buf_id))
+			return buf_id;
+		if (--trycounter == 0)
+			return -1;
+	}
+}
+
+/*
+ * "hyperbolic": out of a random sample of sample_size buffers, the one with
+ * the lowest priority.
+ */
+static void
+HyperbolicInit(BufPolicyPool *pool)
+{
+	pool->loadTime = BufPolicyAlloc(pool->nbuffers * sizeof(uint64));
+	pool->accesses = BufPolicyAlloc(pool->nbuffers * sizeof(uint32));
+}
+
+static double
+HyperbolicPriority(BufPolicyPool *pool, int buf_id)
+{
+	switch (pool->options->priority)
+	{
+		case HYPERBOLIC_PRIORITY_HYPERBOLIC:
+			return (double) pool->accesses[buf_id] /
+				(pool->clock - pool->loadTime[buf_id] + 1);
+		case HYPERBOLIC_PRIORITY_LFU:
+			return pool->accesses[buf_id];
+		case HYPERBOLIC_PRIORITY_FIFO:
+			return pool->loadTime[buf_id];
+	}
+
+	return 0;					/* keep compiler quiet */
+}
+
+static int
+HyperbolicGetVictim(BufPolicyPool *pool)
+{
+	int			victim = -1;
+	double		victim_priority = DBL_MAX;
+	int			trycounter = pool->nbuffers;
+	int			nsample = 0;
+
+	while (nsample < pool->options->sample_size)
+	{
+		int			buf_id;
+		double		priority;
+
+		buf_id = (int) pg_prng_uint64_range(&pool->prng, 0, pool->nbuffers - 1);
+		if (BufPolicyIsPinned(pool, buf_id))
+		{
+			/* Make do with a smaller sample, if there is one */
+			if (--trycounter > 0)
+				continue;
+			break;
+		}
+
+		priority = HyperbolicPriority(pool, buf_id);
+		if (victim < 0 || priority < victim_priority)
+		{
+			victim = buf_id;
+			victim_priority = priority;
+		}
+		nsample++;
+	}
+
+	return victim;
+}
+
+static void
+HyperbolicHit(BufPolicyPool *pool, int buf_id)
+{
+	pool->accesses[buf_id]++;
+}
+
+static void
+HyperbolicLoad(BufPolicyPool *pool, int buf_id)
+{
+	pool->loadTime[buf_id] = pool->clock++;
+	pool->accesses[buf_id] = 1;
+}
+
+static void
+HyperbolicSeed(BufPolicyPool *pool, int buf_id, int usage)
+{
+	pool->loadTime[buf_id] = pool->clock;
+	pool->accesses[buf_id] = Max(usage, 1);
+}
+
+/*
+ * "eaclock", "eaclock_fdw" and "eaclock_fwa": a clock over per-buffer values
+ * that grow by an adaptive weight on each access.  See freelist.c.
+ */
+static void
+EAclockInit(BufPolicyPool *pool)
+{
+	ValuesInit(pool);
+	pool->eaWeight = EACLOCK_INITIAL_WEIGHT;
+	pool->eaLastAction = 1;
+	pool->eaPeriodEnd = Max(pool->nbuffers / 2, 1);
+}
+
+static void
+EAclockEndPeriod(BufPolicyPool *pool, bool fdw)
+{
+	double		period_hits = pool->eaHits - pool->eaLastHits;
+	double		period_evictions = pool->eaEvictions - pool->eaLastEvictions;
+	double		newHR = period_hits / (period_hits + period_evictions);
+	int			weight = pool->eaWeight;
+
+	pool->eaIsChange = false;
+
+	if (newHR > pool->eaLastHR)
+		weight += pool->eaLastAction;
+	else if (!fdw)
+	{
+		pool->eaLastAction = -pool->eaLastAction;
+		weight += pool->eaLastAction;
+	}
+	else if (pool->eaLastHR - newHR > 0.3 * (1 - pool->eaLastHR))
+	{
+		/* The hit ratio collapsed; age all buffers */
+		pool->eaIsChange = true;
+		for (int i = 0; i < pool->nbuffers; i++)
+			pool->values[i] /= 2;
+	}
+
+	pool->eaLastHR = newHR;
+
+	if (weight <= 0)
+	{
+		weight = 1;
+		pool->eaLastHR = newHR - 0.01;
+		pool->eaLastAction = -1;
+	}
+	else if (weight >= 16)
+	{
+		weight = 16;
+		pool->eaLastHR = newHR - 0.01;
+		pool->eaLastAction = 1;
+	}
+
+	pool->eaWeight = weight;
+	pool->eaLastHits = pool->eaHits;
+	pool->eaLastEvictions = pool->eaEvictions;
+	pool->eaPeriodEnd = pool->eaEvictions + Max(pool->nbuffers / 2, 1);
+}
+
+static pg_attribute_always_inline int
+EAclockGetVictimInternal(BufPolicyPool *pool, bool fdw)
+{
+	int			trycounter = pool->nbuffers;
+
+	pool->eaCounting = true;
+
+	for (;;)
+	{
+		int			buf_id = ClockTick(pool);
+		uint8	   *value = &pool->values[buf_id];
+
+		if (BufPolicyIsPinned(pool, buf_id))
+		{
+			if (--trycounter == 0)
+				return -1;
+			continue;
+		}
+		if (*value == 0)
+		{
+			if (++pool->eaEvictions >= pool->eaPeriodEnd)
+				EAclockEndPeriod(pool, fdw);
+			return buf_id;
+		}
+		*value = pool->eaIsChange ? *value / 2 : *value - 1;
+		trycounter = pool->nbuffers;
+	}
+}
+
+static int
+EAclockGetVictim(BufPolicyPool *pool)
+{
+	return EAclockGetVictimInternal(pool, false);
+}
+
+static int
+EAclockFdwGetVictim(BufPolicyPool *pool)
+{
+	return EAclockGetVictimInternal(pool, true);
+}
+
+static inline void
+EAclockHitInternal(BufPolicyPool *pool, int buf_id, uint32 weight)
+{
+	pool->values[buf_id] = Min(pool->values[buf_id] + weight,
+							   EACLOCK_MAX_VALUE);
+	if (pool->eaCounting)
+		pool->eaHits++;
+}
+
+static void
+EAclockHit(BufPolicyPool *pool, int buf_id)
+{
+	EAclockHitInternal(pool, buf_id, pool->eaWeight);
+}
+
+static void
+EAclockFwaHit(BufPolicyPool *pool, int buf_id)
+{
+	EAclockHitInternal(pool, buf_id, 2 * pool->eaWeight);
+}
+
+static void
+EAclockLoad(BufPolicyPool *pool, int buf_id)
+{
+	pool->values[buf_id] = Min(pool->eaWeight, EACLOCK_MAX_VALUE);
+}
+
+static void
+EAclockFwaLoad(BufPolicyPool *pool, int buf_id)
+{
+	pool->values[buf_id] = Min(2 * pool->eaWeight, EACLOCK_MAX_VALUE);
+}
+
+static void
+EAclockSeed(BufPolicyPool *pool, int buf_id, int usage)
+{
+	pool->values[buf_id] = Min(usage * EACLOCK_INITIAL_WEIGHT,
+							   EACLOCK_MAX_VALUE);
+}
+
+/*
+ * Ghost lists for "arc" and "s3fifo".
+ */
+static void
+GhostInit(BufPolicyGhosts *ghosts, int capacity)
+{
+	int			nbuckets = 1;
+
+	while (nbuckets < capacity)
+		nbuckets <<= 1;
+
+	ghosts->capacity = capacity;
+	QueueInit(&ghosts->lists[0]);
+	QueueInit(&ghosts->lists[1]);
+	QueueInit(&ghosts->free);
+	ghosts->links = BufPolicyAlloc(capacity * sizeof(QueueLink));
+	ghosts->hashcodes = BufPolicyAlloc(capacity * sizeof(uint32));
+	ghosts->list = BufPolicyAlloc(capacity);
+	ghosts->chain = BufPolicyAlloc(capacity * sizeof(int));
+	ghosts->buckets = BufPolicyAlloc(nbuckets * sizeof(int));
+	ghosts->bucket_mask = nbuckets - 1;
+	for (int i = 0; i < nbuckets; i++)
+		ghosts->buckets[i] = -1;
+	for (int i = 0; i < capacity; i++)
+		QueuePushHead(&ghosts->free, ghosts->links, i);
+}
+
+static inline uint32
+GhostHash(BufPolicyPool *pool, int buf_id)
+{
+	return pool->options->page_hash(buf_id, pool->options->arg);
+}
+
+/* Returns the list the page is remembered on, or -1, and forgets it */
+static int
+GhostTake(BufPolicyGhosts *ghosts, uint32 hashcode)
+{
+	int		   *prev = &ghosts->buckets[murmurhash32(hashcode) &
+										ghosts->bucket_mask];
+	int			ghost;
+	int			list;
+
+	for (ghost = *prev; ghost >= 0; ghost = *prev)
+	{
+		if (ghosts->hashcodes[ghost] == hashcode)
+			break;
+		prev = &ghosts->chain[ghost];
+	}
+	if (ghost < 0)
+		return -1;
+
+	*prev = ghosts->chain[ghost];
+	list = ghosts->list[ghost];
+	QueueRemove(&ghosts->lists[list], ghosts->links, ghost);
+	QueuePushHead(&ghosts->free, ghosts->links, ghost);
+
+	return list;
+}
+
+static void
+GhostRemoveOldest(BufPolicyGhosts *ghosts, int list)
+{
+	int			ghost = ghosts->lists[list].tail;
+
+	GhostTake(ghosts, ghosts->hashcodes[ghost]);
+}
+
+static void
+GhostAdd(BufPolicyGhosts *ghosts, int list, uint32 hashcode)
+{
+	int		   *bucket;
+	int			ghost;
+
+	GhostTake(ghosts, hashcode);
+	if (ghosts->free.count == 0)
+		GhostRemoveOldest(ghosts,
+						  ghosts->lists[list].count > 0 ? list : 1 - list);
+
+	ghost = ghosts->free.head;
+	QueueRemove(&ghosts->free, ghosts->links, ghost);
+	ghosts->hashcodes[ghost] = hashcode;
+	ghosts->list[ghost] = list;
+	QueuePushHead(&ghosts->lists[list], ghosts->links, ghost);
+	bucket = &ghosts->buckets[murmurhash32(hashcode) & ghosts->bucket_mask];
+	ghosts->chain[ghost] = *bucket;
+	*bucket = ghost;
+}
+
+/*
+ * "arc": resident queues T1 and T2 with ghost lists B1 and B2.
+ */
+#define ARC_T1	1
+#define ARC_T2	2
+
+static void
+ArcInit(BufPolicyPool *pool)
+{
+	QueuesInit(pool);
+	GhostInit(&pool->ghosts, pool->nbuffers);
+}
+
+static int
+ArcGetVictim(BufPolicyPool *pool)
+{
+	BufPolicyGhosts *ghosts = &pool->ghosts;
+	int			where;
+	int			buf_id;
+
+	if (pool->queues[0].count > 0 &&
+		(pool->queues[0].count > pool->targetT1 || pool->queues[1].count == 0))
+		where = ARC_T1;
+	else
+		where = ARC_T2;
+
+	buf_id = QueueTailUnpinned(pool, where);
+	if (buf_id < 0)
+	{
+		where = where == ARC_T1 ? ARC_T2 : ARC_T1;
+		buf_id = QueueTailUnpinned(pool, where);
+		if (buf_id < 0)
+			return -1;
+	}
+
+	/* Keep the buffer on T1 until its new page arrives, like freelist.c */
+	QueueMoveToHead(pool, buf_id, ARC_T1);
+
+	/* Remember the page on B1 or B2 */
+	if (where == ARC_T1 && ghosts->lists[0].count > 0 &&
+		pool->queues[0].count + ghosts->lists[0].count >= pool->nbuffers)
+		GhostRemoveOldest(ghosts, 0);
+	if (ghosts->lists[0].count + ghosts->lists[1].count >= pool->nbuffers)
+		GhostRemoveOldest(ghosts, ghosts->lists[1].count > 0 ? 1 : 0);
+	GhostAdd(ghosts, where - 1, GhostHash(pool, buf_id));
+
+	return buf_id;
+}
+
+static void
+ArcHit(BufPolicyPool *pool, int buf_id)
+{
+	QueueMoveToHead(pool, buf_id, ARC_T2);
+}
+
+static void
+ArcLoad(BufPolicyPool *pool, int buf_id)
+{
+	BufPolicyGhosts *ghosts = &pool->ghosts;
+	int			b1 = ghosts->lists[0].count;
+	int			b2 = ghosts->lists[1].count;
+
+	switch (GhostTake(ghosts, GhostHash(pool, buf_id)))
+	{
+		case 0:
+			pool->targetT1 = Min(pool->targetT1 + Max(b2 / b1, 1),
+								 pool->nbuffers);
+			QueueMoveToHead(pool, buf_id, ARC_T2);
+			break;
+		case 1:
+			pool->targetT1 = Max(pool->targetT1 - Max(b1 / b2, 1), 0);
+			QueueMoveToHead(pool, buf_id, ARC_T2);
+			break;
+		default:
+			QueueMoveToHead(pool, buf_id, ARC_T1);
+			break;
+	}
+}
+
+static void
+ArcSeed(BufPolicyPool *pool, int buf_id, int usage)
+{
+	QueueMoveToHead(pool, buf_id, usage > 1 ? ARC_T2 : ARC_T1);
+}
+
+/*
+ * "s3fifo": FIFO queues S and M and a ghost FIFO for pages evicted from S.
+ */
+#define S3FIFO_SMALL	1
+#define S3FIFO_MAIN		2
+
+static void
+S3FifoInit(BufPolicyPool *pool)
+{
+	ArcInit(pool);
+	pool->freqs = BufPolicyAlloc(pool->nbuffers);
+}
+
+static int
+S3FifoGetVictim(BufPolicyPool *pool)
+{
+	int			small_target = Max(pool->nbuffers / 10, 1);
+
+	/* Every buffer is moved at most a few times before one is picked */
+	for (int64 tries = 0; tries < (int64) (S3FIFO_MAX_FREQ + 2) * pool->nbuffers; tries++)
+	{
+		int			buf_id;
+
+		if (pool->queues[0].count > 0 &&
+			(pool->queues[0].count >= small_target || pool->queues[1].count == 0))
+		{
+			buf_id = pool->queues[0].tail;
+			if (BufPolicyIsPinned(pool, buf_id) || pool->freqs[buf_id] > 0)
+			{
+				/* pinned buffers are in use, so they count as used again */
+				pool->freqs[buf_id] = 0;
+				QueueMoveToHead(pool, buf_id, S3FIFO_MAIN);
+				continue;
+			}
+			while (pool->ghosts.lists[0].count > 0 &&
+				   pool->ghosts.lists[0].count >= pool->nbuffers - small_target)
+				GhostRemoveOldest(&pool->ghosts, 0);
+			GhostAdd(&pool->ghosts, 0, GhostHash(pool, buf_id));
+		}
+		else
+		{
+			buf_id = pool->queues[1].tail;
+			if (BufPolicyIsPinned(pool, buf_id) || pool->freqs[buf_id] > 0)
+			{
+				if (pool->freqs[buf_id] > 0)
+					pool->freqs[buf_id]--;
+				QueueMoveToHead(pool, buf_id, S3FIFO_MAIN);
+				continue;
+			}
+		}
+
+		/* Keep the buffer on S until its new page arrives */
+		pool->freqs[buf_id] = 0;
+		QueueMoveToHead(pool, buf_id, S3FIFO_SMALL);
+		return buf_id;
+	}
+
+	return -1;
+}
+
+static void
+S3FifoHit(BufPolicyPool *pool, int buf_id)
+{
+	if (pool->freqs[buf_id] < S3FIFO_MAX_FREQ)
+		pool->freqs[buf_id]++;
+}
+
+static void
+S3FifoLoad(BufPolicyPool *pool, int buf_id)
+{
+	pool->freqs[buf_id] = 0;
+	if (GhostTake(&pool->ghosts, GhostHash(pool, buf_id)) >= 0)
+		QueueMoveToHead(pool, buf_id, S3FIFO_MAIN);
+	else
+		QueueMoveToHead(pool, buf_id, S3FIFO_SMALL);
+}
+
+static void
+S3FifoSeed(BufPolicyPool *pool, int buf_id, int usage)
+{
+	pool->freqs[buf_id] = Min(usage, S3FIFO_MAX_FREQ);
+	QueueMoveToHead(pool, buf_id, usage > 0 ? S3FIFO_MAIN : S3FIFO_SMALL);
+}
+
+/* indexed by BufPolicyType */
+static const BufPolicyRoutine BufPolicyRoutines[] = {
+	[BUFPOLICY_CLOCKSWEEP] = {
+		.init = ValuesInit,
+		.get_victim = ClockSweepGetVictim,
+		.on_hit = ClockSweepHit,
+		.on_load = ClockSweepLoad,
+		.on_invalidate = ValuesInvalidate,
+		.seed = ClockSweepSeed,
+	},
+	[BUFPOLICY_CLOCK] = {
+		.init = ValuesInit,
+		.get_victim = ClockGetVictim,
+		.on_hit = ClockAccess,
+		.on_load = ClockAccess,
+		.on_invalidate = ValuesInvalidate,
+		.seed = ClockSeed,
+	},
+	[BUFPOLICY_LRU] = {
+		.init = QueuesInit,
+		.get_victim = LRUGetVictim,
+		.on_hit = LRUAccess,
+		.on_load = LRUAccess,
+		.on_invalidate = QueuesRemove,
+	},
+	[BUFPOLICY_RANDOM] = {
+		.get_victim = RandomGetVictim,
+	},
+	[BUFPOLICY_HYPERBOLIC] = {
+		.init = HyperbolicInit,
+		.get_victim = HyperbolicGetVictim,
+		.on_hit = HyperbolicHit,
+		.on_load = HyperbolicLoad,
+		.seed = HyperbolicSeed,
+	},
+	[BUFPOLICY_EACLOCK] = {
+		.init = EAclockInit,
+		.get_victim = EAclockGetVictim,
+		.on_hit = EAclockHit,
+		.on_load = EAclockLoad,
+		.on_invalidate = ValuesInvalidate,
+		.seed = EAclockSeed,
+	},
+	[BUFPOLICY_EACLOCK_FDW] = {
+		.init = EAclockInit,
+		.get_victim = EAclockFdwGetVictim,
+		.on_hit = EAclockHit,
+		.on_load = EAclockLoad,
+		.on_invalidate = ValuesInvalidate,
+		.seed = EAclockSeed,
+	},
+	[BUFPOLICY_EACLOCK_FWA] = {
+		.init = EAclockInit,
+		.get_victim = EAclockGetVictim,
+		.on_hit = EAclockFwaHit,
+		.on_load = EAclockFwaLoad,
+		.on_invalidate = ValuesInvalidate,
+		.seed = EAclockSeed,
+	},
+	[BUFPOLICY_ARC] = {
+		.init = ArcInit,
+		.get_victim = ArcGetVictim,
+		.on_hit = ArcHit,
+		.on_load = ArcLoad,
+		.on_invalidate = QueuesRemove,
+		.seed = ArcSeed,
+	},
+	[BUFPOLICY_S3FIFO] = {
+		.init = S3FifoInit,
+		.get_victim = S3FifoGetVictim,
+		.on_hit = S3FifoHit,
+		.on_load = S3FifoLoad,
+		.on_invalidate = QueuesRemove,
+		.seed = S3FifoSeed,
+	},
+};
+
+StaticAssertDecl(lengthof(BufPolicyRoutines) == NUM_BUFPOLICIES,
+				 "BufPolicyRoutines[] must match BufPolicyType");
+
+/*
+ * BufPolicyCreate -- set up a policy for a pool of nbuffers buffers, which
+ * hold no pages yet
+ *
+ * options must stay valid as long as the pool is used.  seed seeds the
+ * random numbers drawn by random and hyperbolic.
+ */
+BufPolicyPool *
+BufPolicyCreate(BufPolicyType type, int nbuffers,
+				const BufPolicyOptions *options, uint64 seed)
+{
+	BufPolicyPool *pool;
+
+	Assert(type >= 0 && type < NUM_BUFPOLICIES);
+	Assert(nbuffers > 0);
+
+	pool = BufPolicyAlloc(sizeof(BufPolicyPool));
+	pool->routine = &BufPolicyRoutines[type];
+	pool->options = options;
+	pool->nbuffers = nbuffers;
+	pg_prng_seed(&pool->prng, seed);
+
+	if (pool->routine->init)
+		pool->routine->init(pool);
+
+	return pool;
+}
+
+/*
+ * BufPolicyGetVictim -- choose an unpinned buffer to reuse
+ *
+ * Returns -1 if every buffer the policy looked at was pinned.
+ */
+int
+BufPolicyGetVictim(BufPolicyPool *pool)
+{
+	return pool->routine->get_victim(pool);
+}
+
+/*
+ * BufPolicyHit -- report an access to the page in a buffer
+ */
+void
+BufPolicyHit(BufPolicyPool *pool, int buf_id)
+{
+	if (pool->routine->on_hit)
+		pool->routine->on_hit(pool, buf_id);
+}
+
+/*
+ * BufPolicyLoad -- report that a buffer now holds a new page
+ */
+void
+BufPolicyLoad(BufPolicyPool *pool, int buf_id)
+{
+	if (pool->routine->on_load)
+		pool->routine->on_load(pool, buf_id);
+}
+
+/*
+ * BufPolicyInvalidate -- report that a buffer holds no page anymore
+ */
+void
+BufPolicyInvalidate(BufPolicyPool *pool, int buf_id)
+{
+	if (pool->routine->on_invalidate)
+		pool->routine->on_invalidate(pool, buf_id);
+}
+
+/*
+ * BufPolicySeed -- tell a new pool about a page that's already in a buffer,
+ * with the usage count it had
+ *
+ * Pages are to be passed in increasing order of usage count.
+ */
+void
+BufPolicySeed(BufPolicyPool *pool, int buf_id, int usage)
+{
+	if (pool->routine->seed)
+		pool->routine->seed(pool, buf_id, usage);
+	else
+		BufPolicyLoad(pool, buf_id);
+}
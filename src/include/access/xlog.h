@@ -26,6 +26,11 @@
 #define SYNC_METHOD_OPEN_DSYNC	4	/* for O_DSYNC */
 extern PGDLLIMPORT int sync_method;
 
+/* WAL I/O methods */
+#define WAL_IO_METHOD_SYNC		0
+#define WAL_IO_METHOD_IO_URING	1
+extern PGDLLIMPORT int wal_io_method;
+
 extern PGDLLIMPORT XLogRecPtr ProcLastRecPtr;
 extern PGDLLIMPORT XLogRecPtr XactLastRecEnd;
 extern PGDLLIMPORT XLogRecPtr XactLastCommitEnd;
@@ -51,9 +56,18 @@ extern PGDLLIMPORT char *wal_consistency_checking_string;
 extern PGDLLIMPORT bool log_checkpoints;
 extern PGDLLIMPORT bool track_wal_io_timing;
 extern PGDLLIMPORT int wal_decode_buffer_size;
+extern PGDLLIMPORT int wal_insert_locks;
+extern PGDLLIMPORT bool wal_group_commit;
 
 extern PGDLLIMPORT int CheckPointSegments;
 
+/*
+ * Upper limit for wal_insert_locks.  Some operations acquire all of the
+ * insertion locks at once, so this must stay comfortably below the number
+ * of LWLocks a backend can hold simultaneously.
+ */
+#define MAX_WAL_INSERT_LOCKS	128
+
 /* Archive modes */
 typedef enum ArchiveMode
 {
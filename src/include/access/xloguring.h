@@ -0,0 +1,35 @@
+/*------------------------------------------------------------------------
+ *
+ * xloguring.h
+ *		Prototypes for writing WAL through io_uring
+ *
+ * Portions Copyright (c) 1996-2023, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *		src/include/access/xloguring.h
+ *
+ *------------------------------------------------------------------------
+ */
+
+#ifndef XLOG_URING_H
+#define XLOG_URING_H
+
+#include "access/xlogdefs.h"
+
+/*
+ * io_uring is only available on Linux, and we need kernel headers that know
+ * about IORING_OP_WRITE (Linux 5.6 and later).
+ */
+#if defined(HAVE_DECL_IORING_OP_WRITE) && HAVE_DECL_IORING_OP_WRITE
+#define USE_WAL_IO_URING 1
+#endif
+
+extern bool XLogUringStart(void);
+extern bool XLogUringPending(void);
+extern void XLogUringQueueWrite(int fd, char *buf, Size nbytes, off_t offset,
+								XLogSegNo segno, TimeLineID tli);
+extern void XLogUringQueueSync(int fd, XLogSegNo segno, TimeLineID tli);
+extern void XLogUringWait(void);
+
+#endif							/* XLOG_URING_H */
@@ -0,0 +1,134 @@
+/*-------------------------------------------------------------------------
+ *
+ * bufpolicy.h
+ *	  Buffer replacement policies for a buffer pool used by one process
+ *
+ * These are the built-in replacement policies of the shared buffer pool
+ * (see storage/buffer/freelist.c), minus what only matters with concurrent
+ * access.  The server uses them for local buffers, and pg_bufsim to
+ * simulate shared buffers.
+ *
+ * Portions Copyright (c) 1996-2023, PostgreSQL Global Development Group
+ *
+ * src/include/common/bufpolicy.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef COMMON_BUFPOLICY_H
+#define COMMON_BUFPOLICY_H
+
+typedef enum BufPolicyType
+{
+	BUFPOLICY_CLOCKSWEEP,
+	BUFPOLICY_CLOCK,
+	BUFPOLICY_LRU,
+	BUFPOLICY_RANDOM,
+	BUFPOLICY_HYPERBOLIC,
+	BUFPOLICY_EACLOCK,
+	BUFPOLICY_EACLOCK_FDW,
+	BUFPOLICY_EACLOCK_FWA,
+	BUFPOLICY_ARC,
+	BUFPOLICY_S3FIFO
+} BufPolicyType;
+
+#define NUM_BUFPOLICIES		(BUFPOLICY_S3FIFO + 1)
+
+/* policy names, indexed by BufPolicyType */
+extern PGDLLIMPORT const char *const BufPolicyNames[NUM_BUFPOLICIES];
+
+/* Possible values for hyperbolic_priority */
+typedef enum HyperbolicPriorityFunction
+{
+	HYPERBOLIC_PRIORITY_HYPERBOLIC, /* accesses / time in the pool */
+	HYPERBOLIC_PRIORITY_LFU,	/* accesses */
+	HYPERBOLIC_PRIORITY_FIFO	/* load order */
+} HyperbolicPriorityFunction;
+
+/*
+ * Settings of a pool, and what the policies need to know about its buffers.
+ * The pool keeps a pointer to this, and reads the settings at each call, so
+ * they can be changed in between.
+ *
+ * is_pinned tells whether a buffer is in use and so mustn't be chosen as a
+ * victim; if NULL, no buffer ever is.  page_hash returns a hash code of the
+ * page in a buffer, used by arc and s3fifo to remember evicted pages.
+ */
+typedef struct BufPolicyOptions
+{
+	int			max_usage;		/* clocksweep's usage count limit */
+	int			sample_size;	/* hyperbolic's sample size */
+	HyperbolicPriorityFunction priority;	/* hyperbolic's priority */
+	bool		(*is_pinned) (int buf_id, void *arg);
+	uint32		(*page_hash) (int buf_id, void *arg);
+	void	   *arg;			/* passed to the callbacks */
+} BufPolicyOptions;
+
+typedef struct BufPolicyPool BufPolicyPool;
+
+extern BufPolicyPool *BufPolicyCreate(BufPolicyType type, int nbuffers,
+									  const BufPolicyOptions *options,
+									  uint64 seed);
+extern int	BufPolicyGetVictim(BufPolicyPool *pool);
+extern void BufPolicyHit(BufPolicyPool *pool, int buf_id);
+extern void BufPolicyLoad(BufPolicyPool *pool, int buf_id);
+extern void BufPolicyInvalidate(BufPolicyPool *pool, int buf_id);
+extern void BufPolicySeed(BufPolicyPool *pool, int buf_id, int usage);
+
+/*
+ * Doubly linked queues of buffer (or other) ids, threaded through an array
+ * of QueueLinks with one entry per id, for the queue-based replacement
+ * policies here and in freelist.c.  A queue's head is its newest entry and
+ * its tail its oldest.  An id can be on one queue at a time, and callers
+ * keep track of which.
+ */
+typedef struct
+{
+	int32		prev;			/* towards the head, or -1 */
+	int32		next;			/* towards the tail, or -1 */
+} QueueLink;
+
+typedef struct
+{
+	int32		head;
+	int32		tail;
+	int32		count;
+} Queue;
+
+static inline void
+QueueInit(Queue *queue)
+{
+	queue->head = -1;
+	queue->tail = -1;
+	queue->count = 0;
+}
+
+static inline void
+QueuePushHead(Queue *queue, QueueLink *links, int i)
+{
+	links[i].prev = -1;
+	links[i].next = queue->head;
+	if (queue->head >= 0)
+		links[queue->head].prev = i;
+	else
+		queue->tail = i;
+	queue->head = i;
+	queue->count++;
+}
+
+static inline void
+QueueRemove(Queue *queue, QueueLink *links, int i)
+{
+	if (links[i].prev >= 0)
+		links[links[i].prev].next = links[i].next;
+	else
+		queue->head = links[i].next;
+	if (links[i].next >= 0)
+		links[links[i].next].prev = links[i].prev;
+	else
+		queue->tail = links[i].prev;
+	links[i].prev = -1;
+	links[i].next = -1;
+	queue->count--;
+}
+
+#endif							/* COMMON_BUFPOLICY_H */
@@ -47,6 +47,7 @@ typedef enum PgStat_Kind
 	/* stats for fixed-numbered objects */
 	PGSTAT_KIND_ARCHIVER,
 	PGSTAT_KIND_BGWRITER,
+	PGSTAT_KIND_BUFFER_POLICY,
 	PGSTAT_KIND_CHECKPOINTER,
 	PGSTAT_KIND_IO,
 	PGSTAT_KIND_SLRU,
@@ -235,7 +236,7 @@ typedef struct PgStat_TableXactStatus
  * ------------------------------------------------------------
  */
 
-#define PGSTAT_FILE_FORMAT_ID	0x01A5BCAC
+#define PGSTAT_FILE_FORMAT_ID	0x01A5BCAE
 
 typedef struct PgStat_ArchiverStats
 {
@@ -258,6 +259,35 @@ typedef struct PgStat_BgWriterStats
 	TimestampTz stat_reset_timestamp;
 } PgStat_BgWriterStats;
 
+/* number of EAclock adaptation periods remembered */
+#define PGSTAT_EACLOCK_HISTORY_SIZE	16
+
+typedef struct PgStat_EAclockPeriod
+{
+	int32		weight;			/* access weight chosen for the next period */
+	double		hit_ratio;		/* hit ratio of the period that ended */
+} PgStat_EAclockPeriod;
+
+typedef struct PgStat_BufferPolicyStats
+{
+	PgStat_Counter freelist_allocs;
+	PgStat_Counter evictions;
+	PgStat_Counter queue_allocs;
+	PgStat_Counter searches;
+	PgStat_Counter buffers_scanned;
+	PgStat_Counter pinned_skips;
+	PgStat_Counter clock_passes;
+	PgStat_Counter eaclock_agings;
+
+	/*
+	 * Adaptation periods ended so far.  The most recent ones are kept in
+	 * eaclock_history, period i in slot i % PGSTAT_EACLOCK_HISTORY_SIZE.
+	 */
+	PgStat_Counter eaclock_periods;
+	PgStat_EAclockPeriod eaclock_history[PGSTAT_EACLOCK_HISTORY_SIZE];
+	TimestampTz stat_reset_timestamp;
+} PgStat_BufferPolicyStats;
+
 typedef struct PgStat_CheckpointerStats
 {
 	PgStat_Counter timed_checkpoints;
@@ -504,6 +534,22 @@ extern void pgstat_report_bgwriter(void);
 extern PgStat_BgWriterStats *pgstat_fetch_stat_bgwriter(void);
 
 
+/*
+ * Functions in pgstat_buffer_policy.c
+ */
+
+extern void pgstat_count_buffer_policy_freelist_alloc(int policy_idx);
+extern void pgstat_count_buffer_policy_eviction(int policy_idx, bool queued);
+extern void pgstat_count_buffer_policy_search(int policy_idx, int scanned,
+											  int pinned);
+extern void pgstat_count_buffer_policy_clock_pass(int policy_idx);
+extern void pgstat_count_buffer_policy_period(int policy_idx, int weight,
+											  double hit_ratio, bool aged);
+extern const char *pgstat_get_buffer_policy_name(int policy_idx);
+extern int	pgstat_get_buffer_policy_index(const char *name);
+extern PgStat_BufferPolicyStats *pgstat_fetch_buffer_policy(void);
+
+
 /*
  * Functions in pgstat_checkpointer.c
  */
@@ -0,0 +1,23 @@
+/*-------------------------------------------------------------------------
+ *
+ * pg_numa.h
+ *	  Basic NUMA portability routines
+ *
+ * These are thin wrappers around libnuma.  Without it, they report that
+ * NUMA isn't available, and callers carry on as if the machine had a single
+ * node.
+ *
+ * Portions Copyright (c) 1996-2023, PostgreSQL Global Development Group
+ *
+ * src/include/port/pg_numa.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef PG_NUMA_H
+#define PG_NUMA_H
+
+extern int	pg_numa_init(void);
+extern int	pg_numa_current_node(void);
+extern int	pg_numa_bind_memory(void *ptr, Size size, int node);
+
+#endif							/* PG_NUMA_H */
@@ -15,6 +15,7 @@
 #ifndef BUFMGR_INTERNALS_H
 #define BUFMGR_INTERNALS_H
 
+#include "common/bufpolicy.h"
 #include "pgstat.h"
 #include "port/atomics.h"
 #include "storage/buf.h"
@@ -250,94 +251,11 @@ typedef struct BufferDesc
 	/* state of the tag, containing flags, refcount and usagecount */
 	pg_atomic_uint32 state;
 
-// change,clock,修改
-	bool flag;
-
-
 	int			wait_backend_pgprocno;	/* backend of pin-count waiter */
 	int			freeNext;		/* link in freelist chain */
 	LWLock		content_lock;	/* to lock access to buffer contents */
 } BufferDesc;
 
-// change,cmd,修改
-typedef struct
-{
-	char algorithm_first;
-	char algorithm_second;
-	uint32 GetFromFreelist;
-	uint32 GetFromLRU;
-	uint32 GetFromCLOCK;
-	uint32 GetFromCLOCKSWEEP;
-	uint32 GetFromRandom;
-	uint32 GetFromHyperbolic;
-	uint32 GetFromEAclock;
-	uint32 StrategyAccessBuffer;
-	uint32 EAclockFdwAgeTimes;
-} ChangeAlgorithm;
-
-extern ChangeAlgorithm *Algorithm;
-
-#ifndef LRUSTACK_h
-#define LRUSTACK_h
-// change,lru,修改，添加lru节点
-typedef struct BufferNode
-{
-	int node_id;
-	struct BufferNode *prev;
-	struct BufferNode *next;
-// change,hyperbolic,添加时间戳(s)
-	time_t startTime;
-// change,EAclock,这里是迫不得已放在这里，不然放desc的话UpdateValue会报错
-	pg_atomic_uint32 Value;
-
-} BufferNode;
-// change,lru,数组指针
-// A stack of buffer nodes, traces the buffer node addresses.
-BufferNode* lruStack;
-
-// change,EAclock,EAclockStrategyControl
-typedef struct
-{
-	/* Spinlock: protects the values below */
-	slock_t		EAclock_lock;
-
-	pg_atomic_uint32 evictNum;
-
-	uint8 lastWeight;
-    uint8 lastAction;
-    double lastHR;
-    uint32 HitInBuf;
-    bool starCount;
-    bool isChange;
-
-} EAclockStrategyControl;
-
-/* Pointers to shared state */
-EAclockStrategyControl *EAclockControl;
-
-#endif
-
-// change,lru,读取lru链表
-static void readLRU()
-{
-	BufferNode *lru_head = &lruStack[NBuffers]; 
-	BufferNode *lru_end = &lruStack[NBuffers+1]; 
-	BufferNode *tmp =lru_head;
-	while(tmp!=NULL)
-	{
-		elog(LOG, "LRU->front = %d", tmp->node_id);;
-		tmp = tmp->next;
-	}
-	tmp =lru_end;
-	while(tmp!=NULL)
-	{
-		elog(LOG, "LRU->back = %d", tmp->node_id);;
-		tmp = tmp->prev;
-	}
-}
-
-
-
 /*
  * Concurrent access to buffer headers has proven to be more efficient if
  * they're cache line aligned. So we force the start of the BufferDescriptors
@@ -394,6 +312,18 @@ extern PGDLLIMPORT BufferDescPadded *BufferDescriptors;
 extern PGDLLIMPORT ConditionVariableMinimallyPadded *BufferIOCVArray;
 extern PGDLLIMPORT WritebackContext BackendWritebackContext;
 
+/*
+ * The buffer pool is divided into partitions of consecutive buffers, one or
+ * more per NUMA node, whose memory is placed on that node.  All partitions
+ * but the last hold BufferPoolPartitionSize buffers, a multiple of
+ * BUFFER_POOL_PARTITION_ALIGN; the last one also takes the remainder.  There
+ * are at most MAX_BUFFER_POOL_PARTITIONS of them.  See buf_init.c.
+ */
+#define BUFFER_POOL_PARTITION_ALIGN	256
+
+extern PGDLLIMPORT int NumBufferPoolPartitions;
+extern PGDLLIMPORT int BufferPoolPartitionSize;
+
 /* in localbuf.c */
 extern PGDLLIMPORT BufferDesc *LocalBufferDescriptors;
 
@@ -405,83 +335,6 @@ GetBufferDescriptor(uint32 id)
 }
 
 
-static void inline ValueInit(int buf_id)
-{
-	BufferNode *buf_lru_node = &lruStack[buf_id];
-	pg_atomic_init_u32(&buf_lru_node->Value, 0);
-}
-
-static void inline UpdateValue(int buf_id)
-{
-	BufferNode *buf_lru_node = &lruStack[buf_id];
-
-	if(Algorithm->algorithm_second == 'w')
-		pg_atomic_fetch_add_u32(&buf_lru_node->Value, 2*EAclockControl->lastWeight);
-	else
-		pg_atomic_fetch_add_u32(&buf_lru_node->Value, EAclockControl->lastWeight);
-
-
-	if(EAclockControl->starCount)
-        EAclockControl->HitInBuf++;
-}
-
-static void UpdateWeight()
-{
-
-	double evictNum = pg_atomic_read_u32(&EAclockControl->evictNum);
-    double newHR = 1.0*EAclockControl->HitInBuf/(EAclockControl->HitInBuf+evictNum);
-    EAclockControl->isChange = false;
-    
-
-    if(newHR>EAclockControl->lastHR)
-    {
-        EAclockControl->lastWeight = EAclockControl->lastWeight + EAclockControl->lastAction;
-    }
-
-    else
-    {
-		if(Algorithm->algorithm_second == 'd')
-		{
-			if(EAclockControl->lastHR-newHR>0.3*(1-EAclockControl->lastHR))
-            {
-				Algorithm->EAclockFdwAgeTimes++;
-                EAclockControl->isChange = true;
-                int i = 0;
-				BufferNode *buf_lru_node = &lruStack[i];
-                while(i < NBuffers){
-						int value = pg_atomic_read_u32(&buf_lru_node->Value);
-						if ( value >= 1 )
-						{
-							pg_atomic_fetch_sub_u32(&buf_lru_node->Value,value/2);
-						}
-                    i++;
-                }
-            }
-		}
-		else
-		{
-			EAclockControl->lastAction = -(EAclockControl->lastAction);
-			EAclockControl->lastWeight = EAclockControl->lastWeight + EAclockControl->lastAction;
-		}
-    }
-
-    EAclockControl->lastHR = newHR;
-
-
-    if(EAclockControl->lastWeight<=0)
-    {
-        EAclockControl->lastWeight = 1;
-        EAclockControl->lastHR = newHR-0.01;
-        EAclockControl->lastAction = -1;
-    }
-    else if(EAclockControl->lastWeight>=16)
-    {
-        EAclockControl->lastWeight = 16;
-        EAclockControl->lastHR = newHR-0.01;
-        EAclockControl->lastAction = +1;
-    }
-}
-
 static inline BufferDesc *
 GetLocalBufferDescriptor(uint32 id)
 {
@@ -506,6 +359,30 @@ BufferDescriptorGetContentLock(const BufferDesc *bdesc)
 	return (LWLock *) (&bdesc->content_lock);
 }
 
+static inline int
+BufferPoolPartitionOf(int buf_id)
+{
+	return Min(buf_id / BufferPoolPartitionSize, NumBufferPoolPartitions - 1);
+}
+
+/* first buffer of a partition */
+static inline int
+BufferPoolPartitionStart(int part)
+{
+	return part * BufferPoolPartitionSize;
+}
+
+/* one past the last buffer of a partition */
+static inline int
+BufferPoolPartitionEnd(int part)
+{
+	if (part == NumBufferPoolPartitions - 1)
+		return NBuffers;
+	return (part + 1) * BufferPoolPartitionSize;
+}
+
+extern int	BufferPoolHomePartition(void);
+
 /*
  * The freeNext field is either the index of the next freelist entry,
  * or one of these special values:
@@ -554,7 +431,182 @@ extern void IssuePendingWritebacks(WritebackContext *wb_context, IOContext io_co
 extern void ScheduleBufferTagForWriteback(WritebackContext *wb_context,
 										  IOContext io_context, BufferTag *tag);
 
+/*
+ * BufferPolicyRoutine -- callbacks implementing a buffer replacement policy.
+ *
+ * The policy in use is chosen by the buffer_replacement_policy GUC.  Besides
+ * the built-in policies in freelist.c, modules loaded through
+ * shared_preload_libraries can add their own with RegisterBufferPolicy().
+ * The setting can be changed on reload, so shared memory is reserved for all
+ * policies, but only the callbacks of the active policy are invoked, except
+ * while switching policies as described for StrategyUpdateBufferPolicy().
+ *
+ * shmem_size: amount of shared memory the policy needs.
+ *
+ * shmem_init: create or attach to the policy's shared state.  "init" is true
+ * when called in the postmaster (or a standalone backend) to initialize it.
+ *
+ * get_victim: called on a buffer miss when the freelist is empty and the
+ * caller's BufferAccessStrategy, if any, has no buffer to recycle.  Must
+ * return an unpinned buffer with its header spinlock held and its state
+ * stored in *buf_state, or throw an error if none can be found.  strategy is
+ * the caller's BufferAccessStrategy or NULL; the buffer returned is added to
+ * its ring by the caller.
+ *
+ * queue_victims: if true, the bgwriter may run get_victim ahead of demand to
+ * pre-select victims (see StrategyFillVictimQueue()), and throws away those
+ * that are dirty.  Only set this if picking a buffer leaves the policy's
+ * shared state alone, since a pre-selected buffer may never be taken.  A
+ * clock hand moves, for instance, and for the clock-based policies it's also
+ * what StrategySyncStart() reports to the bgwriter.
+ *
+ * on_hit: optional, called after a buffer that already held the requested
+ * page has been pinned.  Not called for accesses through a
+ * BufferAccessStrategy.
+ *
+ * on_hit_batch: optional, and used instead of on_hit if set.  Hits are then
+ * collected in a backend-local array and handed over in bulk, oldest first,
+ * once BUFFER_HIT_BATCH_SIZE have accumulated, before the backend picks a
+ * victim, and at transaction end.  This trades a little precision for far
+ * less traffic on shared cache lines.  Hits on buffers that have been given
+ * another page or freed meanwhile are dropped, but the check is made without
+ * the buffer header lock, so policies should still treat batched hits as
+ * hints.
+ *
+ * on_miss: optional, called after a buffer has been assigned to a page that
+ * was not in the pool, however that buffer was obtained, except when it was
+ * recycled from a BufferAccessStrategy's ring.  The policy then keeps the
+ * state it had for the page last read into that buffer.
+ *
+ * on_invalidate: optional, called when a buffer is returned to the freelist.
+ *
+ * seed: optional, called in the bgwriter when the server switches to this
+ * policy while running.  Should rebuild the per-buffer state from the buffers'
+ * usage counts, for all buffers whose tag is valid.  It runs concurrently
+ * with the policy's other callbacks, except get_victim, and is not called if
+ * the previous policy has the same shmem_init callback.
+ *
+ * describe: optional, fills in the policy's view of every buffer, for
+ * monitoring, in an array of NBuffers entries that the caller initialized to
+ * "unknown".  It runs concurrently with everything else, and must neither
+ * take locks nor modify the policy's state, so the result may be slightly
+ * inconsistent.
+ *
+ * restore: optional, gives a buffer the state that describe reported for its
+ * page earlier, possibly before a restart, and its usage count, which the
+ * buffer header has already been given.  Fields of info the policy doesn't
+ * recognize are "unknown", and the state must then be derived from the usage
+ * count, as in seed.  Called for pinned buffers only, in decreasing order of
+ * the positions they were described with.
+ *
+ * None of the callbacks is called with a buffer header spinlock held, except
+ * that get_victim must return with one.
+ */
+/*
+ * BufferPolicyBufferInfo -- what a policy knows about one buffer
+ *
+ * value is the policy's per-buffer counter (a usage count, reference bit,
+ * access count or frequency), queue the name of the list the buffer is on,
+ * position its distance from the head (newest end) of that list, and age the
+ * number of pages loaded into the pool since its page was.  Fields the
+ * policy doesn't have are -1, or NULL for queue.
+ */
+typedef struct BufferPolicyBufferInfo
+{
+	int32		value;
+	const char *queue;
+	int64		position;
+	int64		age;
+} BufferPolicyBufferInfo;
+
+typedef struct BufferPolicyRoutine
+{
+	const char *name;
+
+	Size		(*shmem_size) (void);
+	void		(*shmem_init) (bool init);
+	BufferDesc *(*get_victim) (BufferAccessStrategy strategy,
+							   uint32 *buf_state);
+	bool		queue_victims;
+	void		(*on_hit) (BufferDesc *buf);
+	void		(*on_hit_batch) (const int *buf_ids, int nbufs);
+	void		(*on_miss) (BufferDesc *buf);
+	void		(*on_invalidate) (BufferDesc *buf);
+	void		(*seed) (void);
+	void		(*describe) (BufferPolicyBufferInfo *info);
+	void		(*restore) (BufferDesc *buf, int usage,
+							const BufferPolicyBufferInfo *info);
+} BufferPolicyRoutine;
+
+/* the active replacement policy, set up by StrategyInitialize() */
+extern PGDLLIMPORT const BufferPolicyRoutine *BufferPolicy;
+
+/* the policy generation BufferPolicy is for, and the current one */
+extern PGDLLIMPORT uint32 BufferPolicyGeneration;
+extern PGDLLIMPORT pg_atomic_uint32 *SharedBufferPolicyGeneration;
+
+extern void RefreshBufferPolicy(void);
+
+/*
+ * StrategyCheckBufferPolicy -- catch up with a change of replacement policy
+ *
+ * Processes are told about a change by a ProcSignalBarrier, but only absorb
+ * it at their next CHECK_FOR_INTERRUPTS(), and a process started since then
+ * has inherited the postmaster's idea of the policy.  So look before every
+ * call into the policy.
+ */
+static inline void
+StrategyCheckBufferPolicy(void)
+{
+	if (unlikely(pg_atomic_read_u32(SharedBufferPolicyGeneration) !=
+				 BufferPolicyGeneration))
+		RefreshBufferPolicy();
+}
+
+/* hits not yet reported to a policy with an on_hit_batch callback */
+#define BUFFER_HIT_BATCH_SIZE	64
+
+extern PGDLLIMPORT int PendingBufferHits[BUFFER_HIT_BATCH_SIZE];
+extern PGDLLIMPORT BufferTag PendingBufferHitTags[BUFFER_HIT_BATCH_SIZE];
+extern PGDLLIMPORT int NumPendingBufferHits;
+
+extern void StrategyFlushBufferHits(void);
+
+/*
+ * Notify the active replacement policy of a hit on, or a newly loaded page
+ * in, a shared buffer.
+ */
+static inline void
+StrategyBufferHit(BufferDesc *buf)
+{
+	StrategyCheckBufferPolicy();
+	if (BufferPolicy->on_hit_batch != NULL)
+	{
+		/* The buffer is pinned, so its tag is stable */
+		PendingBufferHitTags[NumPendingBufferHits] = buf->tag;
+		PendingBufferHits[NumPendingBufferHits++] = buf->buf_id;
+		if (NumPendingBufferHits >= BUFFER_HIT_BATCH_SIZE)
+			StrategyFlushBufferHits();
+	}
+	else if (BufferPolicy->on_hit != NULL)
+		BufferPolicy->on_hit(buf);
+}
+
+static inline void
+StrategyBufferMiss(BufferDesc *buf)
+{
+	StrategyCheckBufferPolicy();
+	if (BufferPolicy->on_miss != NULL)
+		BufferPolicy->on_miss(buf);
+}
+
+/* bufmgr.c */
+extern bool RestoreBufferPolicyState(BufferTag *tag, int usage,
+									 const char *policy,
+									 const BufferPolicyBufferInfo *info);
+
 /* freelist.c */
+extern void RegisterBufferPolicy(const BufferPolicyRoutine *routine);
 extern IOContext IOContextForStrategy(BufferAccessStrategy strategy);
 extern BufferDesc *StrategyGetBuffer(BufferAccessStrategy strategy,
 									 uint32 *buf_state, bool *from_ring);
@@ -564,6 +616,11 @@ extern bool StrategyRejectBuffer(BufferAccessStrategy strategy,
 
 extern int	StrategySyncStart(uint32 *complete_passes, uint32 *num_buf_alloc);
 extern void StrategyNotifyBgWriter(int bgwprocno);
+extern void StrategyFillVictimQueue(int max_victims);
+extern void StrategyUpdateBufferPolicy(void);
+extern const char *StrategyDescribeBuffers(BufferPolicyBufferInfo *info);
+extern void StrategyRestoreBuffer(BufferDesc *buf, int usage, const char *policy,
+								  const BufferPolicyBufferInfo *info);
 
 extern Size StrategyShmemSize(void);
 extern void StrategyInitialize(bool init);
@@ -599,4 +656,11 @@ extern void DropRelationLocalBuffers(RelFileLocator rlocator,
 extern void DropRelationAllLocalBuffers(RelFileLocator rlocator);
 extern void AtEOXact_LocalBuffers(bool isCommit);
 
+/* localpolicy.c */
+extern void LocalBufferPolicyInit(int nbufs);
+extern int	LocalBufferPolicyGetVictim(void);
+extern void LocalBufferPolicyHit(int bufid);
+extern void LocalBufferPolicyLoad(int bufid);
+extern void LocalBufferPolicyInvalidate(int bufid);
+
 #endif							/* BUFMGR_INTERNALS_H */
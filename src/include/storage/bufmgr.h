@@ -14,6 +14,7 @@
 #ifndef BUFMGR_H
 #define BUFMGR_H
 
+#include "common/bufpolicy.h"
 #include "storage/block.h"
 #include "storage/buf.h"
 #include "storage/bufpage.h"
@@ -38,6 +39,26 @@ typedef enum BufferAccessStrategyType
 	BAS_VACUUM					/* VACUUM */
 } BufferAccessStrategyType;
 
+/* Upper limit for hyperbolic_sample_size */
+#define HYPERBOLIC_MAX_SAMPLE_SIZE	256
+
+/* Possible values for temp_buffer_replacement_policy */
+typedef enum LocalBufferPolicyType
+{
+	LOCAL_BUFFER_POLICY_CLOCKSWEEP = BUFPOLICY_CLOCKSWEEP,
+	LOCAL_BUFFER_POLICY_CLOCK = BUFPOLICY_CLOCK,
+	LOCAL_BUFFER_POLICY_LRU = BUFPOLICY_LRU,
+	LOCAL_BUFFER_POLICY_RANDOM = BUFPOLICY_RANDOM,
+	LOCAL_BUFFER_POLICY_HYPERBOLIC = BUFPOLICY_HYPERBOLIC,
+	LOCAL_BUFFER_POLICY_EACLOCK = BUFPOLICY_EACLOCK,
+	LOCAL_BUFFER_POLICY_EACLOCK_FDW = BUFPOLICY_EACLOCK_FDW,
+	LOCAL_BUFFER_POLICY_EACLOCK_FWA = BUFPOLICY_EACLOCK_FWA,
+	LOCAL_BUFFER_POLICY_ARC = BUFPOLICY_ARC,
+	LOCAL_BUFFER_POLICY_S3FIFO = BUFPOLICY_S3FIFO
+} LocalBufferPolicyType;
+
+#define NUM_LOCAL_BUFFER_POLICIES	(LOCAL_BUFFER_POLICY_S3FIFO + 1)
+
 /* Possible modes for ReadBufferExtended() */
 typedef enum
 {
@@ -137,14 +158,30 @@ extern PGDLLIMPORT int checkpoint_flush_after;
 extern PGDLLIMPORT int backend_flush_after;
 extern PGDLLIMPORT int bgwriter_flush_after;
 
+/* in freelist.c */
+extern PGDLLIMPORT char *buffer_replacement_policy;
+extern PGDLLIMPORT int hyperbolic_sample_size;
+extern PGDLLIMPORT int hyperbolic_retained_samples;
+extern PGDLLIMPORT int hyperbolic_priority;
+
+/* in buf_table.c */
+extern PGDLLIMPORT bool lock_free_buffer_mapping;
+
 /* in buf_init.c */
 extern PGDLLIMPORT char *BufferBlocks;
+extern PGDLLIMPORT int buffer_pool_numa_nodes;
+
+/* upper limit for buffer_pool_numa_nodes */
+#define MAX_BUFFER_POOL_PARTITIONS	64
 
 /* in localbuf.c */
 extern PGDLLIMPORT int NLocBuffer;
 extern PGDLLIMPORT Block *LocalBufferBlockPointers;
 extern PGDLLIMPORT int32 *LocalRefCount;
 
+/* in localpolicy.c */
+extern PGDLLIMPORT int temp_buffer_replacement_policy;
+
 /* upper limit for effective_io_concurrency */
 #define MAX_IO_CONCURRENCY 1000
 
@@ -268,6 +305,8 @@ extern int	GetAccessStrategyBufferCount(BufferAccessStrategy strategy);
 
 extern void FreeAccessStrategy(BufferAccessStrategy strategy);
 
+extern bool ProcessBarrierBufferPolicy(void);
+
 
 /* inline functions */
 
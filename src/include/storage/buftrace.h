@@ -0,0 +1,70 @@
+/*-------------------------------------------------------------------------
+ *
+ * buftrace.h
+ *	  Buffer access trace files.
+ *
+ * When buffer_trace_directory is set, every backend appends a record to its
+ * own trace file for each shared buffer access.  The files are meant to be
+ * replayed offline by pg_bufsim, so this header is also used by frontend
+ * code, and the format below is what both sides agree on.
+ *
+ * A trace file starts with a BufferTraceFileHeader, followed by any number
+ * of BufferTraceRecords, all in the byte order of the server that wrote it.
+ *
+ * Portions Copyright (c) 1996-2023, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/storage/buftrace.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef BUFTRACE_H
+#define BUFTRACE_H
+
+#include "common/relpath.h"
+#include "storage/block.h"
+
+#define BUFTRACE_MAGIC		0x43525442	/* "BTRC" */
+#define BUFTRACE_VERSION	1
+
+/* trace files are named BUFTRACE_FILE_PREFIX followed by the writer's PID */
+#define BUFTRACE_FILE_PREFIX	"buftrace."
+
+typedef struct BufferTraceFileHeader
+{
+	uint32		magic;			/* BUFTRACE_MAGIC */
+	uint32		version;		/* BUFTRACE_VERSION */
+	uint32		blcksz;			/* BLCKSZ of the server */
+	int32		pid;			/* PID of the writing backend */
+} BufferTraceFileHeader;
+
+/* kinds of events */
+#define BUFTRACE_HIT		0	/* page was found in shared buffers */
+#define BUFTRACE_MISS		1	/* page was read into a buffer */
+#define BUFTRACE_EXTEND		2	/* new page was added to the relation */
+
+typedef struct BufferTraceRecord
+{
+	int64		time;			/* TimestampTz of the access */
+	Oid			spcOid;			/* the page's BufferTag */
+	Oid			dbOid;
+	RelFileNumber relNumber;
+	BlockNumber blockNum;
+	int32		pid;			/* PID of the accessing backend */
+	int8		forkNum;
+	uint8		event;			/* BUFTRACE_HIT etc. */
+	uint16		padding;		/* always zero */
+} BufferTraceRecord;
+
+#ifndef FRONTEND
+
+struct buftag;
+
+extern PGDLLIMPORT char *buffer_trace_directory;
+extern PGDLLIMPORT bool BufferTraceEnabled;
+
+extern void BufferTraceAccess(const struct buftag *tag, uint8 event);
+
+#endif							/* FRONTEND */
+
+#endif							/* BUFTRACE_H */
@@ -51,7 +51,9 @@ typedef enum
 
 typedef enum
 {
-	PROCSIGNAL_BARRIER_SMGRRELEASE	/* ask smgr to close files */
+	PROCSIGNAL_BARRIER_SMGRRELEASE, /* ask smgr to close files */
+	PROCSIGNAL_BARRIER_BUFFER_POLICY	/* ask to adopt the buffer
+										 * replacement policy */
 } ProcSignalBarrierType;
 
 /*
@@ -281,6 +281,26 @@ static const char *const slru_names[] = {
 
 #define SLRU_NUM_ELEMENTS	lengthof(slru_names)
 
+/*
+ * Likewise for the built-in buffer replacement policies.  Policies added by
+ * RegisterBufferPolicy() are counted as "other".
+ */
+static const char *const buffer_policy_names[] = {
+	"clocksweep",
+	"clock",
+	"lru",
+	"random",
+	"hyperbolic",
+	"eaclock",
+	"eaclock_fdw",
+	"eaclock_fwa",
+	"arc",
+	"s3fifo",
+	"other"						/* has to be last */
+};
+
+#define BUFFER_POLICY_NUM_ELEMENTS	lengthof(buffer_policy_names)
+
 
 /* ----------
  * Types and definitions for different kinds of fixed-amount stats.
@@ -320,6 +340,13 @@ typedef struct PgStatShared_BgWriter
 	PgStat_BgWriterStats reset_offset;
 } PgStatShared_BgWriter;
 
+typedef struct PgStatShared_BufferPolicy
+{
+	/* lock protects ->stats */
+	LWLock		lock;
+	PgStat_BufferPolicyStats stats[BUFFER_POLICY_NUM_ELEMENTS];
+} PgStatShared_BufferPolicy;
+
 typedef struct PgStatShared_Checkpointer
 {
 	/* lock protects ->reset_offset as well as stats->stat_reset_timestamp */
@@ -429,6 +456,7 @@ typedef struct PgStat_ShmemControl
 	 */
 	PgStatShared_Archiver archiver;
 	PgStatShared_BgWriter bgwriter;
+	PgStatShared_BufferPolicy buffer_policy;
 	PgStatShared_Checkpointer checkpointer;
 	PgStatShared_IO io;
 	PgStatShared_SLRU slru;
@@ -452,6 +480,8 @@ typedef struct PgStat_Snapshot
 
 	PgStat_BgWriterStats bgwriter;
 
+	PgStat_BufferPolicyStats buffer_policy[BUFFER_POLICY_NUM_ELEMENTS];
+
 	PgStat_CheckpointerStats checkpointer;
 
 	PgStat_IO	io;
@@ -534,6 +564,15 @@ extern void pgstat_bgwriter_reset_all_cb(TimestampTz ts);
 extern void pgstat_bgwriter_snapshot_cb(void);
 
 
+/*
+ * Functions in pgstat_buffer_policy.c
+ */
+
+extern bool pgstat_buffer_policy_flush(bool nowait);
+extern void pgstat_buffer_policy_reset_all_cb(TimestampTz ts);
+extern void pgstat_buffer_policy_snapshot_cb(void);
+
+
 /*
  * Functions in pgstat_checkpointer.c
  */
@@ -666,6 +705,13 @@ extern void pgstat_create_transactional(PgStat_Kind kind, Oid dboid, Oid objoid)
 extern PGDLLIMPORT PgStat_LocalState pgStatLocal;
 
 
+/*
+ * Variables in pgstat_buffer_policy.c
+ */
+
+extern PGDLLIMPORT bool have_bufferpolicystats;
+
+
 /*
  * Variables in pgstat_io.c
  */
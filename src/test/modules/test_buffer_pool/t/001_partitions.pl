@@ -0,0 +1,104 @@
+# Copyright (c) 2023, PostgreSQL Global Development Group
+
+# Test the partitioned buffer pool: a backend should take buffers from its
+# home partition, and the victim search should move on to another partition
+# when every buffer of the home partition is pinned.
+use strict;
+use warnings;
+
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $node = PostgreSQL::Test::Cluster->new('main');
+$node->init;
+
+# Two partitions of 512 buffers, whether or not the machine has NUMA nodes.
+# A partition is only passed over once it has given up a partition's worth
+# of buffers more than the other, which the reads below stay well short of.
+$node->append_conf(
+	'postgresql.conf', qq(
+shared_buffers = 8MB
+buffer_pool_numa_nodes = 2
+buffer_replacement_policy = clocksweep
+autovacuum = off
+));
+$node->start;
+
+$node->safe_psql('postgres', 'CREATE EXTENSION test_buffer_pool');
+is($node->safe_psql('postgres', 'SELECT test_buffer_pool_partitions()'),
+	'2', 'buffer pool has two partitions');
+
+# One row per page, so block n holds row n + 1.  The table is larger than
+# the buffer pool.
+$node->safe_psql(
+	'postgres', q{
+CREATE TABLE big (id int, pad text) WITH (fillfactor = 10);
+ALTER TABLE big ALTER COLUMN pad SET STORAGE PLAIN;
+INSERT INTO big SELECT g, repeat('x', 1000) FROM generate_series(1, 1500) g;
+CHECKPOINT;
+});
+is( $node->safe_psql(
+		'postgres',
+		q{SELECT pg_relation_size('big') / current_setting('block_size')::int}
+	),
+	'1500',
+	'table has one row per page');
+
+# Start from an empty buffer pool, and fill it up, so that the buffers for
+# the reads below have to be found by the victim search.
+$node->restart;
+$node->safe_psql('postgres',
+	q{SELECT count(test_buffer_read('big', b)) FROM generate_series(0, 1023) b}
+);
+
+# The home partition can give up only a few buffers to the other one while
+# the first victim searches age its pages.
+my ($home, $home_reads) = split(
+	/\|/,
+	$node->safe_psql(
+		'postgres', q{
+SELECT test_buffer_home_partition(),
+       count(*) FILTER (WHERE test_buffer_read('big', b) =
+                              test_buffer_home_partition())
+FROM generate_series(1024, 1123) b
+}));
+ok($home >= 0 && $home < 2, "home partition is $home");
+cmp_ok($home_reads, '>=', 90,
+	'pages are read into buffers of the home partition');
+
+# With the whole home partition pinned, a page can still be read, into a
+# buffer of the other partition.
+is( $node->safe_psql(
+		'postgres', q{
+SELECT test_buffer_block_partition('big', 1300) IS NULL,
+       test_buffer_read_partition_pinned('big', 1300,
+                                         test_buffer_home_partition()) <>
+       test_buffer_home_partition()
+}),
+	't|t',
+	'victim search moves on from a fully pinned home partition');
+
+# Either partition can be pinned, whatever the home partition.
+for my $part (0, 1)
+{
+	my $block = 1400 + $part;
+
+	is( $node->safe_psql(
+			'postgres', qq{
+SELECT test_buffer_block_partition('big', $block) IS NULL,
+       test_buffer_read_partition_pinned('big', $block, $part)
+}),
+		't|' . (1 - $part),
+		"page is read into partition " . (1 - $part)
+		  . " with partition $part pinned");
+}
+
+# The pins are gone, and all pages are still there.
+is( $node->safe_psql(
+		'postgres', 'SELECT count(*), sum(id) FROM big'),
+	'1500|1125750',
+	'table is intact');
+
+$node->stop;
+done_testing();
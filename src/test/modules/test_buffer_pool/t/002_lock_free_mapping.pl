@@ -0,0 +1,97 @@
+# Copyright (c) 2023, PostgreSQL Global Development Group
+
+# Test the lock-free buffer mapping table under concurrent reads of a data
+# set larger than shared_buffers, while other clients create, truncate and
+# drop relations, so that lookups race with evictions and invalidations.
+use strict;
+use warnings;
+
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $node = PostgreSQL::Test::Cluster->new('main');
+$node->init;
+$node->append_conf(
+	'postgresql.conf', qq(
+shared_buffers = 2MB
+lock_free_buffer_mapping = on
+autovacuum = off
+));
+$node->start;
+
+is($node->safe_psql('postgres', 'SHOW lock_free_buffer_mapping'),
+	'on', 'lock-free buffer mapping is in use');
+
+# About 14MB of table and index, seven times the buffer pool.
+$node->safe_psql(
+	'postgres', q{
+CREATE TABLE data (id int PRIMARY KEY, pad text);
+ALTER TABLE data ALTER COLUMN pad SET STORAGE PLAIN;
+INSERT INTO data SELECT g, repeat('x', 500) FROM generate_series(1, 25000) g;
+});
+my $expected = '25000|312512500|12500000';
+is( $node->safe_psql(
+		'postgres', 'SELECT count(*), sum(id), sum(length(pad)) FROM data'),
+	$expected,
+	'table loaded');
+
+# Index and sequential scans read the table, while each client's churn
+# transactions fill a table of its own, truncate it, fill it again and drop
+# it, invalidating its buffers each time.
+$node->pgbench(
+	'--no-vacuum --client=6 --transactions=150',
+	0,
+	[qr{actually processed: 900/900}],
+	[qr{^$}],
+	'concurrent reads, truncates and drops',
+	{
+		'002_lock_free_mapping_index@4' => q(
+			\set id random(1, 24900)
+			SELECT count(*), sum(length(pad)) FROM data
+			  WHERE id BETWEEN :id AND :id + 100;
+		  ),
+		'002_lock_free_mapping_seq@1' => q(
+			SELECT count(*) FROM data WHERE pad IS NULL;
+		  ),
+		'002_lock_free_mapping_churn@1' => q(
+			CREATE TABLE churn_:client_id (id int, pad text);
+			INSERT INTO churn_:client_id
+			  SELECT g, repeat('y', 500) FROM generate_series(1, 3000) g;
+			SELECT count(*) FROM churn_:client_id;
+			TRUNCATE churn_:client_id;
+			INSERT INTO churn_:client_id
+			  SELECT g, repeat('z', 500) FROM generate_series(1, 1000) g;
+			SELECT count(*) FROM churn_:client_id;
+			DROP TABLE churn_:client_id;
+		  ),
+	});
+
+# The data reads back the same way through the heap and through the index.
+is( $node->safe_psql(
+		'postgres', 'SELECT count(*), sum(id), sum(length(pad)) FROM data'),
+	$expected,
+	'table intact after sequential scan');
+is( $node->safe_psql(
+		'postgres', q{
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+SELECT count(*), sum(id), sum(length(pad)) FROM data WHERE id > 0;
+}),
+	$expected,
+	'table intact after index scan');
+is( $node->safe_psql(
+		'postgres',
+		q{SELECT count(*) FROM pg_class WHERE relname LIKE 'churn\_%'}),
+	'0',
+	'churn tables are gone');
+
+# Pages written out on eviction read back the same after a restart.
+$node->restart;
+is( $node->safe_psql(
+		'postgres', 'SELECT count(*), sum(id), sum(length(pad)) FROM data'),
+	$expected,
+	'table intact after restart');
+
+$node->stop;
+done_testing();
@@ -0,0 +1,101 @@
+# Copyright (c) 2023, PostgreSQL Global Development Group
+
+# Test changing buffer_replacement_policy on reload while pgbench keeps the
+# buffer pool busy, going through every built-in policy and back.
+use strict;
+use warnings;
+
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my @policies = qw(clock lru random hyperbolic eaclock eaclock_fdw
+  eaclock_fwa arc s3fifo clocksweep);
+
+my $node = PostgreSQL::Test::Cluster->new('main');
+$node->init;
+$node->append_conf(
+	'postgresql.conf', qq(
+shared_buffers = 2MB
+buffer_replacement_policy = clocksweep
+autovacuum = off
+));
+$node->start;
+
+# pgbench_accounts alone takes up about 26MB, so nearly every lookup has to
+# evict something.
+$node->command_ok([ 'pgbench', '--initialize', '--scale=2', '--quiet' ],
+	'pgbench initialization');
+
+# Run until killed; the switches below take far less time than this.
+my ($stdout, $stderr) = ('', '');
+my $pgbench = IPC::Run::start(
+	[
+		'pgbench', '--no-vacuum', '--client=4', '--jobs=2',
+		'--time=' . 5 * $PostgreSQL::Test::Utils::timeout_default,
+		'--builtin=select-only@3', '--builtin=simple-update@1',
+		$node->connstr('postgres')
+	],
+	'<',
+	\undef,
+	'>',
+	\$stdout,
+	'2>',
+	\$stderr);
+
+my $current = 'clocksweep';
+foreach my $policy (@policies)
+{
+	my $evictions = $node->safe_psql('postgres',
+		"SELECT evictions FROM pg_stat_buffer_policy WHERE policy = '$policy'"
+	);
+	my $log_offset = -s $node->logfile;
+
+	$node->safe_psql('postgres',
+		"ALTER SYSTEM SET buffer_replacement_policy = '$policy'");
+	$node->reload;
+	$node->wait_for_log(
+		qr/buffer replacement policy changed from "$current" to "$policy"/,
+		$log_offset);
+	$current = $policy;
+
+	is($node->safe_psql('postgres', 'SHOW buffer_replacement_policy'),
+		$policy, "switched to $policy");
+
+	# The new policy is choosing the victims for pgbench's lookups.
+	ok( $node->poll_query_until(
+			'postgres', qq{
+SELECT evictions > $evictions FROM pg_stat_buffer_policy
+WHERE policy = '$policy'
+}),
+		"$policy evicts buffers");
+
+	is( $node->safe_psql(
+			'postgres', q{
+SELECT count(*) FROM pg_stat_buffer_policy
+WHERE freelist_allocs < 0 OR evictions < 0 OR searches < 0
+   OR queue_allocs > evictions OR pinned_skips > buffers_scanned
+   OR eaclock_hit_ratio NOT BETWEEN 0 AND 1
+}),
+		'0',
+		"statistics are consistent after switching to $policy");
+}
+
+ok($pgbench->pumpable, 'pgbench ran through all switches');
+$pgbench->kill_kill;
+$pgbench->finish;
+unlike($stderr, qr/aborted|ERROR/, 'no pgbench client failed');
+
+# simple-update adds each change of an account balance to the history.
+is( $node->safe_psql(
+		'postgres', q{
+SELECT (SELECT sum(abalance) FROM pgbench_accounts) =
+       (SELECT coalesce(sum(delta), 0) FROM pgbench_history)
+}),
+	't',
+	'account balances match the history');
+is($node->safe_psql('postgres', 'SELECT count(*) FROM pgbench_accounts'),
+	'200000', 'no account lost');
+
+$node->stop;
+done_testing();
@@ -0,0 +1,133 @@
+# Copyright (c) 2023, PostgreSQL Global Development Group
+
+# Run each built-in buffer replacement policy against a working set larger
+# than shared_buffers, under concurrent load, and check that arc and s3fifo
+# keep frequently used pages away from a scan and remember the pages they
+# evicted.
+use strict;
+use warnings;
+
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my @policies = qw(clocksweep clock lru random hyperbolic eaclock eaclock_fdw
+  eaclock_fwa arc s3fifo);
+
+my $node = PostgreSQL::Test::Cluster->new('main');
+$node->init;
+$node->append_conf(
+	'postgresql.conf', qq(
+shared_buffers = 2MB
+autovacuum = off
+));
+$node->start;
+
+$node->safe_psql('postgres',
+	'CREATE EXTENSION test_buffer_pool; CREATE EXTENSION pg_buffercache');
+$node->command_ok([ 'pgbench', '--initialize', '--scale=1', '--quiet' ],
+	'pgbench initialization');
+
+# Tables with one row per page: a hot set of 20 pages, and a cold set of
+# 1000 pages to be read only once.
+$node->safe_psql(
+	'postgres', q{
+CREATE TABLE hot (id int, pad text) WITH (fillfactor = 10);
+ALTER TABLE hot ALTER COLUMN pad SET STORAGE PLAIN;
+INSERT INTO hot SELECT g, repeat('h', 1000) FROM generate_series(1, 20) g;
+CREATE TABLE cold (id int, pad text) WITH (fillfactor = 10);
+ALTER TABLE cold ALTER COLUMN pad SET STORAGE PLAIN;
+INSERT INTO cold SELECT g, repeat('c', 1000) FROM generate_series(1, 1000) g;
+});
+
+sub set_policy
+{
+	my $policy = shift;
+
+	$node->safe_psql('postgres',
+		"ALTER SYSTEM SET buffer_replacement_policy = '$policy'");
+	$node->restart;
+}
+
+# With 2MB of shared buffers and eight clients, victim searches often come
+# across pinned buffers, and ghost lists fill up and overflow.
+foreach my $policy (@policies)
+{
+	set_policy($policy);
+
+	$node->pgbench(
+		'--no-vacuum --client=8 --jobs=2 --transactions=200',
+		0,
+		[qr{actually processed: 1600/1600}],
+		[qr{^$}],
+		"pgbench with $policy",
+		{
+			"004_policies_${policy}_select\@3" => q(
+				\set aid random(1, 100000)
+				SELECT abalance FROM pgbench_accounts WHERE aid = :aid;
+			  ),
+			"004_policies_${policy}_update\@1" => q(
+				\set aid random(1, 100000)
+				\set delta random(-5000, 5000)
+				BEGIN;
+				UPDATE pgbench_accounts SET abalance = abalance + :delta
+				  WHERE aid = :aid;
+				INSERT INTO pgbench_history (tid, bid, aid, delta, mtime)
+				  VALUES (1, 1, :aid, :delta, CURRENT_TIMESTAMP);
+				END;
+			  ),
+			"004_policies_${policy}_scan\@1" => q(
+				SELECT count(*) FROM cold WHERE pad IS NULL;
+			  ),
+		});
+
+	is( $node->safe_psql(
+			'postgres', qq{
+SELECT evictions > 0 FROM pg_stat_buffer_policy WHERE policy = '$policy';
+SELECT (SELECT sum(abalance) FROM pgbench_accounts) =
+       (SELECT sum(delta) FROM pgbench_history);
+}),
+		"t\nt",
+		"$policy evicts buffers and loses no update");
+}
+
+# Read the hot set three times, then the first 600 pages of the cold set
+# once.  Then read again the cold page evicted last, which the policy should
+# still remember.  All of this happens in one session, so that no eviction
+# is forgotten along with a backend's pending ghost entry.
+foreach my $case ([ 'arc', 'T2', 'T2' ], [ 's3fifo', 'main', 'main' ])
+{
+	my ($policy, $hot_queue, $ghost_queue) = @$case;
+
+	set_policy($policy);
+
+	my $result = $node->safe_psql(
+		'postgres', q{
+DO $$
+BEGIN
+  PERFORM test_buffer_read('hot', b)
+  FROM generate_series(1, 3), generate_series(0, 19) b;
+  PERFORM test_buffer_read('cold', b) FROM generate_series(0, 599) b;
+END
+$$;
+SELECT b AS ghost FROM generate_series(599, 0, -1) b
+WHERE test_buffer_block_partition('cold', b) IS NULL LIMIT 1 \gset
+SELECT test_buffer_read('cold', :ghost) >= 0 AS reread \gset
+SELECT count(*), string_agg(DISTINCT p.queue, ',')
+FROM pg_buffercache b JOIN pg_buffercache_policy() p USING (bufferid)
+WHERE b.relfilenode = pg_relation_filenode('hot') AND b.relforknumber = 0;
+SELECT p.queue
+FROM pg_buffercache b JOIN pg_buffercache_policy() p USING (bufferid)
+WHERE b.relfilenode = pg_relation_filenode('cold') AND b.relforknumber = 0
+  AND b.relblocknumber = :ghost;
+});
+	my ($hot, $ghost) = split(/\n/, $result);
+
+	is($hot, "20|$hot_queue",
+		"$policy keeps the hot set in $hot_queue during a scan");
+	is($ghost, $ghost_queue,
+		"$policy loads a page it remembers into $ghost_queue");
+}
+
+$node->stop;
+done_testing();
@@ -0,0 +1,15 @@
+/* src/test/modules/test_buffer_pool/test_buffer_pool--1.0.sql */
+
+-- complain if script is sourced in psql, rather than via CREATE EXTENSION
+\echo Use "CREATE EXTENSION test_buffer_pool" to load this file. \quit
+
+CREATE FUNCTION test_buffer_pool_partitions() RETURNS int
+  AS 'MODULE_PATHNAME' LANGUAGE C STRICT;
+CREATE FUNCTION test_buffer_home_partition() RETURNS int
+  AS 'MODULE_PATHNAME' LANGUAGE C STRICT;
+CREATE FUNCTION test_buffer_block_partition(regclass, int8) RETURNS int
+  AS 'MODULE_PATHNAME' LANGUAGE C STRICT;
+CREATE FUNCTION test_buffer_read(regclass, int8) RETURNS int
+  AS 'MODULE_PATHNAME' LANGUAGE C STRICT;
+CREATE FUNCTION test_buffer_read_partition_pinned(regclass, int8, int) RETURNS int
+  AS 'MODULE_PATHNAME' LANGUAGE C STRICT;
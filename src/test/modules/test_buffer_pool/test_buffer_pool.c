@@ -0,0 +1,191 @@
+/*--------------------------------------------------------------------------
+ *
+ * test_buffer_pool.c
+ *		Test code for the shared buffer pool.
+ *
+ * Portions Copyright (c) 1996-2023, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *		src/test/modules/test_buffer_pool/test_buffer_pool.c
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "access/relation.h"
+#include "fmgr.h"
+#include "storage/buf_internals.h"
+#include "storage/bufmgr.h"
+#include "utils/rel.h"
+
+PG_MODULE_MAGIC;
+
+/*
+ * SQL-callable entry points
+ */
+PG_FUNCTION_INFO_V1(test_buffer_pool_partitions);
+PG_FUNCTION_INFO_V1(test_buffer_home_partition);
+PG_FUNCTION_INFO_V1(test_buffer_block_partition);
+PG_FUNCTION_INFO_V1(test_buffer_read);
+PG_FUNCTION_INFO_V1(test_buffer_read_partition_pinned);
+
+/* How often to try pinning a buffer whose page keeps changing */
+#define PIN_PARTITION_TRIES		10
+
+static Relation
+open_shared_relation(Oid relid)
+{
+	Relation	rel = relation_open(relid, AccessShareLock);
+
+	if (RelationUsesLocalBuffers(rel))
+		elog(ERROR, "relation \"%s\" doesn't use shared buffers",
+			 RelationGetRelationName(rel));
+
+	return rel;
+}
+
+/*
+ * Read a block of the main fork of a relation, and return the partition of
+ * the buffer that holds it.
+ */
+static int
+read_block(Relation rel, BlockNumber blkno)
+{
+	Buffer		buffer;
+	int			part;
+
+	buffer = ReadBufferExtended(rel, MAIN_FORKNUM, blkno, RBM_NORMAL, NULL);
+	part = BufferPoolPartitionOf(buffer - 1);
+	ReleaseBuffer(buffer);
+
+	return part;
+}
+
+/*
+ * Pin every buffer of a partition, whatever page it holds, so that no victim
+ * can be found there.  The partition mustn't have free buffers left, since
+ * those can only be pinned by taking them for a new page.
+ */
+static Buffer *
+pin_partition(int part, int *npinned)
+{
+	int			start = BufferPoolPartitionStart(part);
+	int			end = BufferPoolPartitionEnd(part);
+	Buffer	   *pinned = palloc(sizeof(Buffer) * (end - start));
+
+	for (int buf_id = start; buf_id < end; buf_id++)
+	{
+		BufferDesc *buf_hdr = GetBufferDescriptor(buf_id);
+		int			tries = 0;
+
+		for (;;)
+		{
+			BufferTag	tag;
+			uint32		buf_state;
+
+			buf_state = LockBufHdr(buf_hdr);
+			tag = buf_hdr->tag;
+			UnlockBufHdr(buf_hdr, buf_state);
+
+			if (!(buf_state & BM_VALID))
+				elog(ERROR, "buffer %d holds no page", buf_id + 1);
+
+			if (ReadRecentBuffer(BufTagGetRelFileLocator(&tag),
+								 BufTagGetForkNum(&tag), tag.blockNum,
+								 buf_id + 1))
+				break;
+
+			/* The page was replaced under us; try the new one */
+			if (++tries == PIN_PARTITION_TRIES)
+				elog(ERROR, "could not pin buffer %d", buf_id + 1);
+		}
+		pinned[buf_id - start] = buf_id + 1;
+	}
+
+	*npinned = end - start;
+	return pinned;
+}
+
+Datum
+test_buffer_pool_partitions(PG_FUNCTION_ARGS)
+{
+	PG_RETURN_INT32(NumBufferPoolPartitions);
+}
+
+Datum
+test_buffer_home_partition(PG_FUNCTION_ARGS)
+{
+	PG_RETURN_INT32(BufferPoolHomePartition());
+}
+
+/*
+ * Return the partition of the buffer holding a block of a relation, or NULL
+ * if it's not in the buffer pool.  Nothing is read.
+ */
+Datum
+test_buffer_block_partition(PG_FUNCTION_ARGS)
+{
+	Oid			relid = PG_GETARG_OID(0);
+	BlockNumber blkno = (BlockNumber) PG_GETARG_INT64(1);
+	Relation	rel;
+	PrefetchBufferResult result;
+
+	rel = open_shared_relation(relid);
+	result = PrefetchBuffer(rel, MAIN_FORKNUM, blkno);
+	relation_close(rel, AccessShareLock);
+
+	if (!BufferIsValid(result.recent_buffer))
+		PG_RETURN_NULL();
+	PG_RETURN_INT32(BufferPoolPartitionOf(result.recent_buffer - 1));
+}
+
+/*
+ * Read a block of a relation, and return the partition of the buffer it's
+ * in.
+ */
+Datum
+test_buffer_read(PG_FUNCTION_ARGS)
+{
+	Oid			relid = PG_GETARG_OID(0);
+	BlockNumber blkno = (BlockNumber) PG_GETARG_INT64(1);
+	Relation	rel;
+	int			part;
+
+	rel = open_shared_relation(relid);
+	part = read_block(rel, blkno);
+	relation_close(rel, AccessShareLock);
+
+	PG_RETURN_INT32(part);
+}
+
+/*
+ * Like test_buffer_read(), but with every buffer of the given partition
+ * pinned while the block is read, so that its buffer must come from another
+ * partition if the block wasn't in the buffer pool yet.
+ */
+Datum
+test_buffer_read_partition_pinned(PG_FUNCTION_ARGS)
+{
+	Oid			relid = PG_GETARG_OID(0);
+	BlockNumber blkno = (BlockNumber) PG_GETARG_INT64(1);
+	int			pin_part = PG_GETARG_INT32(2);
+	Relation	rel;
+	Buffer	   *pinned;
+	int			npinned;
+	int			part;
+
+	if (pin_part < 0 || pin_part >= NumBufferPoolPartitions)
+		elog(ERROR, "invalid buffer pool partition %d", pin_part);
+
+	rel = open_shared_relation(relid);
+	pinned = pin_partition(pin_part, &npinned);
+	part = read_block(rel, blkno);
+	for (int i = 0; i < npinned; i++)
+		ReleaseBuffer(pinned[i]);
+	pfree(pinned);
+	relation_close(rel, AccessShareLock);
+
+	PG_RETURN_INT32(part);
+}
@@ -13,8 +13,9 @@ SELECT count(test_slru_page_write(a, 'Test SLRU'))
 SELECT test_slru_page_read(12377, true);
 -- Reading page in buffer for read-only
 SELECT test_slru_page_readonly(12377);
--- Reading page not in buffer with read-only
-SELECT test_slru_page_readonly(12346);
+-- Reading page not in buffer with read-only.  Of the 49 pages, only the 17
+-- of bank 0 don't fit in their bank, so its oldest one was evicted.
+SELECT test_slru_page_readonly(12345);
 
 -- Write all the pages in buffers
 SELECT test_slru_page_writeall();
@@ -35,4 +36,31 @@ SELECT test_slru_page_exists(12345);
 SELECT test_slru_page_exists(12377);
 SELECT test_slru_page_exists(12393);
 
+-- The test SLRU has several banks, and page n can only be in bank n % 3
+SELECT test_slru_banks();
+SELECT test_slru_page_write(30001, 'Bank 1');
+SELECT test_slru_page_write(30002, 'Bank 2');
+
+-- Fill bank 0 with 16 new pages
+SELECT count(test_slru_page_write(a, 'Bank 0'))
+  FROM generate_series(30000, 30045, 3) AS a;
+SELECT count(*) FROM generate_series(30000, 30045, 3) AS a
+  WHERE test_slru_page_bank(a) = 0;
+
+-- Use the oldest page of bank 0 again, then load one more page into the
+-- bank.  The least recently used page of the bank, and only that one, is
+-- evicted, and the pages of the other banks stay.
+SELECT test_slru_page_read(30000);
+SELECT test_slru_page_write(30048, 'Bank 0');
+SELECT a AS pageno, test_slru_page_bank(a) AS bank
+  FROM unnest(ARRAY[30000, 30001, 30002, 30003, 30006, 30048]) AS a;
+SELECT count(*) FROM generate_series(30006, 30048, 3) AS a
+  WHERE test_slru_page_bank(a) = 0;
+
+-- The sizes of the SLRU caches must be multiples of the bank size
+ALTER SYSTEM SET subtransaction_buffers = 17;
+ALTER SYSTEM SET notify_buffers = 40;
+ALTER SYSTEM SET transaction_buffers = 64;
+ALTER SYSTEM RESET transaction_buffers;
+
 DROP EXTENSION test_slru;
@@ -19,3 +19,7 @@ CREATE OR REPLACE FUNCTION test_slru_page_truncate(int) RETURNS VOID
   AS 'MODULE_PATHNAME', 'test_slru_page_truncate' LANGUAGE C;
 CREATE OR REPLACE FUNCTION test_slru_delete_all() RETURNS VOID
   AS 'MODULE_PATHNAME', 'test_slru_delete_all' LANGUAGE C;
+CREATE OR REPLACE FUNCTION test_slru_banks() RETURNS int
+  AS 'MODULE_PATHNAME', 'test_slru_banks' LANGUAGE C;
+CREATE OR REPLACE FUNCTION test_slru_page_bank(int) RETURNS int
+  AS 'MODULE_PATHNAME', 'test_slru_page_bank' LANGUAGE C;
@@ -0,0 +1,58 @@
+# Copyright (c) 2023, PostgreSQL Global Development Group
+
+# Test concurrent commits with wal_group_commit, and that everything they
+# committed survives a crash.
+use strict;
+use warnings;
+
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $node = PostgreSQL::Test::Cluster->new('main');
+$node->init;
+
+# fsync is needed for the group leader to wait for more members, and
+# commit_siblings = 1 lets it do so whenever another client is active.
+$node->append_conf(
+	'postgresql.conf', qq(
+wal_group_commit = on
+fsync = on
+commit_siblings = 1
+));
+$node->start;
+
+$node->safe_psql('postgres',
+	'CREATE TABLE group_commit (client int, n int)');
+
+$node->pgbench(
+	'--no-vacuum --client=8 --transactions=100',
+	0,
+	[qr{actually processed: 800/800}],
+	[qr{^$}],
+	'concurrent commits with wal_group_commit',
+	{
+		'040_wal_group_commit_insert' => q(
+			INSERT INTO group_commit VALUES (:client_id, 1);
+		  ),
+	});
+
+is( $node->safe_psql(
+		'postgres',
+		'SELECT count(*), count(DISTINCT client) FROM group_commit'),
+	'800|8',
+	'all commits are visible');
+
+# Flushes done by a group leader for the other members must be durable,
+# so every commit that was acknowledged is still there after a crash.
+$node->stop('immediate');
+$node->start;
+
+is( $node->safe_psql(
+		'postgres',
+		'SELECT count(*), count(DISTINCT client) FROM group_commit'),
+	'800|8',
+	'all commits survive a crash');
+
+$node->stop;
+done_testing();
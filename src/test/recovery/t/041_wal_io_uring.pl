@@ -0,0 +1,92 @@
+# Copyright (c) 2023, PostgreSQL Global Development Group
+
+# Test writing WAL with wal_io_method = io_uring, and crash recovery from
+# WAL written that way.
+use strict;
+use warnings;
+
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+# Small segments, so that the workload below spans quite a few of them
+my $node = PostgreSQL::Test::Cluster->new('main');
+$node->init(extra => ['--wal-segsize=1']);
+$node->append_conf('postgresql.conf', 'fsync = on');
+$node->start;
+
+my $supported = $node->safe_psql('postgres',
+	"SELECT 'io_uring' = ANY(enumvals) FROM pg_settings WHERE name = 'wal_io_method'"
+);
+if ($supported ne 't')
+{
+	$node->stop;
+	plan skip_all => 'io_uring not supported by this build';
+}
+
+# A process that can't set up its ring says so, and writes synchronously.
+my $log_offset = -s $node->logfile;
+$node->append_conf('postgresql.conf', 'wal_io_method = io_uring');
+$node->restart;
+$node->safe_psql('postgres', 'CREATE TABLE uring_test (id int, t text)');
+if ($node->log_contains(
+		qr/could not set up io_uring|kernel does not support the io_uring/,
+		$log_offset))
+{
+	$node->stop;
+	plan skip_all => 'io_uring not supported by the kernel';
+}
+
+is($node->safe_psql('postgres', 'SHOW wal_io_method'),
+	'io_uring', 'wal_io_method is io_uring');
+
+# A bulk load crossing many segments, and small concurrent commits
+my $start_lsn = $node->lsn('insert');
+$node->safe_psql('postgres',
+	"INSERT INTO uring_test SELECT g, repeat('x', 100) FROM generate_series(1, 50000) g"
+);
+$node->pgbench(
+	'--no-vacuum --client=4 --transactions=100',
+	0,
+	[qr{actually processed: 400/400}],
+	[qr{^$}],
+	'concurrent commits with io_uring',
+	{
+		'041_wal_io_uring_insert' => q(
+			INSERT INTO uring_test VALUES (-1 - :client_id, 'pgbench');
+		  ),
+	});
+my $end_lsn = $node->lsn('insert');
+
+cmp_ok(
+	$node->safe_psql(
+		'postgres', "SELECT pg_wal_lsn_diff('$end_lsn', '$start_lsn')"),
+	'>', 4 * 1024 * 1024,
+	'workload wrote WAL across several segments');
+
+my $expected = $node->safe_psql('postgres',
+	'SELECT count(*), sum(id), count(DISTINCT t) FROM uring_test');
+is($expected, '50400|1250024000|2', 'workload results');
+
+# Crash, and recover from the WAL written through io_uring
+$node->stop('immediate');
+$log_offset = -s $node->logfile;
+$node->start;
+ok($node->log_contains(qr/redo done/, $log_offset),
+	'crash recovery replayed WAL');
+
+is( $node->safe_psql(
+		'postgres', 'SELECT count(*), sum(id), count(DISTINCT t) FROM uring_test'),
+	$expected,
+	'all committed rows survive a crash');
+
+# WAL written after recovery is fine too
+$node->safe_psql('postgres',
+	"INSERT INTO uring_test SELECT g, 'after' FROM generate_series(1, 1000) g");
+$node->stop('immediate');
+$node->start;
+is($node->safe_psql('postgres', 'SELECT count(*) FROM uring_test'),
+	'51400', 'rows written after recovery survive another crash');
+
+$node->stop;
+done_testing();
@@ -476,6 +476,11 @@ SELECT pg_stat_reset_shared('wal');
 SELECT stats_reset > :'wal_reset_ts'::timestamptz FROM pg_stat_wal;
 SELECT stats_reset AS wal_reset_ts FROM pg_stat_wal \gset
 
+-- Test that reset_shared with buffer_policy specified as the stats type works
+SELECT stats_reset AS buffer_policy_reset_ts FROM pg_stat_buffer_policy WHERE policy = 'clocksweep' \gset
+SELECT pg_stat_reset_shared('buffer_policy');
+SELECT stats_reset > :'buffer_policy_reset_ts'::timestamptz FROM pg_stat_buffer_policy WHERE policy = 'clocksweep';
+
 -- Test that reset_shared with no specified stats type doesn't reset anything
 SELECT pg_stat_reset_shared(NULL);
 SELECT stats_reset = :'archiver_reset_ts'::timestamptz FROM pg_stat_archiver;
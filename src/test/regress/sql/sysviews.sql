@@ -45,6 +45,9 @@ select count(*) >= 0 as ok from pg_prepared_xacts;
 -- There will surely be at least one SLRU cache
 select count(*) > 0 as ok from pg_stat_slru;
 
+-- One row per built-in replacement policy, plus "other"
+select count(*) > 1 as ok from pg_stat_buffer_policy;
+
 -- There must be only one record
 select count(*) = 1 as ok from pg_stat_wal;
 
@@ -0,0 +1,59 @@
+--
+-- Replacement policies for temporary buffers
+--
+
+-- Use few temporary buffers, so that the tables below don't fit.  That has
+-- to be set before temporary buffers are first used, so start a new session.
+\c
+SET temp_buffers TO 100;
+
+-- stays across policy changes, which rebuild the policy from the buffers
+CREATE TEMP TABLE temp_policy_keep (a int, b text);
+INSERT INTO temp_policy_keep SELECT g, repeat('y', 200) FROM generate_series(1, 3000) g;
+
+-- Fill a table larger than temp_buffers under the given policy, which
+-- evicts and writes out dirty buffers, read it back, look up some rows
+-- through its index, and drop it again.
+CREATE FUNCTION temp_policy_check(policy text,
+								  OUT spills bool, OUT nrows bigint,
+								  OUT total bigint, OUT nfound int,
+								  OUT nkept bigint)
+LANGUAGE plpgsql AS $$
+BEGIN
+	PERFORM set_config('temp_buffer_replacement_policy', policy, true);
+
+	CREATE TEMP TABLE temp_policy (a int PRIMARY KEY, b text);
+	INSERT INTO temp_policy SELECT g, repeat('x', 200) FROM generate_series(1, 5000) g;
+	spills := pg_relation_size('temp_policy') /
+		current_setting('block_size')::int > 100;
+
+	SELECT count(*), sum(a) INTO nrows, total FROM temp_policy;
+
+	nfound := 0;
+	FOR i IN 1..5000 BY 7 LOOP
+		PERFORM 1 FROM temp_policy WHERE a = i;
+		IF FOUND THEN
+			nfound := nfound + 1;
+		END IF;
+	END LOOP;
+
+	SELECT count(*) INTO nkept FROM temp_policy_keep;
+
+	DROP TABLE temp_policy;
+END
+$$;
+
+SELECT p.policy, c.*
+  FROM pg_settings s,
+	   unnest(s.enumvals) WITH ORDINALITY AS p(policy, n),
+	   LATERAL temp_policy_check(p.policy) c
+  WHERE s.name = 'temp_buffer_replacement_policy'
+  ORDER BY p.n;
+
+-- The table kept across the policy changes is still intact
+SELECT count(*), sum(a) FROM temp_policy_keep WHERE b = repeat('y', 200);
+
+DROP FUNCTION temp_policy_check(text);
+DROP TABLE temp_policy_keep;
+RESET temp_buffer_replacement_policy;
+RESET temp_buffers;
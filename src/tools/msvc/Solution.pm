@@ -234,6 +234,7 @@ sub GenerateFiles
 		HAVE_CRYPTO_LOCK => undef,
 		HAVE_DECL_FDATASYNC => 0,
 		HAVE_DECL_F_FULLFSYNC => 0,
+		HAVE_DECL_IORING_OP_WRITE => 0,
 		HAVE_DECL_LLVMCREATEGDBREGISTRATIONLISTENER => 0,
 		HAVE_DECL_LLVMCREATEPERFJITEVENTLISTENER => 0,
 		HAVE_DECL_LLVMGETHOSTCPUNAME => 0,
@@ -287,6 +288,7 @@ sub GenerateFiles
 		HAVE_LIBLDAP => undef,
 		HAVE_LIBLZ4 => undef,
 		HAVE_LIBM => undef,
+		HAVE_LIBNUMA => undef,
 		HAVE_LIBPAM => undef,
 		HAVE_LIBREADLINE => undef,
 		HAVE_LIBSELINUX => undef,
@@ -430,6 +432,7 @@ sub GenerateFiles
 		USE_BONJOUR => undef,
 		USE_BSD_AUTH => undef,
 		USE_ICU => $self->{options}->{icu} ? 1 : undef,
+		USE_LIBNUMA => undef,
 		USE_LIBXML => undef,
 		USE_LIBXSLT => undef,
 		USE_LZ4 => undef,